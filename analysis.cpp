@@ -0,0 +1,333 @@
+#include "analysis.h"
+#include <QObject>
+#include <QDateTime>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define POGODA_HAVE_SSE2
+#endif
+
+namespace {
+
+constexpr qint64 HourMs = 3600000;
+constexpr qsizetype MinValidHoursPerDay = 18; // 75% doby - wymóg kompletności danych
+
+// Grupuje znaczniki czasu według doby kalendarzowej czasu lokalnego
+class DayClock
+{
+public:
+    qint64 dayOf(qint64 timestampMs)
+    {
+        if (timestampMs < start || timestampMs >= end) {
+            const QDate date = QDateTime::fromMSecsSinceEpoch(timestampMs).date();
+            start = QDateTime(date, QTime(0, 0)).toMSecsSinceEpoch();
+            end = QDateTime(date.addDays(1), QTime(0, 0)).toMSecsSinceEpoch();
+            day = date.toJulianDay();
+        }
+        return day;
+    }
+
+private:
+    qint64 start = std::numeric_limits<qint64>::max(); // Początek bieżącej doby
+    qint64 end = std::numeric_limits<qint64>::min(); // Koniec bieżącej doby
+    qint64 day = 0; // Numer doby (dzień juliański)
+};
+
+// Pierwszy przebieg: min, max, suma i liczba poprawnych wartości (NaN jest pomijany)
+void reduce(const double *values, qsizetype size, double &min, double &max, double &sum, qsizetype &count)
+{
+    qsizetype i = 0;
+    min = std::numeric_limits<double>::infinity();
+    max = -std::numeric_limits<double>::infinity();
+    sum = 0.0;
+    double validCount = 0.0;
+
+#ifdef POGODA_HAVE_SSE2
+    __m128d vmin0 = _mm_set1_pd(min), vmin1 = vmin0;
+    __m128d vmax0 = _mm_set1_pd(max), vmax1 = vmax0;
+    __m128d vsum0 = _mm_setzero_pd(), vsum1 = vsum0;
+    __m128d vcnt0 = _mm_setzero_pd(), vcnt1 = vcnt0;
+    const __m128d one = _mm_set1_pd(1.0);
+
+    for (; i + 4 <= size; i += 4) {
+        const __m128d a = _mm_loadu_pd(values + i);
+        const __m128d b = _mm_loadu_pd(values + i + 2);
+        // minpd/maxpd zwracają drugi argument, gdy pierwszy jest NaN
+        vmin0 = _mm_min_pd(a, vmin0);
+        vmin1 = _mm_min_pd(b, vmin1);
+        vmax0 = _mm_max_pd(a, vmax0);
+        vmax1 = _mm_max_pd(b, vmax1);
+        const __m128d maskA = _mm_cmpord_pd(a, a);
+        const __m128d maskB = _mm_cmpord_pd(b, b);
+        vsum0 = _mm_add_pd(vsum0, _mm_and_pd(a, maskA));
+        vsum1 = _mm_add_pd(vsum1, _mm_and_pd(b, maskB));
+        vcnt0 = _mm_add_pd(vcnt0, _mm_and_pd(one, maskA));
+        vcnt1 = _mm_add_pd(vcnt1, _mm_and_pd(one, maskB));
+    }
+
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, _mm_min_pd(vmin0, vmin1));
+    min = std::fmin(lanes[0], lanes[1]);
+    _mm_store_pd(lanes, _mm_max_pd(vmax0, vmax1));
+    max = std::fmax(lanes[0], lanes[1]);
+    _mm_store_pd(lanes, _mm_add_pd(vsum0, vsum1));
+    sum = lanes[0] + lanes[1];
+    _mm_store_pd(lanes, _mm_add_pd(vcnt0, vcnt1));
+    validCount = lanes[0] + lanes[1];
+#endif
+
+    for (; i < size; ++i) {
+        const double v = values[i];
+        if (std::isnan(v)) continue;
+        min = v < min ? v : min;
+        max = v > max ? v : max;
+        sum += v;
+        validCount += 1.0;
+    }
+    count = qsizetype(validCount);
+}
+
+// Drugi przebieg: suma kwadratów odchyleń od średniej
+double sumSquaredDeviations(const double *values, qsizetype size, double mean)
+{
+    qsizetype i = 0;
+    double result = 0.0;
+
+#ifdef POGODA_HAVE_SSE2
+    const __m128d vmean = _mm_set1_pd(mean);
+    __m128d acc0 = _mm_setzero_pd(), acc1 = acc0;
+    for (; i + 4 <= size; i += 4) {
+        const __m128d a = _mm_loadu_pd(values + i);
+        const __m128d b = _mm_loadu_pd(values + i + 2);
+        const __m128d da = _mm_and_pd(_mm_sub_pd(a, vmean), _mm_cmpord_pd(a, a));
+        const __m128d db = _mm_and_pd(_mm_sub_pd(b, vmean), _mm_cmpord_pd(b, b));
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(da, da));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(db, db));
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, _mm_add_pd(acc0, acc1));
+    result = lanes[0] + lanes[1];
+#endif
+
+    for (; i < size; ++i) {
+        if (std::isnan(values[i])) continue;
+        const double d = values[i] - mean;
+        result += d * d;
+    }
+    return result;
+}
+
+qsizetype indexOf(const double *values, qsizetype size, double target)
+{
+    for (qsizetype i = 0; i < size; ++i) {
+        if (values[i] == target) return i;
+    }
+    return -1;
+}
+
+} // namespace
+
+namespace Analysis {
+
+Summary summarize(const double *values, qsizetype size)
+{
+    Summary summary;
+    reduce(values, size, summary.min, summary.max, summary.sum, summary.count);
+    summary.nullCount = size - summary.count;
+    if (summary.count == 0) {
+        summary.min = summary.max = 0.0;
+        return summary;
+    }
+
+    summary.mean = summary.sum / summary.count;
+    summary.variance = sumSquaredDeviations(values, size, summary.mean) / summary.count;
+    summary.stdDev = std::sqrt(summary.variance);
+    summary.minIndex = indexOf(values, size, summary.min);
+    summary.maxIndex = indexOf(values, size, summary.max);
+    return summary;
+}
+
+Summary summarize(const TimeSeries &series)
+{
+    return summarize(series.values(), series.size());
+}
+
+QuantileSketch::QuantileSketch(double relativeAccuracy)
+    : gamma((1.0 + relativeAccuracy) / (1.0 - relativeAccuracy)),
+    logGamma(std::log(gamma))
+{
+}
+
+int QuantileSketch::bucketOf(double magnitude) const
+{
+    return int(std::ceil(std::log(magnitude) / logGamma));
+}
+
+double QuantileSketch::valueOf(int bucket) const
+{
+    // Środek kubełka (gamma^(k-1), gamma^k] o błędzie względnym co najwyżej alpha
+    return 2.0 * std::pow(gamma, bucket) / (gamma + 1.0);
+}
+
+void QuantileSketch::add(double value)
+{
+    if (std::isnan(value)) return;
+
+    constexpr double ZeroThreshold = 1e-9;
+    if (value > ZeroThreshold) {
+        ++positive[bucketOf(value)];
+    } else if (value < -ZeroThreshold) {
+        ++negative[bucketOf(-value)];
+    } else {
+        ++zeroCount;
+    }
+    ++total;
+}
+
+void QuantileSketch::add(const TimeSeries &series)
+{
+    const double *values = series.values();
+    for (qsizetype i = 0; i < series.size(); ++i) {
+        add(values[i]);
+    }
+}
+
+void QuantileSketch::merge(const QuantileSketch &other)
+{
+    for (const auto &[bucket, count] : other.positive) positive[bucket] += count;
+    for (const auto &[bucket, count] : other.negative) negative[bucket] += count;
+    zeroCount += other.zeroCount;
+    total += other.total;
+}
+
+double QuantileSketch::quantile(double q) const
+{
+    if (total == 0) return std::numeric_limits<double>::quiet_NaN();
+
+    const quint64 rank = quint64(std::clamp(q, 0.0, 1.0) * double(total - 1));
+    quint64 seen = 0;
+
+    // Wartości ujemne w kolejności rosnącej to kubełki modułu w kolejności malejącej
+    for (auto it = negative.crbegin(); it != negative.crend(); ++it) {
+        seen += it->second;
+        if (seen > rank) return -valueOf(it->first);
+    }
+    seen += zeroCount;
+    if (seen > rank) return 0.0;
+    for (const auto &[bucket, count] : positive) {
+        seen += count;
+        if (seen > rank) return valueOf(bucket);
+    }
+    return positive.empty() ? 0.0 : valueOf(positive.crbegin()->first);
+}
+
+TimeSeries rollingMean(const TimeSeries &series, qint64 windowMs, qint64 sampleIntervalMs, double minCoverage)
+{
+    TimeSeries result;
+    result.reserve(series.size());
+
+    const qsizetype required = qMax<qsizetype>(1, qsizetype(std::ceil(minCoverage * windowMs / sampleIntervalMs)));
+    const qint64 *timestamps = series.timestamps();
+    const double *values = series.values();
+
+    qsizetype start = 0;
+    qsizetype count = 0;
+    double sum = 0.0;
+    for (qsizetype i = 0; i < series.size(); ++i) {
+        const qint64 t = timestamps[i];
+        if (series.isValid(i)) {
+            sum += values[i];
+            ++count;
+        }
+        while (timestamps[start] <= t - windowMs) {
+            if (series.isValid(start)) {
+                sum -= values[start];
+                --count;
+            }
+            ++start;
+        }
+
+        if (count >= required) {
+            result.append(t, sum / count);
+        } else {
+            result.appendNull(t);
+        }
+    }
+    return result;
+}
+
+QList<Norm> normsFor(const QString &parameterCode)
+{
+    using A = Norm::Averaging;
+    const QString code = parameterCode.toUpper();
+    if (code == "PM10") {
+        return {{A::DailyMean, 50.0, QObject::tr("Dni ze średnią dobową > 50 µg/m³")}};
+    }
+    if (code == "PM2.5") {
+        return {{A::DailyMean, 25.0, QObject::tr("Dni ze średnią dobową > 25 µg/m³")}};
+    }
+    if (code == "O3") {
+        return {{A::DailyMax8hMean, 120.0, QObject::tr("Dni z maks. średnią 8-godzinną > 120 µg/m³")}};
+    }
+    if (code == "NO2") {
+        return {{A::Hourly, 200.0, QObject::tr("Godziny z wartością > 200 µg/m³")}};
+    }
+    if (code == "SO2") {
+        return {{A::Hourly, 350.0, QObject::tr("Godziny z wartością > 350 µg/m³")},
+                {A::DailyMean, 125.0, QObject::tr("Dni ze średnią dobową > 125 µg/m³")}};
+    }
+    if (code == "CO") {
+        return {{A::DailyMax8hMean, 10000.0, QObject::tr("Dni z maks. średnią 8-godzinną > 10000 µg/m³")}};
+    }
+    return {};
+}
+
+qsizetype countExceedances(const TimeSeries &series, const Norm &norm)
+{
+    qsizetype exceedances = 0;
+
+    if (norm.averaging == Norm::Averaging::Hourly) {
+        const double *values = series.values();
+        for (qsizetype i = 0; i < series.size(); ++i) {
+            exceedances += values[i] > norm.threshold; // NaN nigdy nie przekracza progu
+        }
+        return exceedances;
+    }
+
+    // Wartości dobowe: średnia z pomiarów albo maksimum średnich 8-godzinnych
+    const bool dailyMean = norm.averaging == Norm::Averaging::DailyMean;
+    const TimeSeries source = dailyMean ? series : rollingMean(series, 8 * HourMs);
+
+    DayClock clock;
+    qint64 currentDay = std::numeric_limits<qint64>::min();
+    double sum = 0.0, max = -std::numeric_limits<double>::infinity();
+    qsizetype count = 0;
+
+    auto finishDay = [&]() {
+        if (count < MinValidHoursPerDay) return;
+        const double value = dailyMean ? sum / count : max;
+        exceedances += value > norm.threshold;
+    };
+
+    for (qsizetype i = 0; i < source.size(); ++i) {
+        const qint64 day = clock.dayOf(source.timestampAt(i));
+        if (day != currentDay) {
+            finishDay();
+            currentDay = day;
+            sum = 0.0;
+            max = -std::numeric_limits<double>::infinity();
+            count = 0;
+        }
+        if (!source.isValid(i)) continue;
+        sum += source.valueAt(i);
+        max = qMax(max, source.valueAt(i));
+        ++count;
+    }
+    finishDay();
+    return exceedances;
+}
+
+} // namespace Analysis
@@ -0,0 +1,147 @@
+/**
+ * @file analysis.h
+ * @brief Definicja przestrzeni nazw Analysis do obliczeń statystycznych na szeregach
+ */
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include <QString>
+#include <QList>
+#include <map>
+#include "timeseries.h"
+
+/**
+ * @namespace Analysis
+ * @brief Przestrzeń nazw zawierająca funkcje statystyczne na kolumnach wartości
+ *
+ * Funkcje działają na ciągłych kolumnach TimeSeries, pomijają brakujące pomiary
+ * i nie zależą od interfejsu graficznego. Redukcje korzystają z instrukcji SIMD
+ * i niezmiennika TimeSeries, że brakujący pomiar ma w kolumnie wartości NaN.
+ */
+namespace Analysis {
+
+    /**
+     * @struct Summary
+     * @brief Podstawowe statystyki szeregu
+     */
+    struct Summary {
+        qsizetype count = 0; // Liczba poprawnych pomiarów
+        qsizetype nullCount = 0; // Liczba brakujących pomiarów
+        double min = 0.0; // Wartość minimalna
+        double max = 0.0; // Wartość maksymalna
+        qsizetype minIndex = -1; // Indeks pierwszej wartości minimalnej
+        qsizetype maxIndex = -1; // Indeks pierwszej wartości maksymalnej
+        double sum = 0.0; // Suma wartości
+        double mean = 0.0; // Średnia
+        double variance = 0.0; // Wariancja (populacyjna)
+        double stdDev = 0.0; // Odchylenie standardowe
+    };
+
+    /**
+     * @brief Oblicza podstawowe statystyki kolumny wartości
+     * @param values Kolumna wartości (NaN dla brakujących pomiarów)
+     * @param size Liczba elementów kolumny
+     * @return Statystyki (count == 0, jeśli brak poprawnych pomiarów)
+     */
+    Summary summarize(const double *values, qsizetype size);
+
+    /**
+     * @brief Oblicza podstawowe statystyki szeregu
+     * @param series Szereg czasowy
+     * @return Statystyki
+     */
+    Summary summarize(const TimeSeries &series);
+
+    /**
+     * @class QuantileSketch
+     * @brief Łączalny szkic kwantyli ze względnym błędem (w stylu DDSketch)
+     *
+     * Wartości trafiają do kubełków o logarytmicznie rosnącej szerokości, więc
+     * każdy kwantyl jest wyznaczany z zadanym błędem względnym, a szkice
+     * z wielu szeregów można łączyć bez dostępu do surowych danych.
+     */
+    class QuantileSketch
+    {
+    public:
+        /**
+         * @brief Konstruktor szkicu
+         * @param relativeAccuracy Dopuszczalny błąd względny (np. 0.01 = 1%)
+         */
+        explicit QuantileSketch(double relativeAccuracy = 0.01);
+
+        /// Dodaje wartość do szkicu
+        void add(double value);
+
+        /// Dodaje wszystkie poprawne pomiary szeregu
+        void add(const TimeSeries &series);
+
+        /// Łączy szkic z innym szkicem o tej samej dokładności
+        void merge(const QuantileSketch &other);
+
+        /**
+         * @brief Wyznacza przybliżony kwantyl
+         * @param q Rząd kwantyla z przedziału [0, 1]
+         * @return Wartość kwantyla (NaN dla pustego szkicu)
+         */
+        double quantile(double q) const;
+
+        /// Zwraca liczbę wartości w szkicu
+        quint64 count() const { return total; }
+
+    private:
+        double gamma; // Stosunek granic kolejnych kubełków
+        double logGamma; // Logarytm gamma
+        std::map<int, quint64> positive; // Kubełki wartości dodatnich
+        std::map<int, quint64> negative; // Kubełki wartości ujemnych (według modułu)
+        quint64 zeroCount = 0; // Liczba wartości bliskich zeru
+        quint64 total = 0; // Liczba wszystkich wartości
+
+        int bucketOf(double magnitude) const;
+        double valueOf(int bucket) const;
+    };
+
+    /**
+     * @brief Oblicza kroczącą średnią w oknie czasowym (t - window, t]
+     * @param series Szereg posortowany rosnąco według czasu
+     * @param windowMs Długość okna w ms (np. 24 h dla PM10/PM2.5, 8 h dla O3)
+     * @param sampleIntervalMs Nominalny odstęp między pomiarami
+     * @param minCoverage Minimalny udział poprawnych pomiarów w oknie (domyślnie 75%)
+     * @return Szereg średnich w chwilach pomiarów (brak przy niewystarczającym pokryciu)
+     */
+    TimeSeries rollingMean(const TimeSeries &series, qint64 windowMs,
+                           qint64 sampleIntervalMs = 3600000, double minCoverage = 0.75);
+
+    /**
+     * @struct Norm
+     * @brief Norma jakości powietrza dla parametru
+     */
+    struct Norm {
+        /// Sposób uśredniania wartości przed porównaniem z progiem
+        enum class Averaging {
+            Hourly, ///< Pojedyncze pomiary godzinowe
+            DailyMean, ///< Średnia dobowa
+            DailyMax8hMean ///< Maksymalna dobowa średnia 8-godzinna
+        };
+
+        Averaging averaging; // Sposób uśredniania
+        double threshold; // Próg w µg/m³
+        QString description; // Opis normy
+    };
+
+    /**
+     * @brief Zwraca normy dla kodu parametru (PM10, PM2.5, O3, NO2, SO2, CO)
+     * @param parameterCode Kod parametru
+     * @return Lista norm (pusta dla parametrów bez norm)
+     */
+    QList<Norm> normsFor(const QString &parameterCode);
+
+    /**
+     * @brief Liczy przekroczenia normy
+     * @param series Szereg posortowany rosnąco według czasu
+     * @param norm Norma
+     * @return Liczba godzin (Hourly) lub dni (pozostałe) z przekroczeniem
+     */
+    qsizetype countExceedances(const TimeSeries &series, const Norm &norm);
+}
+
+#endif // ANALYSIS_H
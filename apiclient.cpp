@@ -1,123 +1,513 @@
 #include "apiclient.h"
 #include "dataparser.h"
+#include "metrics.h"
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QUrl>
 #include <QNetworkRequest>
-#include <QtConcurrentRun>
-#include <QEventLoop>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
 #include <QDebug>
 
+namespace {
+
+// Rodzaj endpointu bez identyfikatora - etykieta metryk o ograniczonej liczbie wartości
+QString endpointKind(const QString &endpoint)
+{
+    QString kind = endpoint.mid(1);
+    const qsizetype slash = kind.lastIndexOf('/');
+    if (slash > 0) {
+        bool numeric = false;
+        QStringView(kind).mid(slash + 1).toInt(&numeric);
+        if (numeric) kind.truncate(slash);
+    }
+    return kind;
+}
+
+QString endpointLabel(const QString &kind)
+{
+    return QString("endpoint=\"%1\"").arg(kind);
+}
+
+// Liczba odpowiedzi czekających w puli wątków na parsowanie (od spełnienia obietnicy do startu kontynuacji)
+Metrics::Gauge &parseQueueDepth()
+{
+    static Metrics::Gauge &gauge = Metrics::instance().gauge("pogoda_parse_queue_depth");
+    return gauge;
+}
+
+/**
+ * @brief Zakres kontynuacji parsującej odpowiedź: zdejmuje zadanie z licznika kolejki i mierzy parsowanie
+ */
+class ParseScope
+{
+public:
+    explicit ParseScope(Metrics::Histogram &histogram) : timer(histogram) { parseQueueDepth().add(-1); }
+
+private:
+    Metrics::ScopedTimer timer;
+};
+
+/**
+ * @struct RequestTimings
+ * @brief Znaczniki czasu faz jednego żądania (w ns od wysłania, -1 - faza nie wystąpiła)
+ *
+ * Qt nie rozdziela rozwiązywania nazwy i nawiązywania połączenia: faza "queue"
+ * trwa do sygnału socketStartedConnecting (oczekiwanie na wolny kanał menadżera),
+ * a faza "connect" obejmuje DNS, TCP i TLS aż do wysłania żądania. Przy połączeniu
+ * keep-alive obie fazy nie występują.
+ */
+struct RequestTimings {
+    QElapsedTimer clock;
+    qint64 connectingNs = -1;
+    qint64 sentNs = -1;
+    qint64 headersNs = -1;
+};
+
+void recordPhase(const QString &labels, const char *phase, qint64 fromNs, qint64 toNs)
+{
+    if (fromNs < 0 || toNs < fromNs) return;
+    Metrics::instance().histogram("pogoda_http_phase_seconds", labels + QString(",phase=\"%1\"").arg(phase))
+        .record((toNs - fromNs) / 1000);
+}
+
+void recordTimings(const QString &endpoint, QNetworkReply *reply, const RequestTimings &timings)
+{
+    const qint64 finishedNs = timings.clock.nsecsElapsed();
+    const QString labels = endpointLabel(endpointKind(endpoint));
+    Metrics &metrics = Metrics::instance();
+    metrics.gauge("pogoda_http_requests_in_flight").add(-1);
+
+    // Fazy kolejnych znaczników; brakujący znacznik (np. połączenie keep-alive) pomija fazę
+    const qint64 connectStart = timings.connectingNs >= 0 ? timings.connectingNs : 0;
+    recordPhase(labels, "queue", 0, timings.connectingNs);
+    recordPhase(labels, "connect", timings.connectingNs, timings.sentNs);
+    recordPhase(labels, "ttfb", timings.sentNs >= 0 ? timings.sentNs : connectStart, timings.headersNs);
+    recordPhase(labels, "body", timings.headersNs, finishedNs);
+    metrics.histogram("pogoda_http_request_seconds", labels).record(finishedNs / 1000);
+
+    const char *outcome = "ok";
+    if (reply->error() == QNetworkReply::OperationCanceledError) {
+        outcome = "aborted";
+    } else if (reply->error() != QNetworkReply::NoError) {
+        outcome = "error";
+    } else if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304) {
+        outcome = "not_modified";
+    }
+    metrics.counter("pogoda_http_requests_total", labels + QString(",outcome=\"%1\"").arg(outcome)).add();
+    metrics.counter("pogoda_http_received_bytes_total", labels).add(quint64(qMax<qint64>(0, reply->bytesAvailable())));
+}
+
+}
+
 ApiClient::ApiClient(QObject *parent) : QObject(parent),
     manager(new QNetworkAccessManager(this)),
-    baseUrl("https://api.gios.gov.pl/pjp-api/rest") // Bazowy URL -> strona GIOŚ
+    cache(new ResponseCache(this))
+{
+    setBaseUrl(qEnvironmentVariable("POGODA_API_URL", "https://api.gios.gov.pl/pjp-api/rest")); // Bazowy URL -> strona GIOŚ
+}
+
+void ApiClient::setBaseUrl(const QString &url)
 {
+    baseUrl = url;
+    while (baseUrl.endsWith('/')) {
+        baseUrl.chop(1);
+    }
+}
+
+void ApiClient::setCacheEnabled(bool enabled)
+{
+    cacheEnabled = enabled;
+}
+
+void ApiClient::setRequestPolicy(const RequestPolicy::Options &options)
+{
+    QMetaObject::invokeMethod(this, [this, options]() { policy.setOptions(options); });
 }
 
 QFuture<QList<Station>> ApiClient::fetchAllStations()
 {
-    return QtConcurrent::run([this]() -> QList<Station> {
-        try {
-            QFuture<QJsonDocument> future = makeApiRequest("/station/findAll");
-            future.waitForFinished();
-            return DataParser::parseStations(future.result());
-        } catch (const std::exception& e) {
-            qWarning() << "Error fetching stations:" << e.what();
-            return QList<Station>();
-        }
-    });
+    const QString endpoint = "/station/findAll";
+    QFuture<QByteArray> pending = makeApiRequest(endpoint);
+    QFuture<QList<Station>> result = pending
+        .then(QtFuture::Launch::Async, [this](const QByteArray &body) {
+            static Metrics::Histogram &parseTime =
+                Metrics::instance().histogram("pogoda_http_parse_seconds", endpointLabel("station/findAll"));
+            ParseScope scope(parseTime);
+            return DataParser::parseStations(parseJson(body));
+        });
+    abortWhenCanceled(endpoint, pending, QFuture<void>(result));
+    return result;
 }
 
-QFuture<QList<MeasurementStation>> ApiClient::fetchStationSensors(int stationId)
+QFuture<QList<MeasurementStation>> ApiClient::fetchStationSensors(int stationId, QNetworkRequest::Priority priority)
 {
-    return QtConcurrent::run([this, stationId]() {
-        auto response = makeApiRequest(QString("/station/sensors/%1").arg(stationId)).result();
-        qDebug() << "Odpowiedź API czujników:" << response;
-        return DataParser::parseSensors(response);
-    });
+    const QString endpoint = QString("/station/sensors/%1").arg(stationId);
+    QFuture<QByteArray> pending = makeApiRequest(endpoint, priority);
+    QFuture<QList<MeasurementStation>> result = pending
+        .then(QtFuture::Launch::Async, [this](const QByteArray &body) {
+            static Metrics::Histogram &parseTime =
+                Metrics::instance().histogram("pogoda_http_parse_seconds", endpointLabel("station/sensors"));
+            ParseScope scope(parseTime);
+            return DataParser::parseSensors(parseJson(body));
+        });
+    abortWhenCanceled(endpoint, pending, QFuture<void>(result));
+    return result;
 }
 
-QFuture<MeasurementData> ApiClient::fetchSensorData(int sensorId)
+QFuture<MeasurementData> ApiClient::fetchSensorData(int sensorId, QNetworkRequest::Priority priority)
 {
-    return QtConcurrent::run([this, sensorId]() -> MeasurementData {
-        try {
-            QFuture<QJsonDocument> future = makeApiRequest(QString("/data/getData/%1").arg(sensorId));
-            future.waitForFinished();
-            return DataParser::parseSensorData(future.result());
-        } catch (const std::exception& e) {
-            qWarning() << "Error fetching sensor data:" << e.what();
-            return MeasurementData();
-        }
-    });
+    const QString endpoint = QString("/data/getData/%1").arg(sensorId);
+    QFuture<QByteArray> pending = makeApiRequest(endpoint, priority);
+    QFuture<MeasurementData> result = pending
+        .then(QtFuture::Launch::Async, [this](const QByteArray &body) {
+            static Metrics::Histogram &parseTime =
+                Metrics::instance().histogram("pogoda_http_parse_seconds", endpointLabel("data/getData"));
+            ParseScope scope(parseTime);
+            // Dekoder strumieniowy; dokumenty, których nie obsługuje, trafiają do parsera DOM
+            MeasurementData data;
+            if (DataParser::decodeSensorData(body, data)) {
+                return data;
+            }
+            return DataParser::parseSensorData(parseJson(body));
+        });
+    abortWhenCanceled(endpoint, pending, QFuture<void>(result));
+    return result;
 }
 
-QFuture<AirQualityIndex> ApiClient::fetchAirQualityIndex(int stationId)
+QFuture<AirQualityIndex> ApiClient::fetchAirQualityIndex(int stationId, QNetworkRequest::Priority priority)
 {
-    return QtConcurrent::run([this, stationId]() -> AirQualityIndex {
-        try {
-            QFuture<QJsonDocument> future = makeApiRequest(QString("/aqindex/getIndex/%1").arg(stationId));
-            future.waitForFinished();
-            return DataParser::parseAirQualityIndex(future.result());
-        } catch (const std::exception& e) {
-            qWarning() << "Error fetching air quality index:" << e.what();
-            return AirQualityIndex();
+    const QString endpoint = QString("/aqindex/getIndex/%1").arg(stationId);
+    QFuture<QByteArray> pending = makeApiRequest(endpoint, priority);
+    QFuture<AirQualityIndex> result = pending
+        .then(QtFuture::Launch::Async, [this](const QByteArray &body) {
+            static Metrics::Histogram &parseTime =
+                Metrics::instance().histogram("pogoda_http_parse_seconds", endpointLabel("aqindex/getIndex"));
+            ParseScope scope(parseTime);
+            return DataParser::parseAirQualityIndex(parseJson(body));
+        });
+    abortWhenCanceled(endpoint, pending, QFuture<void>(result));
+    return result;
+}
+
+QFuture<QByteArray> ApiClient::makeApiRequest(const QString &endpoint, QNetworkRequest::Priority priority)
+{
+    // Odpowiedzi różnych serwerów (GIOŚ, symulator) są buforowane i łączone osobno
+    const QString base = baseUrl;
+    auto promise = std::make_shared<QPromise<QByteArray>>();
+    QFuture<QByteArray> future = promise->future();
+    promise->start();
+
+    if (!cacheEnabled) {
+        sendRequest(base, endpoint, ResponseCache::Lookup(), promise, priority);
+        return future;
+    }
+
+    // Wpis spoza pamięci jest czytany z dysku w puli wątków - wątek wywołujący (zwykle GUI) nie czeka na plik
+    QtConcurrent::run([cache = cache, base, endpoint]() { return cache->lookup(base, endpoint); })
+        .then(this, [this, base, endpoint, promise, priority](const ResponseCache::Lookup &cached) {
+            if (Metrics::enabled()) {
+                static const char *const Results[] = {"missing", "fresh", "stale", "expired"};
+                Metrics::instance().counter("pogoda_cache_lookups_total",
+                                            QString("result=\"%1\"").arg(Results[int(cached.freshness)])).add();
+            }
+            if (promise->isCanceled()) {
+                promise->finish(); // Wywołujący zrezygnował przed końcem wyszukiwania
+                return;
+            }
+            switch (cached.freshness) {
+            case ResponseCache::Freshness::Fresh:
+                parseQueueDepth().add(1);
+                promise->addResult(cached.body);
+                promise->finish();
+                return;
+            case ResponseCache::Freshness::Stale:
+                // Nieaktualna odpowiedź jest zwracana od razu, a odświeżenie trwa w tle
+                sendRequest(base, endpoint, cached, nullptr, QNetworkRequest::LowPriority);
+                parseQueueDepth().add(1);
+                promise->addResult(cached.body);
+                promise->finish();
+                return;
+            case ResponseCache::Freshness::Expired:
+            case ResponseCache::Freshness::Missing:
+                break;
+            }
+            sendRequest(base, endpoint, cached, promise, priority);
+        });
+    return future;
+}
+
+void ApiClient::sendRequest(const QString &base, const QString &endpoint, const ResponseCache::Lookup &cached,
+                            std::shared_ptr<QPromise<QByteArray>> promise, QNetworkRequest::Priority priority)
+{
+    // QNetworkAccessManager może być używany tylko w swoim wątku
+    QMetaObject::invokeMethod(this, [this, base, endpoint, cached, promise, priority]() {
+        std::shared_ptr<InFlightRequest> &slot = inFlight[base + endpoint];
+        if (slot) {
+            // Ten sam zasób jest już pobierany - dołączenie do żądania w toku zamiast drugiego żądania
+            if (promise) {
+                slot->subscribers.append(promise);
+                // Mniejsza wartość to wyższy priorytet; dotyczy kolejnych prób (ponowień, zabezpieczeń)
+                slot->priority = qMin(slot->priority, priority);
+                if (Metrics::enabled()) {
+                    Metrics::instance().counter("pogoda_http_coalesced_total", endpointLabel(endpointKind(endpoint))).add();
+                }
+            }
+            return;
+        }
+        const std::shared_ptr<InFlightRequest> entry = std::make_shared<InFlightRequest>();
+        entry->baseUrl = base;
+        entry->cached = cached;
+        entry->priority = priority;
+        if (promise) {
+            entry->subscribers.append(promise);
+        }
+        slot = entry;
+
+        policy.recordRequest();
+        if (!policy.allowRequest()) {
+            // Bezpiecznik otwarty - serwer nie dostaje kolejnych żądań, dopóki się nie odblokuje
+            finishRequest(endpoint, entry, QByteArray(), "service unavailable (circuit breaker open)");
+            return;
         }
+        startAttempt(endpoint, entry, false);
     });
 }
 
-QFuture<QJsonDocument> ApiClient::makeApiRequest(const QString &endpoint)
+void ApiClient::startAttempt(const QString &endpoint, const std::shared_ptr<InFlightRequest> &entry, bool hedge)
 {
-    return QtConcurrent::run([this, endpoint]() -> QJsonDocument {
-        QEventLoop loop;
-        QNetworkReply* reply = nullptr;
-        QJsonDocument jsonResponse;
-        QTimer timer;
+    QUrl url(entry->baseUrl + endpoint); // Bazowy URL + endpoint
+    QNetworkRequest request(url);
+    request.setPriority(entry->priority);
+
+    //Ustawianie nagłówków
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    if (!entry->cached.body.isEmpty()) {
+        // Rewalidacja warunkowa - serwer odpowie 304, jeśli dane się nie zmieniły
+        if (!entry->cached.etag.isEmpty()) {
+            request.setRawHeader("If-None-Match", entry->cached.etag);
+        }
+        if (!entry->cached.lastModified.isEmpty()) {
+            request.setRawHeader("If-Modified-Since", entry->cached.lastModified);
+        }
+    }
+
+    //Wysyłanie żądania GET
+    QNetworkReply *reply = manager->get(request);
+    entry->replies.append(reply);
+    const QString kind = endpointKind(endpoint);
+    QElapsedTimer started;
+    started.start();
+
+    // Fazy żądania są mierzone tylko przy włączonych metrykach - inaczej bez dodatkowych połączeń sygnałów
+    std::shared_ptr<RequestTimings> timings;
+    if (Metrics::enabled()) {
+        timings = std::make_shared<RequestTimings>();
+        timings->clock.start();
+        Metrics::instance().gauge("pogoda_http_requests_in_flight").add(1);
+        connect(reply, &QNetworkReply::socketStartedConnecting, this, [timings]() {
+            if (timings->connectingNs < 0) timings->connectingNs = timings->clock.nsecsElapsed();
+        });
+        connect(reply, &QNetworkReply::requestSent, this, [timings]() {
+            if (timings->sentNs < 0) timings->sentNs = timings->clock.nsecsElapsed();
+        });
+        connect(reply, &QNetworkReply::metaDataChanged, this, [timings]() {
+            if (timings->headersNs < 0) timings->headersNs = timings->clock.nsecsElapsed();
+        });
+    }
 
-        timer.setSingleShot(true);
-        QObject::connect(&timer, &QTimer::timeout, [&loop, &reply]() {
-            if (reply && reply->isRunning()) {
-                reply->abort();
-                loop.quit();
+    // Limit czasu z percentyli endpointu - timer żyje tak długo jak odpowiedź
+    const int timeout = policy.timeoutMs(kind);
+    QTimer::singleShot(timeout, reply, [reply]() {
+        if (reply->isRunning()) {
+            reply->setProperty("timedOut", true);
+            reply->abort();
+        }
+    });
+
+    // Żądanie zabezpieczające: odpowiedź wolniejsza niż P95 prawdopodobnie utknęła w ogonie rozkładu
+    const int hedgeDelay = hedge ? -1 : policy.hedgeDelayMs(kind);
+    if (hedgeDelay >= 0 && hedgeDelay < timeout) {
+        QTimer::singleShot(hedgeDelay, reply, [this, endpoint, entry, reply]() {
+            if (entry->finished || !reply->isRunning() || entry->replies.size() > 1) return;
+            if (!policy.tryAcquireRetry()) return;
+            if (Metrics::enabled()) {
+                Metrics::instance().counter("pogoda_http_hedges_total", endpointLabel(endpointKind(endpoint))).add();
             }
+            startAttempt(endpoint, entry, true);
         });
+    }
 
-        try {
-            QUrl url(baseUrl + endpoint); // Bazowy URL + endpoint
-            QNetworkRequest request(url);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, endpoint, entry, timings, started, hedge]() {
+        if (timings) {
+            recordTimings(endpoint, reply, *timings);
+        }
+        onAttemptFinished(endpoint, entry, reply, started.elapsed(), hedge);
+    });
+}
 
-            //Ustawianie nagłówków
-            request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+void ApiClient::onAttemptFinished(const QString &endpoint, const std::shared_ptr<InFlightRequest> &entry,
+                                  QNetworkReply *reply, qint64 elapsedMs, bool hedge)
+{
+    entry->replies.removeAll(reply);
+    reply->deleteLater();
 
-            //Wysyłanie żądania GET
-            reply = manager->get(request);
-            timer.start(10000); // 10 sekund timeout
+    // Odpowiedź już dostarczona przez inną próbę albo żądanie porzucone przez wszystkich oczekujących
+    if (entry->finished || inFlight.value(entry->baseUrl + endpoint) != entry) return;
 
-            QObject::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-            QObject::connect(reply, &QNetworkReply::errorOccurred, [this](QNetworkReply::NetworkError code) {
-                emit errorOccurred(tr("Network error: ") + QString::number(code));
-            });
+    const QString kind = endpointKind(endpoint);
+    const QNetworkReply::NetworkError error = reply->error();
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const bool timedOut = reply->property("timedOut").toBool();
 
-            loop.exec(); // Oczekiwanie na odpowiedź
+    if (error == QNetworkReply::NoError) {
+        policy.recordLatency(kind, elapsedMs);
+        policy.recordSuccess();
+        if (hedge && Metrics::enabled()) {
+            Metrics::instance().counter("pogoda_http_hedge_wins_total", endpointLabel(kind)).add();
+        }
 
-            //Przetwarzanie odpowiedzi
-            if (reply->error() == QNetworkReply::NoError) {
-                QByteArray responseData = reply->readAll();
-                jsonResponse = QJsonDocument::fromJson(responseData);
-                if (jsonResponse.isNull()) {
-                    throw std::runtime_error("Invalid JSON response");
-                }
-            } else {
-                throw std::runtime_error(reply->errorString().toStdString());
+        QByteArray body;
+        if (status == 304 && !entry->cached.body.isEmpty()) {
+            cache->refresh(entry->baseUrl, endpoint);
+            body = entry->cached.body;
+        } else {
+            body = reply->readAll();
+            if (cacheEnabled) {
+                cache->store(entry->baseUrl, endpoint, body, reply->rawHeader("ETag"), reply->rawHeader("Last-Modified"));
+            }
+        }
+        finishRequest(endpoint, entry, body, QString());
+        return;
+    }
+
+    // Ponawiane są błędy sieci, przekroczenia czasu, 429 i 5xx; pozostałe odpowiedzi serwera są ostateczne
+    const bool retryable = timedOut || status == 429 || status >= 500
+                           || (status == 0 && error != QNetworkReply::OperationCanceledError);
+    if (timedOut) {
+        policy.recordLatency(kind, elapsedMs);
+    }
+    if (retryable) {
+        policy.recordFailure();
+    } else {
+        policy.recordSuccess(); // Serwer odpowiedział - bezpiecznik nie dotyczy błędów klienta
+    }
+    const QString failure = QString("%1 (%2)").arg(reply->errorString()).arg(int(error));
+
+    if (!entry->replies.isEmpty()) return; // Druga próba (zabezpieczająca) nadal trwa
+
+    if (retryable && entry->attempt + 1 < policy.options().maxAttempts && policy.tryAcquireRetry()) {
+        ++entry->attempt;
+        int delay = policy.backoffMs(entry->attempt);
+        bool hasRetryAfter = false;
+        const int retryAfterSeconds = reply->rawHeader("Retry-After").toInt(&hasRetryAfter);
+        if (hasRetryAfter) {
+            delay = qMax(delay, retryAfterSeconds * 1000);
+        }
+        if (Metrics::enabled()) {
+            Metrics::instance().counter("pogoda_http_retries_total", endpointLabel(kind)).add();
+        }
+        QTimer::singleShot(delay, this, [this, endpoint, entry]() {
+            if (entry->finished || inFlight.value(entry->baseUrl + endpoint) != entry) return;
+            if (!policy.allowRequest()) {
+                finishRequest(endpoint, entry, QByteArray(), "service unavailable (circuit breaker open)");
+                return;
             }
-        } catch (const std::exception& e) {
-            emit errorOccurred(QString("API request failed: %1").arg(e.what()));
-            jsonResponse = QJsonDocument();
+            startAttempt(endpoint, entry, false);
+        });
+        return;
+    }
+    finishRequest(endpoint, entry, QByteArray(), failure);
+}
+
+void ApiClient::finishRequest(const QString &endpoint, const std::shared_ptr<InFlightRequest> &entry,
+                              QByteArray body, const QString &failure)
+{
+    entry->finished = true;
+    const QString url = entry->baseUrl + endpoint;
+    if (inFlight.value(url) == entry) {
+        inFlight.remove(url);
+    }
+
+    if (!failure.isEmpty()) {
+        if (!entry->cached.body.isEmpty()) {
+            // Przy błędzie sieci lepiej pokazać przeterminowane dane niż żadne
+            qWarning() << "Revalidation failed, serving cached response:" << endpoint << failure;
+            body = entry->cached.body;
+        } else if (!entry->subscribers.isEmpty()) {
+            emit errorOccurred(QString("API request failed: %1").arg(failure));
         }
+    }
 
-        if (reply) {
-            reply->deleteLater();
+    for (const std::shared_ptr<QPromise<QByteArray>> &subscriber : std::as_const(entry->subscribers)) {
+        if (!subscriber->isCanceled()) {
+            parseQueueDepth().add(1);
+            subscriber->addResult(body);
         }
-        return jsonResponse;
+        subscriber->finish();
+    }
+
+    // Przegrana próba (pierwsza albo zabezpieczająca) nie jest już potrzebna
+    const QList<QPointer<QNetworkReply>> remaining = entry->replies;
+    for (const QPointer<QNetworkReply> &reply : remaining) {
+        if (reply) reply->abort();
+    }
+}
+
+void ApiClient::abortWhenCanceled(const QString &endpoint, QFuture<QByteArray> body, QFuture<void> result)
+{
+    if (body.isFinished()) return; // Wynik już dostarczony - nie ma czego przerywać
+
+    const QString base = baseUrl;
+    QMetaObject::invokeMethod(this, [this, base, endpoint, body, result]() {
+        auto *watcher = new QFutureWatcher<void>(this);
+        connect(watcher, &QFutureWatcherBase::canceled, this, [this, base, endpoint, body]() mutable {
+            // Anulowana treść nie uruchamia kontynuacji parsującej
+            body.cancel();
+            releaseCanceled(base, endpoint);
+        });
+        connect(watcher, &QFutureWatcherBase::finished, watcher, &QObject::deleteLater);
+        watcher->setFuture(result);
     });
 }
+
+void ApiClient::releaseCanceled(const QString &base, const QString &endpoint)
+{
+    auto it = inFlight.find(base + endpoint);
+    if (it == inFlight.end()) return;
+
+    const std::shared_ptr<InFlightRequest> entry = *it;
+    const qsizetype released = entry->subscribers.removeIf([](const std::shared_ptr<QPromise<QByteArray>> &subscriber) {
+        if (!subscriber->isCanceled()) return false;
+        subscriber->finish();
+        return true;
+    });
+    if (released == 0 || !entry->subscribers.isEmpty()) return;
+
+    // Nikt już nie czeka na odpowiedź - przerwanie zwalnia połączenie dla kolejnych żądań
+    inFlight.erase(it);
+    entry->finished = true;
+    if (Metrics::enabled()) {
+        Metrics::instance().counter("pogoda_http_abandoned_total", endpointLabel(endpointKind(endpoint))).add();
+    }
+    const QList<QPointer<QNetworkReply>> replies = entry->replies;
+    for (const QPointer<QNetworkReply> &reply : replies) {
+        if (reply) reply->abort();
+    }
+}
+
+QJsonDocument ApiClient::parseJson(const QByteArray &body)
+{
+    if (body.isEmpty()) {
+        return QJsonDocument();
+    }
+
+    QJsonParseError error;
+    QJsonDocument json = QJsonDocument::fromJson(body, &error);
+    if (json.isNull()) {
+        emit errorOccurred(QString("API request failed: Invalid JSON response (%1)")
+                               .arg(error.errorString()));
+    }
+    return json;
+}
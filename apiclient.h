@@ -8,10 +8,17 @@
 #include <QObject>
 #include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
 #include <QtConcurrent/QtConcurrent>
 #include <QFuture>
+#include <QPromise>
+#include <QPointer>
+#include <QHash>
+#include <memory>
 #include "station.h"
 #include "measurement.h"
+#include "responsecache.h"
+#include "requestpolicy.h"
 
 /**
  * @class ApiClient
@@ -19,6 +26,19 @@
  *
  * Klasa wykorzystuje QNetworkAccessManager do wysyłania żądań HTTP
  * i zwraca dane w postaci obiektów QFuture dla asynchronicznego przetwarzania.
+ * Żądania są w pełni nieblokujące: sygnał finished odpowiedzi kończy QPromise,
+ * a parsowanie JSON odbywa się w puli wątków, więc żaden wątek nie czeka na sieć.
+ * Odpowiedzi są buforowane na dysku przez ResponseCache w sposób niewidoczny
+ * dla wywołujących metody fetch*. Przy włączonych metrykach (Metrics) mierzone są
+ * fazy żądań, wyniki rewalidacji i czasy parsowania dla każdego rodzaju endpointu.
+ *
+ * Równoczesne żądania tego samego adresu (bazowy URL + endpoint) są łączone w jedno żądanie HTTP,
+ * którego wynik trafia do wszystkich oczekujących. Anulowanie przyszłego wyniku
+ * metody fetch* wypisuje wywołującego, a gdy nikt już nie czeka na odpowiedź,
+ * żądanie sieciowe jest przerywane, a parsowanie nie jest uruchamiane.
+ *
+ * Limity czasu, żądania zabezpieczające, ponowienia i bezpiecznik wyznacza
+ * RequestPolicy na podstawie zaobserwowanych czasów odpowiedzi endpointów.
  */
 class ApiClient : public QObject
 {
@@ -32,6 +52,30 @@ public:
      */
     explicit ApiClient(QObject *parent = nullptr);
 
+    /**
+     * @brief Ustawia bazowy URL API
+     *
+     * Domyślnie używany jest serwer GIOŚ albo adres ze zmiennej środowiskowej
+     * POGODA_API_URL (np. symulator pogoda_sim).
+     * @param url Bazowy URL, do którego dołączane są ścieżki endpointów
+     */
+    void setBaseUrl(const QString &url);
+
+    /**
+     * @brief Włącza lub wyłącza dyskową pamięć podręczną odpowiedzi
+     *
+     * Wyłączenie przydaje się w testach obciążeniowych, w których każde
+     * żądanie ma trafić do serwera.
+     * @param enabled true, jeśli odpowiedzi mają być buforowane
+     */
+    void setCacheEnabled(bool enabled);
+
+    /**
+     * @brief Ustawia parametry limitów czasu, ponowień i bezpiecznika
+     * @param options Parametry polityki żądań
+     */
+    void setRequestPolicy(const RequestPolicy::Options &options);
+
     /**
      * @brief Pobiera listę wszystkich stacji pomiarowych
      * @return QFuture<QList<Station>> - przyszły wynik z listą stacji
@@ -41,23 +85,29 @@ public:
     /**
      * @brief Pobiera stanowiska pomiarowe dla danej stacji
      * @param stationId ID stacji
+     * @param priority Priorytet żądania (LowPriority dla pobierania z wyprzedzeniem)
      * @return QFuture<QList<MeasurementStation>> - przyszły wynik z listą czujników
      */
-    QFuture<QList<MeasurementStation>> fetchStationSensors(int stationId);
+    QFuture<QList<MeasurementStation>> fetchStationSensors(
+        int stationId, QNetworkRequest::Priority priority = QNetworkRequest::NormalPriority);
 
     /**
      * @brief Pobiera dane pomiarowe dla danego czujnika
      * @param sensorId ID czujnika
+     * @param priority Priorytet żądania (LowPriority dla pobierania z wyprzedzeniem)
      * @return QFuture<MeasurementData> - przyszły wynik z danymi pomiarowymi
      */
-    QFuture<MeasurementData> fetchSensorData(int sensorId);
+    QFuture<MeasurementData> fetchSensorData(
+        int sensorId, QNetworkRequest::Priority priority = QNetworkRequest::NormalPriority);
 
     /**
      * @brief Pobiera indeks jakości powietrza dla stacji
      * @param stationId ID stacji
+     * @param priority Priorytet żądania (LowPriority dla pobierania z wyprzedzeniem)
      * @return QFuture<AirQualityIndex> - przyszły wynik z indeksem jakości powietrza
      */
-    QFuture<AirQualityIndex> fetchAirQualityIndex(int stationId);
+    QFuture<AirQualityIndex> fetchAirQualityIndex(
+        int stationId, QNetworkRequest::Priority priority = QNetworkRequest::NormalPriority);
 
 signals:
 
@@ -68,15 +118,106 @@ signals:
     void errorOccurred(const QString &message);
 
 private:
+
+    /**
+     * @struct InFlightRequest
+     * @brief Żądanie w toku wspólne dla wszystkich wywołujących proszących o ten sam endpoint
+     */
+    struct InFlightRequest {
+        QString baseUrl; // Bazowy URL z chwili wysłania (część klucza w inFlight i w pamięci podręcznej)
+        QList<QPointer<QNetworkReply>> replies; // Próby w toku (zwykła i ewentualnie zabezpieczająca)
+        QList<std::shared_ptr<QPromise<QByteArray>>> subscribers; // Obietnice oczekujących
+        ResponseCache::Lookup cached; // Wpis do rewalidacji i odpowiedź awaryjna
+        QNetworkRequest::Priority priority = QNetworkRequest::LowPriority; // Najwyższy priorytet oczekujących
+        int attempt = 0; // Numer ponowienia
+        bool finished = false; // Czy wynik został już dostarczony (lub żądanie porzucone)
+    };
+
     QNetworkAccessManager *manager; // Menadżer połączeń sieciowych
-    const QString baseUrl = "https://api.gios.gov.pl/pjp-api/rest"; // Bazowy URL API
+    ResponseCache *cache; // Dyskowa pamięć podręczna odpowiedzi
+    QString baseUrl; // Bazowy URL API
+    bool cacheEnabled = true; // Czy używać pamięci podręcznej
+    RequestPolicy policy; // Limity czasu, ponowienia i bezpiecznik (tylko wątek obiektu)
+    QHash<QString, std::shared_ptr<InFlightRequest>> inFlight; // Żądania w toku według adresu (tylko wątek obiektu)
 
     /**
      * @brief Wykonuje żądanie do API
+     *
+     * Pamięć podręczna jest przeszukiwana w puli wątków (odczyt pliku nie blokuje
+     * wywołującego), a wpis aktualny lub nieaktualny kończy wynik bez sieci.
+     * Żądanie jest wysyłane w wątku menadżera sieci, a wynik ustawiany
+     * bezpośrednio w slocie obsługującym sygnał finished odpowiedzi.
+     * W przypadku błędu emitowany jest errorOccurred, a wynikiem jest pusta tablica.
+     * Jeśli ten sam adres jest już pobierany, wywołujący dołącza do żądania w toku.
+     * @param endpoint Endpoint API
+     * @param priority Priorytet żądania w kolejce menadżera sieci
+     * @return QFuture<QByteArray> - przyszły wynik z surową treścią odpowiedzi
+     */
+    QFuture<QByteArray> makeApiRequest(const QString &endpoint,
+                                       QNetworkRequest::Priority priority = QNetworkRequest::NormalPriority);
+
+    /**
+     * @brief Przerywa pobieranie, gdy wynik metody fetch* zostanie anulowany
+     * @param endpoint Endpoint API
+     * @param body Przyszła treść odpowiedzi zwrócona przez makeApiRequest
+     * @param result Przyszły wynik zwracany wywołującemu
+     */
+    void abortWhenCanceled(const QString &endpoint, QFuture<QByteArray> body, QFuture<void> result);
+
+    /**
+     * @brief Wypisuje anulowanych oczekujących z żądania w toku i przerywa je, jeśli nikt już nie czeka
+     * @param base Bazowy URL z chwili wysłania
+     * @param endpoint Endpoint API
+     */
+    void releaseCanceled(const QString &base, const QString &endpoint);
+
+    /**
+     * @brief Wysyła żądanie HTTP, opcjonalnie warunkowe względem wpisu z pamięci podręcznej
+     * @param base Bazowy URL API
      * @param endpoint Endpoint API
-     * @return QFuture<QJsonDocument> - przyszły wynik z odpowiedzią JSON
+     * @param cached Wpis z pamięci podręcznej (może być pusty)
+     * @param promise Obietnica do spełnienia (nullptr dla odświeżania w tle, które
+     *                nie jest wysyłane, jeśli adres jest już pobierany)
+     * @param priority Priorytet żądania
+     */
+    void sendRequest(const QString &base, const QString &endpoint, const ResponseCache::Lookup &cached,
+                     std::shared_ptr<QPromise<QByteArray>> promise, QNetworkRequest::Priority priority);
+
+    /**
+     * @brief Wysyła jedną próbę żądania z adaptacyjnym limitem czasu
+     * @param endpoint Endpoint API
+     * @param entry Żądanie w toku
+     * @param hedge true dla żądania zabezpieczającego (bez kolejnego zabezpieczenia)
+     */
+    void startAttempt(const QString &endpoint, const std::shared_ptr<InFlightRequest> &entry, bool hedge);
+
+    /**
+     * @brief Obsługuje zakończoną próbę: dostarcza wynik, czeka na drugą próbę albo planuje ponowienie
+     * @param endpoint Endpoint API
+     * @param entry Żądanie w toku
+     * @param reply Zakończona odpowiedź
+     * @param elapsedMs Czas trwania próby
+     * @param hedge true dla żądania zabezpieczającego
+     */
+    void onAttemptFinished(const QString &endpoint, const std::shared_ptr<InFlightRequest> &entry,
+                           QNetworkReply *reply, qint64 elapsedMs, bool hedge);
+
+    /**
+     * @brief Kończy żądanie w toku i spełnia obietnice wszystkich oczekujących
+     * @param endpoint Endpoint API
+     * @param entry Żądanie w toku
+     * @param body Treść odpowiedzi
+     * @param failure Opis błędu (pusty, jeśli żądanie się powiodło)
+     */
+    void finishRequest(const QString &endpoint, const std::shared_ptr<InFlightRequest> &entry,
+                       QByteArray body, const QString &failure);
+
+    /**
+     * @brief Zamienia treść odpowiedzi na dokument JSON
+     * @param body Surowa treść odpowiedzi
+     * @return Dokument JSON (pusty, jeśli odpowiedź była pusta lub niepoprawna)
      */
-    QFuture<QJsonDocument> makeApiRequest(const QString &endpoint);
+    QJsonDocument parseJson(const QByteArray &body);
 };
 
 #endif // APICLIENT_H
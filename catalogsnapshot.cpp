@@ -0,0 +1,269 @@
+#include "catalogsnapshot.h"
+#include "metrics.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+constexpr quint32 CatalogMagic = 0x54434750; // "PGCT"
+constexpr quint16 CatalogVersion = 1;
+
+/**
+ * @struct CatalogHeader
+ * @brief Nagłówek pliku kopii (64 bajty, kolejność bajtów maszyny)
+ *
+ * Za nagłówkiem: StationRecord[stationCount], SensorRecord[sensorCount],
+ * przesunięcia napisów quint32[stringCount + 1] (w jednostkach UTF-16)
+ * i znaki napisów char16_t[stringUnits]. Napis 0 jest pusty.
+ */
+struct CatalogHeader {
+    quint32 magic; // Sygnatura "PGCT"
+    quint16 version; // Wersja formatu
+    quint16 flags; // Flagi (zarezerwowane)
+    qint64 savedAtMs; // Czas zapisu
+    quint32 stationCount; // Liczba stacji
+    quint32 sensorCount; // Liczba czujników
+    quint32 stringCount; // Liczba napisów
+    quint32 stringUnits; // Łączna długość napisów w jednostkach UTF-16
+    quint32 payloadChecksum; // Suma kontrolna danych za nagłówkiem
+    quint32 headerChecksum; // Suma kontrolna poprzednich pól nagłówka
+    quint64 reserved[3]; // Zarezerwowane
+};
+static_assert(sizeof(CatalogHeader) == 64, "CatalogHeader must stay 64 bytes");
+
+struct StationRecord {
+    double lat; // Szerokość geograficzna
+    double lon; // Długość geograficzna
+    qint32 id; // ID stacji
+    quint32 name; // Nazwa stacji (indeks napisu)
+    qint32 cityId; // ID miasta
+    quint32 cityName; // Indeksy napisów lokalizacji
+    quint32 commune;
+    quint32 district;
+    quint32 province;
+    quint32 address;
+};
+static_assert(sizeof(StationRecord) == 48, "StationRecord must stay 48 bytes");
+
+struct SensorRecord {
+    qint32 id; // ID czujnika
+    qint32 stationId; // ID stacji
+    quint32 parameterName; // Indeksy napisów parametru
+    quint32 parameterCode;
+};
+static_assert(sizeof(SensorRecord) == 16, "SensorRecord must stay 16 bytes");
+
+quint32 checksum(const char *data, qsizetype size)
+{
+    return qChecksum(QByteArrayView(data, size), Qt::ChecksumIso3309);
+}
+
+quint32 headerChecksum(const CatalogHeader &header)
+{
+    return checksum(reinterpret_cast<const char *>(&header), offsetof(CatalogHeader, headerChecksum));
+}
+
+/**
+ * @class StringTable
+ * @brief Tablica napisów budowana przy zapisie
+ */
+class StringTable
+{
+public:
+    StringTable() { strings.append(QString()); }
+
+    quint32 add(const QString &text)
+    {
+        if (text.isEmpty()) return 0;
+        auto it = ids.constFind(text);
+        if (it != ids.constEnd()) return *it;
+        const quint32 id = quint32(strings.size());
+        ids.insert(text, id);
+        strings.append(text);
+        return id;
+    }
+
+    quint32 add(SymbolId symbol) { return add(StringPool::resolve(symbol)); }
+
+    const QList<QString> &all() const { return strings; }
+
+private:
+    QHash<QString, quint32> ids; // Napis -> indeks
+    QList<QString> strings; // Indeks -> napis
+};
+
+}
+
+namespace CatalogSnapshot {
+
+QString defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/pogoda_catalog.bin";
+}
+
+bool save(const QString &path, const StationCatalog &catalog)
+{
+    StringTable strings;
+
+    QList<StationRecord> stations;
+    stations.reserve(catalog.stations.size());
+    for (const Station &station : catalog.stations) {
+        StationRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.lat = station.gegrLat;
+        record.lon = station.gegrLon;
+        record.id = station.id;
+        record.name = strings.add(station.stationName);
+        record.cityId = station.city.id;
+        record.cityName = strings.add(station.city.name);
+        record.commune = strings.add(station.city.commune);
+        record.district = strings.add(station.city.district);
+        record.province = strings.add(station.city.province);
+        record.address = strings.add(station.city.address);
+        stations.append(record);
+    }
+
+    // Czujniki w kolejności stacji - odczyt grupuje sąsiednie rekordy
+    QList<int> stationIds = catalog.sensors.keys();
+    std::sort(stationIds.begin(), stationIds.end());
+    QList<SensorRecord> sensors;
+    for (int stationId : stationIds) {
+        for (const MeasurementStation &sensor : catalog.sensors.value(stationId)) {
+            sensors.append(SensorRecord{sensor.id, stationId, strings.add(sensor.parameterName),
+                                        strings.add(sensor.parameterCode)});
+        }
+    }
+
+    QList<quint32> offsets;
+    offsets.reserve(strings.all().size() + 1);
+    QByteArray characters;
+    quint32 units = 0;
+    for (const QString &text : strings.all()) {
+        offsets.append(units);
+        characters.append(reinterpret_cast<const char *>(text.utf16()), text.size() * qsizetype(sizeof(char16_t)));
+        units += quint32(text.size());
+    }
+    offsets.append(units);
+
+    QByteArray payload;
+    payload.append(reinterpret_cast<const char *>(stations.constData()), stations.size() * qsizetype(sizeof(StationRecord)));
+    payload.append(reinterpret_cast<const char *>(sensors.constData()), sensors.size() * qsizetype(sizeof(SensorRecord)));
+    payload.append(reinterpret_cast<const char *>(offsets.constData()), offsets.size() * qsizetype(sizeof(quint32)));
+    payload.append(characters);
+
+    CatalogHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = CatalogMagic;
+    header.version = CatalogVersion;
+    header.savedAtMs = catalog.savedAtMs > 0 ? catalog.savedAtMs : QDateTime::currentMSecsSinceEpoch();
+    header.stationCount = quint32(stations.size());
+    header.sensorCount = quint32(sensors.size());
+    header.stringCount = quint32(strings.all().size());
+    header.stringUnits = units;
+    header.payloadChecksum = checksum(payload.constData(), payload.size());
+    header.headerChecksum = headerChecksum(header);
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not open catalog snapshot for writing:" << path;
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(payload);
+    if (!file.commit()) {
+        qWarning() << "Could not write catalog snapshot:" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool load(const QString &path, StationCatalog &catalog)
+{
+    static Metrics::Histogram &duration =
+        Metrics::instance().histogram("pogoda_catalog_snapshot_seconds", "function=\"load\"");
+    Metrics::ScopedTimer timer(duration);
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < qint64(sizeof(CatalogHeader))) return false;
+
+    // Mapowanie jest zwalniane razem z obiektem QFile
+    const uchar *data = file.map(0, file.size());
+    if (!data) return false;
+
+    CatalogHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != CatalogMagic || header.version != CatalogVersion
+        || header.headerChecksum != headerChecksum(header)) {
+        return false;
+    }
+
+    const qint64 stationBytes = qint64(header.stationCount) * qint64(sizeof(StationRecord));
+    const qint64 sensorBytes = qint64(header.sensorCount) * qint64(sizeof(SensorRecord));
+    const qint64 offsetBytes = (qint64(header.stringCount) + 1) * qint64(sizeof(quint32));
+    const qint64 characterBytes = qint64(header.stringUnits) * qint64(sizeof(char16_t));
+    const qint64 payloadBytes = stationBytes + sensorBytes + offsetBytes + characterBytes;
+    if (header.stringCount == 0 || file.size() != qint64(sizeof(CatalogHeader)) + payloadBytes) return false;
+
+    const char *payload = reinterpret_cast<const char *>(data) + sizeof(CatalogHeader);
+    if (header.payloadChecksum != checksum(payload, payloadBytes)) {
+        qWarning() << "Ignoring corrupted catalog snapshot:" << path;
+        return false;
+    }
+
+    // Rekordy leżą pod wyrównanymi przesunięciami mapowania - czytane są bez kopiowania
+    const auto *stationRecords = reinterpret_cast<const StationRecord *>(payload);
+    const auto *sensorRecords = reinterpret_cast<const SensorRecord *>(payload + stationBytes);
+    const auto *offsets = reinterpret_cast<const quint32 *>(payload + stationBytes + sensorBytes);
+    const auto *characters = reinterpret_cast<const char16_t *>(payload + stationBytes + sensorBytes + offsetBytes);
+
+    for (quint32 i = 0; i < header.stringCount; ++i) {
+        if (offsets[i] > offsets[i + 1] || offsets[i + 1] > header.stringUnits) return false;
+    }
+    auto text = [&](quint32 index) {
+        if (index >= header.stringCount) return QStringView();
+        return QStringView(characters + offsets[index], qsizetype(offsets[index + 1] - offsets[index]));
+    };
+
+    StationCatalog result;
+    result.savedAtMs = header.savedAtMs;
+    result.stations.reserve(header.stationCount);
+    for (quint32 i = 0; i < header.stationCount; ++i) {
+        const StationRecord &record = stationRecords[i];
+        Station station;
+        station.id = record.id;
+        station.stationName = text(record.name).toString();
+        station.gegrLat = record.lat;
+        station.gegrLon = record.lon;
+        station.city.id = record.cityId;
+        station.city.name = StringPool::intern(text(record.cityName));
+        station.city.commune = StringPool::intern(text(record.commune));
+        station.city.district = StringPool::intern(text(record.district));
+        station.city.province = StringPool::intern(text(record.province));
+        station.city.address = text(record.address).toString();
+        result.stations.append(station);
+    }
+
+    for (quint32 i = 0; i < header.sensorCount; ++i) {
+        const SensorRecord &record = sensorRecords[i];
+        MeasurementStation sensor;
+        sensor.id = record.id;
+        sensor.stationId = record.stationId;
+        sensor.parameterName = StringPool::intern(text(record.parameterName));
+        sensor.parameterCode = StringPool::intern(text(record.parameterCode));
+        result.sensors[record.stationId].append(sensor);
+    }
+
+    catalog = std::move(result);
+    return true;
+}
+
+}
@@ -0,0 +1,61 @@
+/**
+ * @file catalogsnapshot.h
+ * @brief Definicja przestrzeni nazw CatalogSnapshot - binarnej kopii katalogu stacji i czujników
+ */
+#ifndef CATALOGSNAPSHOT_H
+#define CATALOGSNAPSHOT_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include "station.h"
+#include "measurement.h"
+
+/**
+ * @struct StationCatalog
+ * @brief Katalog stacji i znanych list czujników
+ */
+struct StationCatalog {
+    QList<Station> stations; // Stacje w kolejności z API
+    QHash<int, QList<MeasurementStation>> sensors; // Czujniki według ID stacji (tylko pobrane)
+    qint64 savedAtMs = 0; // Czas zapisu kopii (ms od epoki)
+};
+
+/**
+ * @namespace CatalogSnapshot
+ * @brief Zapis i odczyt katalogu stacji w zwartym, wersjonowanym pliku binarnym
+ *
+ * Plik składa się z 64-bajtowego nagłówka, tablicy rekordów stacji i czujników
+ * o stałym rozmiarze oraz tablicy napisów UTF-16 (każdy napis zapisany raz).
+ * Plik jest mapowany w pamięci (QFile::map), a napisy trafiają do StringPool
+ * prosto z mapowania, więc odczyt przy starcie trwa kilka milisekund i nie
+ * wymaga parsowania JSON. Kopia innej wersji lub z błędną sumą kontrolną
+ * jest ignorowana - katalog zostanie po prostu pobrany z sieci.
+ */
+namespace CatalogSnapshot {
+
+/**
+ * @brief Zwraca domyślną ścieżkę pliku kopii katalogu
+ * @return Ścieżka w katalogu pamięci podręcznej aplikacji
+ */
+QString defaultPath();
+
+/**
+ * @brief Zapisuje katalog do pliku (atomowo, przez QSaveFile)
+ * @param path Ścieżka pliku
+ * @param catalog Katalog
+ * @return true, jeśli plik został zapisany
+ */
+bool save(const QString &path, const StationCatalog &catalog);
+
+/**
+ * @brief Wczytuje katalog z pliku
+ * @param path Ścieżka pliku
+ * @param catalog Katalog, do którego trafia wynik (niezmieniony przy błędzie)
+ * @return true, jeśli plik istnieje i jest poprawny
+ */
+bool load(const QString &path, StationCatalog &catalog);
+
+}
+
+#endif // CATALOGSNAPSHOT_H
@@ -0,0 +1,20 @@
+#include "commandlinetool.h"
+#include "metricsexporter.h"
+
+#include <QCoreApplication>
+#include <QLoggingCategory>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    // Ta sama nazwa co aplikacja graficzna - wspólne katalogi danych i pamięci podręcznej
+    QCoreApplication::setApplicationName("pogoda");
+    QLoggingCategory::setFilterRules("default.debug=false");
+
+    MetricsExporter::fromEnvironment(&a);
+
+    CommandLineTool tool;
+    QObject::connect(&tool, &CommandLineTool::finished, &a, &QCoreApplication::exit, Qt::QueuedConnection);
+    tool.start(a.arguments());
+    return a.exec();
+}
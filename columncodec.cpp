@@ -0,0 +1,385 @@
+#include "columncodec.h"
+#include <QtEndian>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+constexpr quint32 BlockHasNulls = 0x1; // Blok zawiera mapę ważności
+constexpr quint32 BlockFixedPoint = 0x2; // Wartości zapisane jako liczby stałoprzecinkowe
+constexpr qsizetype BlockPrefixBytes = 8;
+
+// Dzielniki wartości stałoprzecinkowych według liczby cyfr po przecinku (dokładne w double)
+constexpr double DecimalScales[] = {1.0, 10.0, 100.0, 1000.0, 10000.0};
+constexpr int MaxDecimals = 4;
+
+// Szerokości pól dla prefiksów 10, 110 i 1110 (prefiks 1111 - 64 bity)
+using FieldWidths = std::array<int, 3>;
+constexpr FieldWidths TimestampWidths = {12, 24, 32}; // Różnica różnic czasu; przerwa kilku godzin w ms mieści się w 24 bitach
+constexpr FieldWidths FixedPointWidths = {6, 12, 24}; // Różnica kolejnych wartości stałoprzecinkowych
+
+quint64 doubleBits(double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsDouble(quint64 bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+quint64 zigZag(qint64 value)
+{
+    return (quint64(value) << 1) ^ quint64(value >> 63);
+}
+
+qint64 unZigZag(quint64 value)
+{
+    return qint64(value >> 1) ^ -qint64(value & 1);
+}
+
+/**
+ * @class BitWriter
+ * @brief Zapis strumienia bitów w słowach 64-bitowych (big-endian, od najstarszego bitu)
+ */
+class BitWriter
+{
+public:
+    explicit BitWriter(QByteArray &out) : out(out) {}
+
+    /// Zapisuje n (1..64) najmłodszych bitów wartości
+    void write(quint64 bits, int n)
+    {
+        if (n < 64) bits &= (quint64(1) << n) - 1;
+        const int free = 64 - used;
+        if (n < free) {
+            word = (word << n) | bits;
+            used += n;
+            return;
+        }
+        const int rest = n - free;
+        word = (free == 64 ? 0 : word << free) | (bits >> rest);
+        flush();
+        word = rest ? bits & ((quint64(1) << rest) - 1) : 0;
+        used = rest;
+    }
+
+    /// Dopełnia ostatnie słowo zerami
+    void finish()
+    {
+        if (used == 0) return;
+        word <<= 64 - used;
+        flush();
+        used = 0;
+    }
+
+private:
+    QByteArray &out; // Bufor wyjściowy
+    quint64 word = 0; // Bieżące słowo
+    int used = 0; // Liczba bitów w bieżącym słowie
+
+    void flush()
+    {
+        const quint64 bigEndian = qToBigEndian(word);
+        out.append(reinterpret_cast<const char *>(&bigEndian), sizeof(bigEndian));
+        word = 0;
+    }
+};
+
+/**
+ * @class BitReader
+ * @brief Odczyt strumienia zapisanego przez BitWriter
+ *
+ * Odczyt poza końcem zwraca zera i ustawia flagę overrun - pętla dekodowania
+ * nie sprawdza granic przy każdym bicie.
+ */
+class BitReader
+{
+public:
+    BitReader(const uchar *data, qsizetype words) : data(data), words(words) {}
+
+    /// Odczytuje n (1..64) bitów
+    quint64 read(int n)
+    {
+        if (n <= available) {
+            const quint64 bits = n == 64 ? current : current >> (64 - n);
+            current = n == 64 ? 0 : current << n;
+            available -= n;
+            return bits;
+        }
+        const int need = n - available;
+        const quint64 high = available ? current >> (64 - available) : 0;
+        const quint64 next = nextWord();
+        const quint64 bits = need == 64 ? next : (high << need) | (next >> (64 - need));
+        current = need == 64 ? 0 : next << need;
+        available = 64 - need;
+        return bits;
+    }
+
+    bool bit() { return read(1) != 0; }
+
+    bool overrun() const { return pastEnd; }
+
+private:
+    const uchar *data; // Początek strumienia
+    qsizetype words; // Liczba słów strumienia
+    qsizetype position = 0; // Indeks następnego słowa
+    quint64 current = 0; // Nieodczytane bity (wyrównane do najstarszego bitu)
+    int available = 0; // Liczba nieodczytanych bitów w current
+    bool pastEnd = false; // Czy odczytano więcej bitów niż zapisano
+
+    quint64 nextWord()
+    {
+        if (position >= words) {
+            pastEnd = true;
+            return 0;
+        }
+        return qFromBigEndian<quint64>(data + 8 * position++);
+    }
+};
+
+/**
+ * @brief Zapisuje liczbę ze znakiem w polu o szerokości wybranej prefiksem
+ *
+ * Prefiks 0 oznacza zero, 10, 110 i 1110 - kolejne szerokości z widths, 1111 - 64 bity.
+ */
+void writeVarying(BitWriter &writer, qint64 value, const FieldWidths &widths)
+{
+    if (value == 0) {
+        writer.write(0, 1);
+        return;
+    }
+    const quint64 encoded = zigZag(value);
+    for (int i = 0; i < 3; ++i) {
+        if (encoded < (quint64(1) << widths[i])) {
+            writer.write((quint64(1) << (i + 2)) - 2, i + 2); // i + 1 jedynek i zero
+            writer.write(encoded, widths[i]);
+            return;
+        }
+    }
+    writer.write(0b1111, 4);
+    writer.write(encoded, 64);
+}
+
+qint64 readVarying(BitReader &reader, const FieldWidths &widths)
+{
+    if (!reader.bit()) return 0;
+    for (int i = 0; i < 3; ++i) {
+        if (!reader.bit()) return unZigZag(reader.read(widths[i]));
+    }
+    return unZigZag(reader.read(64));
+}
+
+/**
+ * @brief Szuka najmniejszej liczby cyfr po przecinku, przy której wartości bloku są dokładne
+ *
+ * Pomiary GIOŚ mają zwykle kilka cyfr po przecinku - jako liczby całkowite
+ * zmieniają się o niewiele i kodują się lepiej niż XOR bitów double.
+ * @return Liczba cyfr albo -1, jeśli zapis stałoprzecinkowy nie jest bezstratny
+ */
+int fixedPointDecimals(const TimeSeries &series, qsizetype first, qsizetype last)
+{
+    for (int decimals = 0; decimals <= MaxDecimals; ++decimals) {
+        const double scale = DecimalScales[decimals];
+        bool exact = true;
+        for (qsizetype i = first; i < last && exact; ++i) {
+            if (!series.isValid(i)) continue;
+            const double scaled = series.valueAt(i) * scale;
+            exact = std::abs(scaled) < 4.5e15
+                    && doubleBits(double(std::llround(scaled)) / scale) == doubleBits(series.valueAt(i));
+        }
+        if (exact) return decimals;
+    }
+    return -1;
+}
+
+void writeXorValues(BitWriter &writer, const TimeSeries &series, qsizetype first, qsizetype last)
+{
+    quint64 previousBits = series.isValid(first) ? doubleBits(series.valueAt(first)) : 0;
+    writer.write(previousBits, 64);
+
+    int previousLeading = -1; // Okno bitów znaczących poprzedniego XOR (-1 - brak)
+    int previousTrailing = 0;
+    for (qsizetype i = first + 1; i < last; ++i) {
+        // Brakujący pomiar powtarza poprzednią wartość - kosztuje jeden bit
+        const quint64 bits = series.isValid(i) ? doubleBits(series.valueAt(i)) : previousBits;
+        const quint64 x = bits ^ previousBits;
+        previousBits = bits;
+        if (x == 0) {
+            writer.write(0, 1);
+            continue;
+        }
+
+        const int leading = qMin(int(qCountLeadingZeroBits(x)), 31);
+        const int trailing = int(qCountTrailingZeroBits(x));
+        if (previousLeading >= 0 && leading >= previousLeading && trailing >= previousTrailing) {
+            // Bity znaczące mieszczą się w oknie poprzedniego XOR
+            writer.write(0b10, 2);
+            writer.write(x >> previousTrailing, 64 - previousLeading - previousTrailing);
+        } else {
+            const int significant = 64 - leading - trailing;
+            writer.write(0b11, 2);
+            writer.write(quint64(leading), 5);
+            writer.write(quint64(significant - 1), 6);
+            writer.write(x >> trailing, significant);
+            previousLeading = leading;
+            previousTrailing = trailing;
+        }
+    }
+}
+
+bool readXorValues(BitReader &reader, qsizetype count, double *values)
+{
+    quint64 bits = reader.read(64);
+    values[0] = bitsDouble(bits);
+
+    int leading = 0;
+    int trailing = 0;
+    for (qsizetype i = 1; i < count; ++i) {
+        if (reader.bit()) {
+            if (reader.bit()) {
+                leading = int(reader.read(5));
+                const int significant = int(reader.read(6)) + 1;
+                trailing = 64 - leading - significant;
+                if (trailing < 0) return false;
+            }
+            bits ^= reader.read(64 - leading - trailing) << trailing;
+        }
+        values[i] = bitsDouble(bits);
+    }
+    return true;
+}
+
+void writeFixedPointValues(BitWriter &writer, const TimeSeries &series, qsizetype first, qsizetype last, int decimals)
+{
+    const double scale = DecimalScales[decimals];
+    qint64 previous = series.isValid(first) ? std::llround(series.valueAt(first) * scale) : 0;
+    writer.write(quint64(previous), 64);
+    for (qsizetype i = first + 1; i < last; ++i) {
+        const qint64 current = series.isValid(i) ? std::llround(series.valueAt(i) * scale) : previous;
+        writeVarying(writer, current - previous, FixedPointWidths);
+        previous = current;
+    }
+}
+
+void readFixedPointValues(BitReader &reader, qsizetype count, int decimals, double *values)
+{
+    const double scale = DecimalScales[decimals];
+    qint64 current = qint64(reader.read(64));
+    values[0] = double(current) / scale;
+    for (qsizetype i = 1; i < count; ++i) {
+        current += readVarying(reader, FixedPointWidths);
+        values[i] = double(current) / scale;
+    }
+}
+
+}
+
+namespace ColumnCodec {
+
+QByteArray encodeBlock(const TimeSeries &series, qsizetype first, qsizetype last)
+{
+    QByteArray out;
+    const qsizetype count = last - first;
+    if (count <= 0) return out;
+    Q_ASSERT(count <= BlockSamples);
+
+    bool hasNulls = false;
+    for (qsizetype i = first; i < last && !hasNulls; ++i) {
+        hasNulls = !series.isValid(i);
+    }
+
+    const int decimals = fixedPointDecimals(series, first, last);
+    const quint32 prefix[2] = {(hasNulls ? BlockHasNulls : 0u) | (decimals >= 0 ? BlockFixedPoint : 0u),
+                               quint32(qMax(decimals, 0))};
+    out.append(reinterpret_cast<const char *>(prefix), sizeof(prefix));
+    if (hasNulls) {
+        // Mapa ważności bloku indeksowana od jego pierwszej próbki
+        std::array<quint64, (BlockSamples + 63) / 64> validity{};
+        for (qsizetype i = 0; i < count; ++i) {
+            if (series.isValid(first + i)) validity[i >> 6] |= quint64(1) << (i & 63);
+        }
+        out.append(reinterpret_cast<const char *>(validity.data()), ((count + 63) / 64) * qsizetype(sizeof(quint64)));
+    }
+
+    // Znaczniki czasu i wartości w osobnych częściach strumienia - pętle dekodowania są krótsze
+    BitWriter writer(out);
+    qint64 previousTimestamp = series.timestampAt(first);
+    writer.write(quint64(previousTimestamp), 64);
+    qint64 previousDelta = 0;
+    for (qsizetype i = first + 1; i < last; ++i) {
+        const qint64 timestamp = series.timestampAt(i);
+        const qint64 delta = timestamp - previousTimestamp;
+        writeVarying(writer, delta - previousDelta, TimestampWidths);
+        previousDelta = delta;
+        previousTimestamp = timestamp;
+    }
+
+    if (decimals >= 0) {
+        writeFixedPointValues(writer, series, first, last, decimals);
+    } else {
+        writeXorValues(writer, series, first, last);
+    }
+    writer.finish();
+    return out;
+}
+
+bool decodeBlock(const uchar *data, qsizetype size, qsizetype count, TimeSeries &out)
+{
+    if (count <= 0 || count > BlockSamples || size < BlockPrefixBytes || size % 8 != 0) return false;
+
+    quint32 flags, decimals;
+    std::memcpy(&flags, data, sizeof(flags));
+    std::memcpy(&decimals, data + sizeof(flags), sizeof(decimals));
+    qsizetype offset = BlockPrefixBytes;
+
+    const qsizetype validityWords = (count + 63) / 64;
+    std::array<quint64, (BlockSamples + 63) / 64> validity;
+    if (flags & BlockHasNulls) {
+        const qsizetype bytes = validityWords * qsizetype(sizeof(quint64));
+        if (size < offset + bytes) return false;
+        std::memcpy(validity.data(), data + offset, bytes);
+        offset += bytes;
+    } else {
+        validity.fill(~quint64(0));
+    }
+
+    std::array<qint64, BlockSamples> timestamps;
+    std::array<double, BlockSamples> values;
+    BitReader reader(data + offset, (size - offset) / 8);
+
+    qint64 timestamp = qint64(reader.read(64));
+    timestamps[0] = timestamp;
+    qint64 delta = 0;
+    for (qsizetype i = 1; i < count; ++i) {
+        delta += readVarying(reader, TimestampWidths);
+        timestamp += delta;
+        timestamps[i] = timestamp;
+    }
+
+    if (flags & BlockFixedPoint) {
+        if (decimals > quint32(MaxDecimals)) return false;
+        readFixedPointValues(reader, count, int(decimals), values.data());
+    } else if (!readXorValues(reader, count, values.data())) {
+        return false;
+    }
+    if (reader.overrun()) return false;
+
+    // Brakujące pomiary mają w kolumnie wartości NaN, jak w TimeSeries::appendNull
+    if (flags & BlockHasNulls) {
+        for (qsizetype i = 0; i < count; ++i) {
+            if (!((validity[i >> 6] >> (i & 63)) & 1)) values[i] = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    out.appendRange(timestamps.data(), values.data(), validity.data(), 0, count);
+    return true;
+}
+
+}
@@ -0,0 +1,56 @@
+/**
+ * @file columncodec.h
+ * @brief Definicja przestrzeni nazw ColumnCodec - kompresji kolumn szeregu czasowego
+ */
+#ifndef COLUMNCODEC_H
+#define COLUMNCODEC_H
+
+#include <QByteArray>
+#include <QtGlobal>
+#include "timeseries.h"
+
+/**
+ * @namespace ColumnCodec
+ * @brief Bezstratne kodowanie bloków próbek w stylu Gorilla
+ *
+ * Znaczniki czasu są zapisywane jako różnica różnic (delta-of-delta) - dla
+ * regularnych serii godzinowych to jeden bit na próbkę. Jeśli wszystkie wartości
+ * bloku mają najwyżej 4 cyfry po przecinku, blok zapisuje je jako liczby
+ * stałoprzecinkowe (różnice kolejnych liczb całkowitych), co dla pomiarów
+ * GIOŚ zajmuje zwykle kilka-kilkanaście bitów. Pozostałe bloki zapisują XOR
+ * z poprzednią wartością, z którego zostają tylko bity znaczące. Obie metody
+ * są bezstratne. Brakujące pomiary powtarzają poprzednią wartość (jeden bit),
+ * a ich pozycje zapisuje mapa bitowa ważności dołączana tylko do bloków,
+ * które je zawierają.
+ *
+ * Blok zaczyna się 8-bajtowym nagłówkiem (flagi i liczba cyfr po przecinku),
+ * po którym występuje opcjonalna mapa ważności i strumień bitów w słowach
+ * 64-bitowych: najpierw znaczniki czasu, potem wartości.
+ */
+namespace ColumnCodec {
+
+    /// Największa liczba próbek w bloku
+    constexpr qsizetype BlockSamples = 1024;
+
+    /**
+     * @brief Koduje próbki [first, last) szeregu
+     * @param series Szereg posortowany rosnąco według czasu
+     * @param first Indeks pierwszej próbki
+     * @param last Indeks za ostatnią próbką (last - first <= BlockSamples)
+     * @return Zakodowany blok (rozmiar jest wielokrotnością 8 bajtów)
+     */
+    QByteArray encodeBlock(const TimeSeries &series, qsizetype first, qsizetype last);
+
+    /**
+     * @brief Dekoduje blok i dopisuje jego próbki do szeregu
+     * @param data Początek bloku
+     * @param size Rozmiar bloku w bajtach
+     * @param count Liczba próbek w bloku
+     * @param out Szereg, do którego dopisywane są próbki
+     * @return false, jeśli blok jest uszkodzony (szereg pozostaje niezmieniony)
+     */
+    bool decodeBlock(const uchar *data, qsizetype size, qsizetype count, TimeSeries &out);
+
+}
+
+#endif // COLUMNCODEC_H
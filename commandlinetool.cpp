@@ -0,0 +1,556 @@
+#include "commandlinetool.h"
+#include "stationcrawler.h"
+#include "analysis.h"
+#include "metrics.h"
+#include "catalogsnapshot.h"
+#include "queryengine.h"
+#include <QFile>
+#include <QTextStream>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <limits>
+
+namespace {
+
+constexpr int ExitSuccess = 0;
+constexpr int ExitFailure = 1;
+constexpr int ExitUsage = 2;
+constexpr int Running = -1; // Polecenie asynchroniczne zgłosi wynik sygnałem finished
+
+const QString TimestampFormat = QStringLiteral("yyyy-MM-dd HH:mm:ss");
+
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+void printStation(const Station &station, const char *prefix = "")
+{
+    out() << prefix << station.id << '\t' << station.stationName << '\t'
+          << StringPool::resolve(station.city.name) << '\t'
+          << StringPool::resolve(station.city.province) << '\n';
+}
+
+/// Wypisuje stacje dodane (+), usunięte (-) i zmienione (~) i zwraca ich liczbę
+int printStationChanges(const QList<Station> &before, const QList<Station> &after)
+{
+    QHash<int, const Station *> previous;
+    for (const Station &station : before) previous.insert(station.id, &station);
+
+    int changes = 0;
+    for (const Station &station : after) {
+        const Station *old = previous.take(station.id);
+        if (!old) {
+            printStation(station, "+ ");
+            ++changes;
+        } else if (*old != station) {
+            printStation(station, "~ ");
+            ++changes;
+        }
+    }
+    for (const Station &station : before) {
+        if (previous.contains(station.id)) {
+            printStation(station, "- ");
+            ++changes;
+        }
+    }
+    return changes;
+}
+
+}
+
+CommandLineTool::CommandLineTool(QObject *parent)
+    : QObject(parent)
+{
+    parser.setApplicationDescription(
+        tr("Pogoda - pobieranie i analiza danych jakości powietrza GIOŚ bez interfejsu graficznego."));
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", tr("Polecenie: fetch-all, fetch-sensor, export, stats, summary, rollup, query, stations."));
+    parser.addOptions({
+        {"data-dir", tr("Katalog danych (domyślnie katalog aplikacji)."), "dir"},
+        {"api-url", tr("Bazowy URL API (domyślnie POGODA_API_URL lub serwer GIOŚ)."), "url"},
+        {"station", tr("ID stacji."), "id"},
+        {"sensor", tr("ID czujnika."), "id"},
+        {"from", tr("Początek przedziału (ISO 8601)."), "date"},
+        {"to", tr("Koniec przedziału (ISO 8601)."), "date"},
+        {"format", tr("Format eksportu: csv lub json."), "format", "csv"},
+        {"output", tr("Plik wyjściowy eksportu (domyślnie standardowe wyjście)."), "file"},
+        {"concurrency", tr("Maksymalna liczba równoczesnych żądań (fetch-all)."), "n"},
+        {"rate", tr("Maksymalna liczba żądań na sekundę (fetch-all)."), "n"},
+        {"above", tr("Próg, powyżej którego liczone są pomiary (summary)."), "value"},
+        {"tier", tr("Poziom agregacji: hourly, daily lub monthly (rollup, query)."), "tier", "daily"},
+        {"parameter", tr("Kod parametru, np. PM2.5 (query)."), "code"},
+        {"group", tr("Grupowanie: country, province, district lub station (query)."), "group", "province"},
+        {"top", tr("Wypisuje tylko n grup o najwyższej średniej (query)."), "n"},
+        {"series", tr("Wypisuje średnie grup w kolejnych przedziałach poziomu --tier (query).")},
+        {"refresh", tr("Odświeża katalog stacji z sieci i wypisuje zmiany (stations).")},
+        {"metrics", tr("Zapisuje metryki po zakończeniu (.json - JSON, inaczej Prometheus)."), "file"},
+    });
+}
+
+void CommandLineTool::start(const QStringList &arguments)
+{
+    if (!parser.parse(arguments)) {
+        printUsageError(parser.errorText());
+        emit finished(ExitUsage);
+        return;
+    }
+    if (parser.isSet("help") || parser.positionalArguments().size() != 1) {
+        out() << parser.helpText();
+        out().flush();
+        emit finished(parser.isSet("help") ? ExitSuccess : ExitUsage);
+        return;
+    }
+
+    if (parser.isSet("metrics")) {
+        Metrics::setEnabled(true);
+        const QString path = parser.value("metrics");
+        connect(this, &CommandLineTool::finished, this, [path]() {
+            if (!Metrics::instance().writeToFile(path)) {
+                err() << tr("Nie można zapisać metryk do %1").arg(path) << Qt::endl;
+            }
+        });
+    }
+
+    dataManager = parser.isSet("data-dir") ? new DataManager(parser.value("data-dir"), this)
+                                           : new DataManager(this);
+
+    const QString command = parser.positionalArguments().first();
+    int exitCode = ExitUsage;
+    if (command == "fetch-all") {
+        exitCode = runFetchAll();
+    } else if (command == "fetch-sensor") {
+        exitCode = runFetchSensor();
+    } else if (command == "export") {
+        exitCode = runExport();
+    } else if (command == "stats") {
+        exitCode = runStats();
+    } else if (command == "summary") {
+        exitCode = runSummary();
+    } else if (command == "rollup") {
+        exitCode = runRollup();
+    } else if (command == "query") {
+        exitCode = runQuery();
+    } else if (command == "stations") {
+        exitCode = runStations();
+    } else {
+        printUsageError(tr("Nieznane polecenie: %1").arg(command));
+    }
+
+    if (exitCode != Running) {
+        emit finished(exitCode);
+    }
+}
+
+void CommandLineTool::createApiClient()
+{
+    apiClient = new ApiClient(this);
+    if (parser.isSet("api-url")) {
+        apiClient->setBaseUrl(parser.value("api-url"));
+    }
+    connect(apiClient, &ApiClient::errorOccurred, this, [this](const QString &message) {
+        ++errorCount;
+        err() << message << Qt::endl;
+    });
+}
+
+int CommandLineTool::runFetchAll()
+{
+    StationCrawler::Options options;
+    if (parser.isSet("concurrency")) {
+        if (!intOption("concurrency", options.maxConcurrent)) return ExitUsage;
+        if (options.maxConcurrent < 1) {
+            printUsageError(tr("Niepoprawna wartość opcji --concurrency"));
+            return ExitUsage;
+        }
+    }
+    if (parser.isSet("rate")) {
+        bool ok = false;
+        options.requestsPerSecond = parser.value("rate").toDouble(&ok);
+        if (!ok || options.requestsPerSecond <= 0) {
+            printUsageError(tr("Niepoprawna wartość opcji --rate"));
+            return ExitUsage;
+        }
+    }
+
+    createApiClient();
+    crawler = new StationCrawler(apiClient, this);
+    crawler->setOptions(options);
+    crawler->setDataManager(dataManager);
+
+    connect(crawler, &StationCrawler::progress, this, [](int completed, int known) {
+        if (completed % 50 == 0 || completed == known) {
+            err() << tr("Postęp: %1/%2 żądań").arg(completed).arg(known) << Qt::endl;
+        }
+    });
+    connect(crawler, &StationCrawler::finished, this,
+            [this](int stationCount, int sensorCount, qint64 elapsedMs, qsizetype inserted, qsizetype updated) {
+        out() << tr("Pobrano %1 serii z %2 stacji w %3 s; nowe: %4, zmienione: %5")
+                     .arg(sensorCount).arg(stationCount).arg(elapsedMs / 1000.0, 0, 'f', 1)
+                     .arg(inserted).arg(updated)
+              << Qt::endl;
+        if (errorCount > 0) {
+            err() << tr("Liczba błędów: %1").arg(errorCount) << Qt::endl;
+        }
+        emit finished(errorCount > 0 ? ExitFailure : ExitSuccess);
+    });
+
+    apiClient->fetchAllStations().then(this, [this](const QList<Station> &stations) {
+        if (stations.isEmpty()) {
+            err() << tr("Nie udało się pobrać listy stacji") << Qt::endl;
+            emit finished(ExitFailure);
+            return;
+        }
+        err() << tr("Pobrano %1 stacji").arg(stations.size()) << Qt::endl;
+        crawler->start(stations);
+    });
+    return Running;
+}
+
+int CommandLineTool::runFetchSensor()
+{
+    int stationId = 0, sensorId = 0;
+    if (!intOption("station", stationId) || !intOption("sensor", sensorId)) return ExitUsage;
+
+    createApiClient();
+    apiClient->fetchSensorData(sensorId).then(this, [this, stationId, sensorId](const MeasurementData &data) {
+        if (data.values.isEmpty()) {
+            err() << tr("Brak danych dla czujnika %1").arg(sensorId) << Qt::endl;
+            emit finished(ExitFailure);
+            return;
+        }
+
+        const MergeStats stats = dataManager->saveMeasurementData(stationId, sensorId, data);
+        out() << tr("Pobrano %1 pomiarów %2; nowe: %3, zmienione: %4, bez zmian: %5")
+                     .arg(data.values.size()).arg(data.parameterCode)
+                     .arg(stats.inserted).arg(stats.updated).arg(stats.unchanged)
+              << Qt::endl;
+        emit finished(ExitSuccess);
+    });
+    return Running;
+}
+
+int CommandLineTool::runExport()
+{
+    MeasurementData data;
+    if (!loadSelected(data)) return ExitUsage;
+
+    const QString format = parser.value("format").toLower();
+    if (format != "csv" && format != "json") {
+        err() << tr("Nieznany format eksportu: %1").arg(format) << Qt::endl;
+        return ExitUsage;
+    }
+
+    QFile file;
+    if (parser.isSet("output")) {
+        file.setFileName(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            err() << tr("Nie można otworzyć pliku %1: %2").arg(file.fileName(), file.errorString()) << Qt::endl;
+            return ExitFailure;
+        }
+    } else if (!file.open(stdout, QIODevice::WriteOnly)) {
+        return ExitFailure;
+    }
+
+    const TimeSeries &series = data.values;
+    if (format == "csv") {
+        QTextStream stream(&file);
+        stream << "date,value\n";
+        for (qsizetype i = 0; i < series.size(); ++i) {
+            stream << series.dateTimeAt(i).toString(TimestampFormat) << ',';
+            if (series.isValid(i)) stream << series.valueAt(i);
+            stream << '\n';
+        }
+    } else {
+        // Układ odpowiedzi getData, aby eksport dało się wczytać tym samym parserem
+        QJsonArray values;
+        for (qsizetype i = 0; i < series.size(); ++i) {
+            QJsonObject sample;
+            sample["date"] = series.dateTimeAt(i).toString(TimestampFormat);
+            sample["value"] = series.isValid(i) ? QJsonValue(series.valueAt(i)) : QJsonValue();
+            values.append(sample);
+        }
+        QJsonObject root;
+        root["key"] = data.parameterCode;
+        root["values"] = values;
+        file.write(QJsonDocument(root).toJson());
+    }
+    return ExitSuccess;
+}
+
+int CommandLineTool::runStats()
+{
+    MeasurementData data;
+    if (!loadSelected(data)) return ExitUsage;
+    if (data.values.isEmpty()) {
+        err() << tr("Brak zapisanych danych w podanym przedziale") << Qt::endl;
+        return ExitFailure;
+    }
+
+    const TimeSeries &series = data.values;
+    const Analysis::Summary summary = Analysis::summarize(series);
+    Analysis::QuantileSketch sketch;
+    sketch.add(series);
+
+    out() << tr("Parametr: %1 (%2)").arg(data.parameterName, data.parameterCode) << '\n'
+          << tr("Zakres: %1 - %2").arg(series.dateTimeAt(0).toString(TimestampFormat),
+                                       series.dateTimeAt(series.size() - 1).toString(TimestampFormat)) << '\n'
+          << tr("Pomiary: %1 (brak: %2)").arg(summary.count).arg(summary.nullCount) << '\n';
+    if (summary.count > 0) {
+        out() << tr("Minimum: %1 (%2)").arg(summary.min).arg(series.dateTimeAt(summary.minIndex).toString(TimestampFormat)) << '\n'
+              << tr("Maksimum: %1 (%2)").arg(summary.max).arg(series.dateTimeAt(summary.maxIndex).toString(TimestampFormat)) << '\n'
+              << tr("Średnia: %1").arg(summary.mean, 0, 'f', 2) << '\n'
+              << tr("Odchylenie standardowe: %1").arg(summary.stdDev, 0, 'f', 2) << '\n'
+              << tr("P50 / P95 / P98: %1 / %2 / %3")
+                     .arg(sketch.quantile(0.50), 0, 'f', 2)
+                     .arg(sketch.quantile(0.95), 0, 'f', 2)
+                     .arg(sketch.quantile(0.98), 0, 'f', 2) << '\n';
+    }
+    for (const Analysis::Norm &norm : Analysis::normsFor(data.parameterCode)) {
+        out() << norm.description << ": " << Analysis::countExceedances(series, norm) << '\n';
+    }
+    out().flush();
+    return ExitSuccess;
+}
+
+int CommandLineTool::runSummary()
+{
+    int stationId = 0, sensorId = 0;
+    QDateTime from, to;
+    if (!selection(stationId, sensorId, from, to)) return ExitUsage;
+
+    double threshold = std::numeric_limits<double>::infinity();
+    if (parser.isSet("above")) {
+        bool ok = false;
+        threshold = parser.value("above").toDouble(&ok);
+        if (!ok) {
+            printUsageError(tr("Niepoprawna wartość opcji --above"));
+            return ExitUsage;
+        }
+    }
+
+    const RangeStats stats = dataManager->stats(stationId, sensorId, from, to, threshold);
+    if (stats.count == 0) {
+        err() << tr("Brak zapisanych danych w podanym przedziale") << Qt::endl;
+        return ExitFailure;
+    }
+
+    out() << tr("Pomiary: %1 (brak: %2)").arg(stats.validCount).arg(stats.count - stats.validCount) << '\n';
+    if (stats.validCount > 0) {
+        out() << tr("Minimum: %1").arg(stats.min) << '\n'
+              << tr("Maksimum: %1").arg(stats.max) << '\n'
+              << tr("Średnia: %1").arg(stats.mean(), 0, 'f', 2) << '\n';
+    }
+    if (parser.isSet("above")) {
+        out() << tr("Powyżej %1: %2").arg(threshold).arg(stats.aboveThreshold) << '\n';
+    }
+    out().flush();
+    err() << tr("Bloki z map stref: %1, zdekodowane: %2").arg(stats.blocksFromZoneMaps).arg(stats.blocksDecoded)
+          << Qt::endl;
+    return ExitSuccess;
+}
+
+int CommandLineTool::runRollup()
+{
+    int stationId = 0, sensorId = 0;
+    QDateTime from, to;
+    if (!selection(stationId, sensorId, from, to)) return ExitUsage;
+
+    RollupTier tier = RollupTier::Daily;
+    if (!tierOption(tier)) return ExitUsage;
+
+    const QList<RollupBucket> buckets = dataManager->rollups(stationId, sensorId, tier, from, to);
+    if (buckets.isEmpty()) {
+        err() << tr("Brak zapisanych danych w podanym przedziale") << Qt::endl;
+        return ExitFailure;
+    }
+
+    out() << "start,count,mean,min,max,stddev\n";
+    for (const RollupBucket &bucket : buckets) {
+        out() << QDateTime::fromMSecsSinceEpoch(bucket.startMs).toString(TimestampFormat) << ','
+              << bucket.count << ',' << bucket.mean() << ',' << bucket.min << ',' << bucket.max << ','
+              << bucket.stdDev() << '\n';
+    }
+    out().flush();
+    return ExitSuccess;
+}
+
+int CommandLineTool::runQuery()
+{
+    QueryEngine::Query query;
+    if (!parser.isSet("parameter")) {
+        printUsageError(tr("Brak wymaganej opcji --parameter"));
+        return ExitUsage;
+    }
+    if (!tierOption(query.resolution)) return ExitUsage;
+    const QDateTime now = QDateTime::currentDateTime();
+    if (!dateOption("from", now.addDays(-7), query.from) || !dateOption("to", now, query.to)) return ExitUsage;
+
+    const QString group = parser.value("group").toLower();
+    if (group == "country") {
+        query.groupBy = QueryEngine::GroupBy::Country;
+    } else if (group == "district") {
+        query.groupBy = QueryEngine::GroupBy::District;
+    } else if (group == "station") {
+        query.groupBy = QueryEngine::GroupBy::Station;
+    } else if (group != "province") {
+        printUsageError(tr("Nieznane grupowanie: %1").arg(group));
+        return ExitUsage;
+    }
+    if (parser.isSet("top")) {
+        if (!intOption("top", query.limit)) return ExitUsage;
+        if (query.limit < 1) {
+            printUsageError(tr("Niepoprawna wartość opcji --top"));
+            return ExitUsage;
+        }
+    }
+    query.series = parser.isSet("series");
+
+    // Położenie stacji (województwo, powiat) i ich czujniki pochodzą z zapisanego katalogu
+    StationCatalog catalog;
+    if (!CatalogSnapshot::load(CatalogSnapshot::defaultPath(), catalog) || catalog.stations.isEmpty()) {
+        err() << tr("Brak zapisanego katalogu stacji - uruchom najpierw: pogoda_cli stations --refresh") << Qt::endl;
+        return ExitFailure;
+    }
+    query.sources = QueryEngine::sources(catalog, parser.value("parameter"));
+    if (query.sources.isEmpty()) {
+        err() << tr("Żaden czujnik w katalogu nie mierzy %1").arg(parser.value("parameter")) << Qt::endl;
+        return ExitFailure;
+    }
+
+    auto *engine = new QueryEngine(dataManager, this);
+    engine->run(query).then(this, [this, query](const QueryEngine::Result &result) {
+        if (result.groups.isEmpty()) {
+            err() << tr("Brak zapisanych danych w podanym przedziale") << Qt::endl;
+            emit finished(ExitFailure);
+            return;
+        }
+
+        if (query.series) {
+            out() << "group,start,count,mean,min,max\n";
+            for (const QueryEngine::Group &group : result.groups) {
+                for (const RollupBucket &bucket : group.series) {
+                    out() << '"' << group.label << "\"," << QDateTime::fromMSecsSinceEpoch(bucket.startMs).toString(TimestampFormat)
+                          << ',' << bucket.count << ',' << bucket.mean() << ',' << bucket.min << ',' << bucket.max << '\n';
+                }
+            }
+        } else {
+            out() << "group,stations,count,mean,min,max\n";
+            for (const QueryEngine::Group &group : result.groups) {
+                out() << '"' << group.label << "\"," << group.stations << ',' << group.total.count << ','
+                      << group.total.mean() << ',' << group.total.min << ',' << group.total.max << '\n';
+            }
+        }
+        out().flush();
+        err() << tr("Czujniki z danymi: %1 z %2").arg(result.sensors).arg(query.sources.size()) << Qt::endl;
+        emit finished(ExitSuccess);
+    });
+    return Running;
+}
+
+int CommandLineTool::runStations()
+{
+    const QString path = CatalogSnapshot::defaultPath();
+    StationCatalog catalog;
+    const bool warm = CatalogSnapshot::load(path, catalog) && !catalog.stations.isEmpty();
+    if (warm) {
+        for (const Station &station : catalog.stations) printStation(station);
+        out().flush();
+        if (!parser.isSet("refresh")) return ExitSuccess;
+    }
+
+    createApiClient();
+    apiClient->fetchAllStations().then(this, [this, catalog, warm, path](const QList<Station> &stations) mutable {
+        if (stations.isEmpty()) {
+            err() << tr("Nie udało się pobrać listy stacji") << Qt::endl;
+            emit finished(ExitFailure);
+            return;
+        }
+
+        if (warm) {
+            const int changes = printStationChanges(catalog.stations, stations);
+            err() << tr("Zmienione stacje: %1").arg(changes) << Qt::endl;
+        } else {
+            for (const Station &station : stations) printStation(station);
+        }
+        out().flush();
+
+        catalog.stations = stations;
+        catalog.savedAtMs = QDateTime::currentMSecsSinceEpoch();
+        if (!CatalogSnapshot::save(path, catalog)) {
+            err() << tr("Nie można zapisać katalogu do %1").arg(path) << Qt::endl;
+        }
+        emit finished(ExitSuccess);
+    });
+    return Running;
+}
+
+bool CommandLineTool::loadSelected(MeasurementData &data)
+{
+    int stationId = 0, sensorId = 0;
+    QDateTime from, to;
+    if (!selection(stationId, sensorId, from, to)) return false;
+
+    data = dataManager->load(stationId, sensorId, from, to);
+    return true;
+}
+
+bool CommandLineTool::selection(int &stationId, int &sensorId, QDateTime &from, QDateTime &to)
+{
+    if (!intOption("station", stationId) || !intOption("sensor", sensorId)) return false;
+    if (!dateOption("from", QDateTime::fromMSecsSinceEpoch(0), from)) return false;
+    return dateOption("to", QDateTime::currentDateTime().addDays(1), to);
+}
+
+bool CommandLineTool::tierOption(RollupTier &tier)
+{
+    const QString name = parser.value("tier").toLower();
+    if (name == "hourly") {
+        tier = RollupTier::Hourly;
+    } else if (name == "daily") {
+        tier = RollupTier::Daily;
+    } else if (name == "monthly") {
+        tier = RollupTier::Monthly;
+    } else {
+        printUsageError(tr("Nieznany poziom agregacji: %1").arg(name));
+        return false;
+    }
+    return true;
+}
+
+bool CommandLineTool::intOption(const QString &name, int &value)
+{
+    bool ok = false;
+    value = parser.value(name).toInt(&ok);
+    if (!ok) {
+        printUsageError(parser.isSet(name) ? tr("Niepoprawna wartość opcji --%1").arg(name)
+                                      : tr("Brak wymaganej opcji --%1").arg(name));
+    }
+    return ok;
+}
+
+bool CommandLineTool::dateOption(const QString &name, const QDateTime &fallback, QDateTime &value)
+{
+    if (!parser.isSet(name)) {
+        value = fallback;
+        return true;
+    }
+    value = QDateTime::fromString(parser.value(name), Qt::ISODate);
+    if (!value.isValid()) {
+        printUsageError(tr("Niepoprawna data w opcji --%1").arg(name));
+    }
+    return value.isValid();
+}
+
+void CommandLineTool::printUsageError(const QString &message)
+{
+    err() << message << '\n' << tr("Użyj --help, aby wyświetlić dostępne polecenia.") << Qt::endl;
+}
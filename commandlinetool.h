@@ -0,0 +1,104 @@
+/**
+ * @file commandlinetool.h
+ * @brief Definicja klasy CommandLineTool - trybu konsolowego bez interfejsu graficznego
+ */
+#ifndef COMMANDLINETOOL_H
+#define COMMANDLINETOOL_H
+
+#include <QObject>
+#include <QStringList>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include "apiclient.h"
+#include "datamanager.h"
+
+class StationCrawler;
+
+/**
+ * @class CommandLineTool
+ * @brief Obsługa poleceń programu pogoda_cli
+ *
+ * Polecenia:
+ * - fetch-all - pobiera i zapisuje dane wszystkich czujników wszystkich stacji,
+ * - fetch-sensor - pobiera i zapisuje dane jednego czujnika,
+ * - export - eksportuje zapisane dane do CSV lub JSON,
+ * - stats - wypisuje statystyki zapisanych danych,
+ * - summary - wypisuje liczbę pomiarów, minimum, maksimum i średnią z map stref
+ *   magazynu bez wczytywania próbek (z --above także liczbę pomiarów powyżej progu),
+ * - rollup - wypisuje agregaty godzinowe, dobowe lub miesięczne (--tier),
+ * - query - agreguje równolegle dane wszystkich czujników parametru z katalogu
+ *   według województw, powiatów lub stacji (z --top tylko najgorsze grupy),
+ * - stations - wypisuje katalog stacji z zapisanej kopii bez czekania na sieć
+ *   (z --refresh odświeża go i wypisuje zmiany).
+ *
+ * Korzysta wyłącznie z biblioteki pogoda_core, więc działa na QCoreApplication
+ * bez QtWidgets i QtCharts.
+ */
+class CommandLineTool : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Konstruktor klasy CommandLineTool
+     * @param parent Wskaźnik na obiekt rodzica
+     */
+    explicit CommandLineTool(QObject *parent = nullptr);
+
+    /**
+     * @brief Interpretuje argumenty i uruchamia polecenie
+     *
+     * Wynik jest zgłaszany sygnałem finished, również dla poleceń synchronicznych.
+     * @param arguments Argumenty programu (QCoreApplication::arguments())
+     */
+    void start(const QStringList &arguments);
+
+signals:
+
+    /**
+     * @brief Sygnał emitowany po zakończeniu polecenia
+     * @param exitCode Kod wyjścia (0 - sukces, 1 - błąd, 2 - błędne argumenty)
+     */
+    void finished(int exitCode);
+
+private:
+    QCommandLineParser parser; // Parser argumentów
+    ApiClient *apiClient = nullptr; // Klient API (tworzony tylko dla poleceń sieciowych)
+    DataManager *dataManager = nullptr; // Menadżer danych
+    StationCrawler *crawler = nullptr; // Pobieranie całej sieci stacji
+    int errorCount = 0; // Liczba błędów zgłoszonych przez ApiClient
+
+    // Polecenia zwracają kod wyjścia albo -1, jeśli wynik zgłosi później sygnał finished
+    int runFetchAll();
+    int runFetchSensor();
+    int runExport();
+    int runStats();
+    int runSummary();
+    int runRollup();
+    int runQuery();
+    int runStations();
+
+    /// Tworzy klienta API i przekierowuje jego błędy na stderr
+    void createApiClient();
+
+    /// Wczytuje dane czujnika wskazanego opcjami --station, --sensor, --from, --to
+    bool loadSelected(MeasurementData &data);
+
+    /// Odczytuje opcje --station, --sensor, --from, --to
+    bool selection(int &stationId, int &sensorId, QDateTime &from, QDateTime &to);
+
+    /// Odczytuje opcję --tier
+    bool tierOption(RollupTier &tier);
+
+    /// Odczytuje wymaganą opcję całkowitoliczbową
+    bool intOption(const QString &name, int &value);
+
+    /// Odczytuje opcjonalną datę (ISO 8601) lub zwraca wartość domyślną
+    bool dateOption(const QString &name, const QDateTime &fallback, QDateTime &value);
+
+    /// Wypisuje błąd w argumentach na stderr
+    void printUsageError(const QString &message);
+};
+
+#endif // COMMANDLINETOOL_H
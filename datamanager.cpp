@@ -1,47 +1,250 @@
 #include "datamanager.h"
+#include "metrics.h"
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QDir>
 #include <QStandardPaths>
 #include <qjsonarray.h>
+#include <QDebug>
 
-DataManager::DataManager(QObject *parent) : QObject(parent)
+DataManager::DataManager(QObject *parent)
+    : DataManager(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/pogoda_data", parent)
 {
 }
 
-void DataManager::saveMeasurementData(int stationId, int sensorId, const MeasurementData &data)
+DataManager::DataManager(const QString &dataDirectory, QObject *parent)
+    : QObject(parent),
+    dataDirectory(dataDirectory),
+    store(new SegmentStore(dataDirectory, this)),
+    rollupStore(new RollupStore(store, this))
 {
-    QString filePath = getFilePath(stationId, sensorId);
-    QFile file(filePath);
+}
 
-    if (!file.open(QIODevice::WriteOnly)) {
-        qWarning() << "Could not open file for writing:" << filePath;
-        return;
+MergeStats DataManager::saveMeasurementData(int stationId, int sensorId, const MeasurementData &data)
+{
+    static Metrics::Histogram &duration =
+        Metrics::instance().histogram("pogoda_datamanager_seconds", "function=\"saveMeasurementData\"");
+    Metrics::ScopedTimer timer(duration);
+
+    MergeStats stats;
+    if (data.values.isEmpty()) return stats;
+
+    importLegacyFile(stationId, sensorId);
+    if (!mergeIntoStore(stationId, sensorId, data, true, stats)) {
+        qWarning() << "Could not save measurement data for sensor" << sensorId;
+        return MergeStats();
+    }
+    return stats;
+}
+
+bool DataManager::mergeIntoStore(int stationId, int sensorId, const MeasurementData &data, bool replace,
+                                 MergeStats &stats)
+{
+    if (data.values.isEmpty()) return true;
+    saveMetadata(stationId, sensorId, data);
+
+    // Zapisane próbki z przedziału nowych danych - zwykle nakładka 2-3 dni
+    const TimeSeries &incoming = data.values;
+    const TimeSeries stored = store->load(stationId, sensorId, incoming.timestampAt(0),
+                                          incoming.timestampAt(incoming.size() - 1));
+
+    TimeSeries delta;
+    qsizetype j = 0;
+    for (qsizetype i = 0; i < incoming.size(); ++i) {
+        const qint64 ts = incoming.timestampAt(i);
+        // Powtórzony czas (np. godzina cofnięcia zegara) - jak w SeriesJoin::join wygrywa ostatnia próbka
+        if (i + 1 < incoming.size() && incoming.timestampAt(i + 1) == ts) continue;
+        while (j < stored.size() && stored.timestampAt(j) < ts) ++j;
+
+        if (j < stored.size() && stored.timestampAt(j) == ts) {
+            const bool same = incoming.isValid(i) == stored.isValid(j)
+                              && (!incoming.isValid(i) || incoming.valueAt(i) == stored.valueAt(j));
+            if (same || !replace) {
+                ++stats.unchanged;
+                continue;
+            }
+            ++stats.updated;
+        } else {
+            ++stats.inserted;
+        }
+
+        if (incoming.isValid(i)) {
+            delta.append(ts, incoming.valueAt(i));
+        } else {
+            delta.appendNull(ts);
+        }
+    }
+
+    if (!delta.isEmpty() && !store->append(stationId, sensorId, delta)) return false;
+    rollupStore->update(stationId, sensorId, delta);
+    if (Metrics::enabled()) {
+        static Metrics::Counter &written = Metrics::instance().counter("pogoda_datamanager_samples_written_total");
+        written.add(quint64(delta.size()));
     }
+    return true;
+}
+
+MeasurementData DataManager::load(int stationId, int sensorId, const QDateTime &from, const QDateTime &to)
+{
+    static Metrics::Histogram &duration =
+        Metrics::instance().histogram("pogoda_datamanager_seconds", "function=\"load\"");
+    Metrics::ScopedTimer timer(duration);
+
+    importLegacyFile(stationId, sensorId);
+
+    MeasurementData data;
+    loadMetadata(stationId, sensorId, data);
+    data.values = store->load(stationId, sensorId, from.toMSecsSinceEpoch(), to.toMSecsSinceEpoch());
+    return data;
+}
+
+RangeStats DataManager::stats(int stationId, int sensorId, const QDateTime &from, const QDateTime &to,
+                              double threshold)
+{
+    static Metrics::Histogram &duration =
+        Metrics::instance().histogram("pogoda_datamanager_seconds", "function=\"stats\"");
+    Metrics::ScopedTimer timer(duration);
+
+    importLegacyFile(stationId, sensorId);
+    return store->stats(stationId, sensorId, from.toMSecsSinceEpoch(), to.toMSecsSinceEpoch(), threshold);
+}
+
+QList<RollupBucket> DataManager::rollups(int stationId, int sensorId, RollupTier tier,
+                                         const QDateTime &from, const QDateTime &to)
+{
+    static Metrics::Histogram &duration =
+        Metrics::instance().histogram("pogoda_datamanager_seconds", "function=\"rollups\"");
+    Metrics::ScopedTimer timer(duration);
+
+    importLegacyFile(stationId, sensorId);
+    if (tier != RollupTier::Hourly) {
+        return rollupStore->buckets(stationId, sensorId, tier, from.toMSecsSinceEpoch(), to.toMSecsSinceEpoch());
+    }
+
+    const TimeSeries samples = store->load(stationId, sensorId, from.toMSecsSinceEpoch(), to.toMSecsSinceEpoch());
+    QList<RollupBucket> buckets;
+    buckets.reserve(samples.validCount());
+    for (qsizetype i = 0; i < samples.size(); ++i) {
+        if (samples.isValid(i)) {
+            buckets.append(RollupStore::summarize(samples.timestampAt(i), samples, i, i + 1));
+        }
+    }
+    return buckets;
+}
 
+MeasurementData DataManager::loadSeries(int stationId, int sensorId, const QDateTime &from, const QDateTime &to,
+                                        qsizetype maxPoints, RollupTier *tier)
+{
+    // Poziom jest dobierany do zapisanej części przedziału, a nie do np. "od 1970 roku"
+    QDateTime first, last;
+    RollupTier chosen = RollupTier::Hourly;
+    if (storedRange(stationId, sensorId, first, last)) {
+        chosen = RollupStore::tierFor(qMax(from, first).toMSecsSinceEpoch(), qMin(to, last).toMSecsSinceEpoch(),
+                                      maxPoints);
+    }
+    if (tier) *tier = chosen;
+    if (chosen == RollupTier::Hourly) return load(stationId, sensorId, from, to);
+
+    MeasurementData data;
+    loadMetadata(stationId, sensorId, data);
+    const QList<RollupBucket> buckets = rollups(stationId, sensorId, chosen, from, to);
+    data.values.reserve(buckets.size());
+    for (const RollupBucket &bucket : buckets) {
+        data.values.append(bucket.startMs, bucket.mean());
+    }
+    return data;
+}
+
+bool DataManager::storedRange(int stationId, int sensorId, QDateTime &first, QDateTime &last)
+{
+    importLegacyFile(stationId, sensorId);
+
+    qint64 minTs = std::numeric_limits<qint64>::max();
+    qint64 maxTs = std::numeric_limits<qint64>::min();
+    store->forEachSegment(stationId, sensorId, [&](const SegmentView &view) {
+        minTs = qMin(minTs, view.header->minTimestamp);
+        maxTs = qMax(maxTs, view.header->maxTimestamp);
+    });
+    if (minTs > maxTs) return false;
+
+    first = QDateTime::fromMSecsSinceEpoch(minTs);
+    last = QDateTime::fromMSecsSinceEpoch(maxTs);
+    return true;
+}
+
+void DataManager::saveMetadata(int stationId, int sensorId, const MeasurementData &data)
+{
     QJsonObject jsonData;
     jsonData["stationId"] = stationId;
     jsonData["sensorId"] = sensorId;
     jsonData["parameterName"] = data.parameterName;
     jsonData["parameterCode"] = data.parameterCode;
+    const QByteArray contents = QJsonDocument(jsonData).toJson();
+
+    QFile file(store->sensorDirectory(stationId, sensorId) + "/meta.json");
+    if (file.open(QIODevice::ReadOnly) && file.readAll() == contents) return;
+    file.close();
 
-    QJsonArray valuesArray;
-    for (const auto &value : data.values) {
-        QJsonObject valueObj;
-        valueObj["date"] = value.first.toString(Qt::ISODate);
-        valueObj["value"] = value.second;
-        valuesArray.append(valueObj);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not open file for writing:" << file.fileName();
+        return;
     }
-    jsonData["values"] = valuesArray;
+    file.write(contents);
+    file.close();
+}
+
+void DataManager::loadMetadata(int stationId, int sensorId, MeasurementData &data) const
+{
+    QFile file(store->sensorDirectory(stationId, sensorId) + "/meta.json");
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QJsonObject jsonData = QJsonDocument::fromJson(file.readAll()).object();
+    data.parameterName = jsonData["parameterName"].toString();
+    data.parameterCode = jsonData["parameterCode"].toString();
+}
+
+void DataManager::importLegacyFile(int stationId, int sensorId)
+{
+    QString filePath = getFilePath(stationId, sensorId);
+    QFile file(filePath);
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) return;
 
-    file.write(QJsonDocument(jsonData).toJson());
+    QJsonObject jsonData = QJsonDocument::fromJson(file.readAll()).object();
     file.close();
+
+    MeasurementData data;
+    data.parameterName = jsonData["parameterName"].toString();
+    data.parameterCode = jsonData["parameterCode"].toString();
+
+    QJsonArray valuesArray = jsonData["values"].toArray();
+    data.values.reserve(valuesArray.size());
+    for (const QJsonValue &value : valuesArray) {
+        QJsonObject valueObj = value.toObject();
+        QDateTime date = QDateTime::fromString(valueObj["date"].toString(), Qt::ISODate);
+        if (!date.isValid()) continue;
+        if (valueObj["value"].isNull()) {
+            data.values.appendNull(date.toMSecsSinceEpoch());
+        } else {
+            data.values.append(date.toMSecsSinceEpoch(), valueObj["value"].toDouble());
+        }
+    }
+    data.values.sortByTime();
+
+    // Zapisane próbki mają pierwszeństwo - ponowny import (np. po nieudanej zmianie nazwy) niczego nie nadpisuje
+    MergeStats stats;
+    if (!mergeIntoStore(stationId, sensorId, data, false, stats)) {
+        qWarning() << "Could not import legacy file:" << filePath;
+        return;
+    }
+
+    // Zmiana nazwy dopiero po zapisie - przy błędzie zapisu plik zostanie zaimportowany przy następnym użyciu
+    if (!file.rename(filePath + ".imported")) {
+        qWarning() << "Could not rename imported file:" << filePath;
+    }
 }
 
 QString DataManager::getFilePath(int stationId, int sensorId) const
 {
-    QString dirPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/pogoda_data";
-    QDir().mkpath(dirPath);
-    return QString("%1/station_%2_sensor_%3.json").arg(dirPath).arg(stationId).arg(sensorId);
+    return QString("%1/station_%2_sensor_%3.json").arg(dataDirectory).arg(stationId).arg(sensorId);
 }
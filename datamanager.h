@@ -7,14 +7,34 @@
 
 #include <QObject>
 #include <QString>
+#include <QDateTime>
 #include "measurement.h"
+#include "segmentstore.h"
+#include "rollupstore.h"
+
+/**
+ * @struct MergeStats
+ * @brief Statystyki scalania zapisywanych danych z danymi już zapisanymi
+ */
+struct MergeStats {
+    qsizetype inserted = 0; // Liczba nowych próbek
+    qsizetype updated = 0; // Liczba próbek, których wartość została skorygowana
+    qsizetype unchanged = 0; // Liczba próbek, które były już zapisane
+
+    /// Zwraca liczbę zapisanych próbek
+    qsizetype written() const { return inserted + updated; }
+};
 
 /**
  * @class DataManager
  * @brief Klasa do zarządzania lokalnym przechowywaniem danych
  *
- * Klasa zapewnia funkcjonalność zapisu i odczytu danych
- * w formacie JSON do plików na dysku.
+ * Klasa zapewnia funkcjonalność zapisu i odczytu danych pomiarowych.
+ * Próbki są przechowywane w binarnym magazynie segmentów (SegmentStore),
+ * a nazwy parametrów w niewielkim pliku JSON obok segmentów. Pliki JSON
+ * z poprzednich wersji aplikacji są importowane przy pierwszym zapisie.
+ * Każdy zapis aktualizuje też agregaty dobowe i miesięczne (RollupStore),
+ * z których korzystają zapytania o długie przedziały.
  */
 class DataManager : public QObject
 {
@@ -28,21 +48,139 @@ public:
     explicit DataManager(QObject *parent = nullptr);
 
     /**
-     * @brief Zapisuje dane pomiarowe do pliku
+     * @brief Konstruktor z własnym katalogiem danych
+     * @param dataDirectory Katalog danych
+     * @param parent Wskaźnik na obiekt rodzica
+     */
+    explicit DataManager(const QString &dataDirectory, QObject *parent = nullptr);
+
+    /**
+     * @brief Zapisuje dane pomiarowe, scalając je z danymi już zapisanymi
+     *
+     * Nowe dane są łączone (merge-join po czasie) z zapisanymi próbkami z tego
+     * samego przedziału. Zapisywane są tylko próbki nowe lub skorygowane przez GIOS,
+     * a przy odczycie nowsza wartość ma pierwszeństwo. Koszt zapisu zależy od
+     * długości nowych danych, a nie od długości historii. Z próbek o tym samym
+     * czasie zapisywana jest ostatnia.
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     * @param data Dane pomiarowe do zapisania (posortowane rosnąco według czasu)
+     * @return Liczba próbek nowych, skorygowanych i niezmienionych
+     */
+    MergeStats saveMeasurementData(int stationId, int sensorId, const MeasurementData &data);
+
+    /**
+     * @brief Wczytuje zapisane dane pomiarowe z przedziału czasu
      * @param stationId ID stacji
      * @param sensorId ID czujnika
-     * @param data Dane pomiarowe do zapisania
+     * @param from Początek przedziału
+     * @param to Koniec przedziału
+     * @return Dane pomiarowe (puste, jeśli nic nie zapisano)
      */
-    void saveMeasurementData(int stationId, int sensorId, const MeasurementData &data);
+    MeasurementData load(int stationId, int sensorId, const QDateTime &from, const QDateTime &to);
+
+    /**
+     * @brief Oblicza statystyki zapisanych danych z przedziału czasu bez wczytywania próbek
+     *
+     * Odpowiedź powstaje głównie z map stref bloków magazynu (najmniejsza, największa
+     * wartość i suma bloku); dekodowane są tylko bloki na brzegach przedziału.
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     * @param from Początek przedziału
+     * @param to Koniec przedziału
+     * @param threshold Próg, powyżej którego liczone są pomiary (np. norma dobowa)
+     * @return Liczba pomiarów, minimum, maksimum, suma i liczba pomiarów powyżej progu
+     */
+    RangeStats stats(int stationId, int sensorId, const QDateTime &from, const QDateTime &to,
+                     double threshold = std::numeric_limits<double>::infinity());
+
+    /**
+     * @brief Zwraca agregaty zapisanych danych z przedziału czasu
+     *
+     * Poziomy Daily i Monthly są czytane z zapisanych agregatów; dla Hourly każda
+     * poprawna próbka jest osobnym agregatem.
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     * @param tier Poziom agregacji
+     * @param from Początek przedziału
+     * @param to Koniec przedziału
+     * @return Agregaty posortowane według czasu
+     */
+    QList<RollupBucket> rollups(int stationId, int sensorId, RollupTier tier, const QDateTime &from, const QDateTime &to);
+
+    /**
+     * @brief Wczytuje szereg z przedziału czasu na poziomie dopasowanym do liczby punktów
+     *
+     * Wybierany jest najdokładniejszy poziom (godziny, doby, miesiące), który mieści
+     * zapisaną część przedziału w maxPoints punktach - wykres z 5 lat to około
+     * 60 średnich miesięcznych zamiast około 44 tys. próbek godzinowych.
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     * @param from Początek przedziału
+     * @param to Koniec przedziału
+     * @param maxPoints Największa pożądana liczba punktów
+     * @param tier Jeśli podany, otrzymuje wybrany poziom
+     * @return Próbki godzinowe albo średnie przedziałów (z czasem początku przedziału)
+     */
+    MeasurementData loadSeries(int stationId, int sensorId, const QDateTime &from, const QDateTime &to,
+                               qsizetype maxPoints, RollupTier *tier = nullptr);
+
+    /**
+     * @brief Zwraca przedział czasu zapisanych danych czujnika
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     * @param first Czas najwcześniejszej próbki
+     * @param last Czas najpóźniejszej próbki
+     * @return false, jeśli nic nie zapisano
+     */
+    bool storedRange(int stationId, int sensorId, QDateTime &first, QDateTime &last);
 
 private:
+    QString dataDirectory; // Katalog danych
+    SegmentStore *store; // Binarny magazyn segmentów
+    RollupStore *rollupStore; // Agregaty dobowe i miesięczne
+
     /**
-     * @brief Generuje ścieżkę do pliku danych
+     * @brief Generuje ścieżkę do pliku danych w starym formacie JSON
      * @param stationId ID stacji
      * @param sensorId ID czujnika
      * @return Ścieżka do pliku
      */
     QString getFilePath(int stationId, int sensorId) const;
+
+    /**
+     * @brief Zapisuje nazwę i kod parametru obok segmentów czujnika
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     * @param data Dane pomiarowe z nazwą parametru
+     */
+    void saveMetadata(int stationId, int sensorId, const MeasurementData &data);
+
+    /**
+     * @brief Wczytuje nazwę i kod parametru czujnika
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     * @param data Dane pomiarowe, w których ustawiana jest nazwa parametru
+     */
+    void loadMetadata(int stationId, int sensorId, MeasurementData &data) const;
+
+    /**
+     * @brief Scala próbki z zapisaną historią i dopisuje segment z różnicą
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     * @param data Dane pomiarowe posortowane rosnąco według czasu
+     * @param replace true, jeśli próbki mają zastępować zapisane wartości (false - tylko uzupełnianie)
+     * @param stats Liczniki scalania
+     * @return false, jeśli zapis się nie powiódł
+     */
+    bool mergeIntoStore(int stationId, int sensorId, const MeasurementData &data, bool replace, MergeStats &stats);
+
+    /**
+     * @brief Importuje plik JSON zapisany przez poprzednie wersje aplikacji
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     */
+    void importLegacyFile(int stationId, int sensorId);
 };
 
 #endif // DATAMANAGER_H
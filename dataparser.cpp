@@ -1,10 +1,254 @@
 #include "dataparser.h"
+#include "metrics.h"
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QByteArrayView>
+#include <charconv>
+#include <limits>
+
+namespace {
+
+// Liczba dni od 1970-01-01 dla daty w kalendarzu gregoriańskim
+qint64 daysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2;
+    const qint64 era = (year >= 0 ? year : year - 399) / 400;
+    const int yearOfEra = int(year - era * 400);
+    const int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+int daysInMonth(int year, int month)
+{
+    static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return month == 2 && leap ? 29 : days[month - 1];
+}
+
+// Zamienia czas lokalny na ms od epoki; przesunięcie strefy jest liczone raz na dobę
+class LocalTimeConverter
+{
+public:
+    qint64 toEpochMs(int year, int month, int day, int hour, int minute, int second)
+    {
+        const qint64 dayNumber = daysFromCivil(year, month, day);
+        if (dayNumber != cachedDay) {
+            const QDate date(year, month, day);
+            const int startOffset = QDateTime(date, QTime(0, 0)).offsetFromUtc();
+            const int endOffset = QDateTime(date, QTime(23, 59, 59)).offsetFromUtc();
+            cachedDay = dayNumber;
+            cachedOffsetMs = qint64(startOffset) * 1000;
+            uniformOffset = startOffset == endOffset;
+        }
+
+        // W dniu zmiany czasu przesunięcie zależy od godziny
+        if (!uniformOffset) {
+            return QDateTime(QDate(year, month, day), QTime(hour, minute, second)).toMSecsSinceEpoch();
+        }
+        return dayNumber * 86400000 + ((hour * 60 + minute) * 60 + second) * qint64(1000) - cachedOffsetMs;
+    }
+
+private:
+    qint64 cachedDay = std::numeric_limits<qint64>::min(); // Numer doby w pamięci podręcznej
+    qint64 cachedOffsetMs = 0; // Przesunięcie strefy czasowej tej doby
+    bool uniformOffset = true; // Czy przesunięcie jest stałe przez całą dobę
+};
+
+// Szybka ścieżka dla stałego formatu GIOS "yyyy-MM-dd HH:mm:ss"
+bool parseGiosTimestamp(QByteArrayView text, LocalTimeConverter &converter, qint64 &epochMs)
+{
+    if (text.size() != 19 || text[4] != '-' || text[7] != '-' || (text[10] != ' ' && text[10] != 'T')
+        || text[13] != ':' || text[16] != ':') {
+        return false;
+    }
+
+    auto number = [&text](int pos, int length, int &value) {
+        value = 0;
+        for (int i = pos; i < pos + length; ++i) {
+            const unsigned digit = unsigned(text[i] - '0');
+            if (digit > 9) return false;
+            value = value * 10 + int(digit);
+        }
+        return true;
+    };
+
+    int year, month, day, hour, minute, second;
+    if (!number(0, 4, year) || !number(5, 2, month) || !number(8, 2, day)
+        || !number(11, 2, hour) || !number(14, 2, minute) || !number(17, 2, second)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)
+        || hour > 23 || minute > 59 || second > 59) {
+        return false;
+    }
+
+    epochMs = converter.toEpochMs(year, month, day, hour, minute, second);
+    return true;
+}
+
+// Minimalny skaner JSON typu pull działający bezpośrednio na buforze odpowiedzi
+class JsonScanner
+{
+public:
+    JsonScanner(const char *begin, const char *end) : p(begin), end(end) {}
+
+    void skipWhitespace()
+    {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+    }
+
+    bool consume(char c)
+    {
+        skipWhitespace();
+        if (p < end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+
+    bool peek(char c)
+    {
+        skipWhitespace();
+        return p < end && *p == c;
+    }
+
+    bool atEnd()
+    {
+        skipWhitespace();
+        return p == end;
+    }
+
+    // Zwraca surową zawartość łańcucha (bez dekodowania sekwencji ucieczki)
+    bool rawString(QByteArrayView &out)
+    {
+        if (!consume('"')) return false;
+        const char *start = p;
+        while (p < end && *p != '"') {
+            if (*p == '\\') ++p;
+            ++p;
+        }
+        if (p >= end) return false;
+        out = QByteArrayView(start, p - start);
+        ++p;
+        return true;
+    }
+
+    bool number(double &out)
+    {
+        skipWhitespace();
+        const auto result = std::from_chars(p, end, out);
+        if (result.ec != std::errc()) return false;
+        p = result.ptr;
+        return true;
+    }
+
+    bool literal(QByteArrayView word)
+    {
+        skipWhitespace();
+        if (end - p < word.size() || QByteArrayView(p, word.size()) != word) return false;
+        p += word.size();
+        return true;
+    }
+
+    bool skipValue()
+    {
+        skipWhitespace();
+        if (p >= end) return false;
+
+        if (*p == '"') {
+            QByteArrayView ignored;
+            return rawString(ignored);
+        }
+        if (*p == '{' || *p == '[') {
+            const char close = *p == '{' ? '}' : ']';
+            ++p;
+            if (consume(close)) return true;
+            do {
+                if (close == '}') {
+                    QByteArrayView ignored;
+                    if (!rawString(ignored) || !consume(':')) return false;
+                }
+                if (!skipValue()) return false;
+            } while (consume(','));
+            return consume(close);
+        }
+
+        const char *start = p;
+        while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' '
+               && *p != '\n' && *p != '\r' && *p != '\t') {
+            ++p;
+        }
+        return p != start;
+    }
+
+private:
+    const char *p; // Bieżąca pozycja
+    const char *end; // Koniec bufora
+};
+
+QString decodeJsonString(QByteArrayView raw)
+{
+    if (!raw.contains('\\')) return QString::fromUtf8(raw);
+    const QByteArray wrapped = "[\"" + raw.toByteArray() + "\"]";
+    return QJsonDocument::fromJson(wrapped).array().at(0).toString();
+}
+
+bool decodeSample(JsonScanner &in, LocalTimeConverter &converter, TimeSeries &values)
+{
+    if (!in.consume('{')) return false;
+
+    QByteArrayView date;
+    double value = 0.0;
+    bool valid = false;
+
+    if (!in.consume('}')) {
+        do {
+            QByteArrayView key;
+            if (!in.rawString(key) || !in.consume(':')) return false;
+
+            if (key == "date") {
+                if (!in.rawString(date)) return false;
+            } else if (key == "value") {
+                if (in.literal("null")) {
+                    valid = false;
+                } else if (in.number(value)) {
+                    valid = true;
+                } else {
+                    return false;
+                }
+            } else if (!in.skipValue()) {
+                return false;
+            }
+        } while (in.consume(','));
+        if (!in.consume('}')) return false;
+    }
+
+    qint64 epochMs;
+    if (!parseGiosTimestamp(date, converter, epochMs)) {
+        // Nietypowy zapis daty - wolna ścieżka zgodna z parseSensorData
+        const QDateTime parsed = QDateTime::fromString(QString::fromLatin1(date), Qt::ISODate);
+        if (!parsed.isValid()) return true;
+        epochMs = parsed.toMSecsSinceEpoch();
+    }
+
+    if (valid) {
+        values.append(epochMs, value);
+    } else {
+        values.appendNull(epochMs);
+    }
+    return true;
+}
+
+} // namespace
 
 namespace DataParser {
 
 QList<Station> parseStations(const QJsonDocument &json) {
+    static Metrics::Histogram &duration =
+        Metrics::instance().histogram("pogoda_parser_seconds", "function=\"parseStations\"");
+    Metrics::ScopedTimer timer(duration);
     QList<Station> stations;
     if (!json.isArray()) return stations;
 
@@ -20,12 +264,12 @@ QList<Station> parseStations(const QJsonDocument &json) {
 
         QJsonObject cityObj = obj["city"].toObject();
         station.city.id = cityObj["id"].toInt();
-        station.city.name = cityObj["name"].toString();
+        station.city.name = StringPool::intern(cityObj["name"].toString());
 
         QJsonObject communeObj = cityObj["commune"].toObject();
-        station.city.commune = communeObj["communeName"].toString();
-        station.city.district = communeObj["districtName"].toString();
-        station.city.province = communeObj["provinceName"].toString();
+        station.city.commune = StringPool::intern(communeObj["communeName"].toString());
+        station.city.district = StringPool::intern(communeObj["districtName"].toString());
+        station.city.province = StringPool::intern(communeObj["provinceName"].toString());
         station.city.address = cityObj["addressStreet"].toString();
 
         stations.append(station);
@@ -34,6 +278,9 @@ QList<Station> parseStations(const QJsonDocument &json) {
 }
 
 QList<MeasurementStation> parseSensors(const QJsonDocument &json) {
+    static Metrics::Histogram &duration =
+        Metrics::instance().histogram("pogoda_parser_seconds", "function=\"parseSensors\"");
+    Metrics::ScopedTimer timer(duration);
     QList<MeasurementStation> sensors;
     if (!json.isArray()) return sensors;
 
@@ -46,8 +293,8 @@ QList<MeasurementStation> parseSensors(const QJsonDocument &json) {
         sensor.stationId = obj["stationId"].toInt();
 
         QJsonObject paramObj = obj["param"].toObject();
-        sensor.parameterName = paramObj["paramName"].toString();
-        sensor.parameterCode = paramObj["paramCode"].toString();
+        sensor.parameterName = StringPool::intern(paramObj["paramName"].toString());
+        sensor.parameterCode = StringPool::intern(paramObj["paramCode"].toString());
 
         sensors.append(sensor);
     }
@@ -55,23 +302,78 @@ QList<MeasurementStation> parseSensors(const QJsonDocument &json) {
 }
 
 MeasurementData parseSensorData(const QJsonDocument &json) {
+    static Metrics::Histogram &duration =
+        Metrics::instance().histogram("pogoda_parser_seconds", "function=\"parseSensorData\"");
+    Metrics::ScopedTimer timer(duration);
     MeasurementData data;
     QJsonObject obj = json.object();
 
     data.parameterName = obj["key"].toString();
 
     QJsonArray valuesArray = obj["values"].toArray();
+    data.values.reserve(valuesArray.size());
     for (const QJsonValue &value : valuesArray) {
         QJsonObject valueObj = value.toObject();
         QDateTime date = QDateTime::fromString(valueObj["date"].toString(), Qt::ISODate);
-        double val = valueObj["value"].isNull() ? 0.0 : valueObj["value"].toDouble();
-        data.values.append(qMakePair(date, val));
+        if (!date.isValid()) continue;
+
+        // Brak pomiaru jest oznaczany w mapie ważności, a nie zastępowany zerem
+        if (valueObj["value"].isNull()) {
+            data.values.appendNull(date.toMSecsSinceEpoch());
+        } else {
+            data.values.append(date.toMSecsSinceEpoch(), valueObj["value"].toDouble());
+        }
     }
+    data.values.sortByTime();
 
     return data;
 }
 
+bool decodeSensorData(const QByteArray &payload, MeasurementData &data) {
+    static Metrics::Histogram &duration =
+        Metrics::instance().histogram("pogoda_parser_seconds", "function=\"decodeSensorData\"");
+    Metrics::ScopedTimer timer(duration);
+    JsonScanner in(payload.constData(), payload.constData() + payload.size());
+    if (!in.consume('{')) return false;
+
+    MeasurementData result;
+    result.values.reserve(payload.size() / 40); // Próbka GIOS zajmuje ok. 45 bajtów
+    LocalTimeConverter converter;
+
+    if (!in.consume('}')) {
+        do {
+            QByteArrayView key;
+            if (!in.rawString(key) || !in.consume(':')) return false;
+
+            if (key == "key" && in.peek('"')) {
+                QByteArrayView name;
+                if (!in.rawString(name)) return false;
+                result.parameterName = decodeJsonString(name);
+            } else if (key == "values" && in.peek('[')) {
+                in.consume('[');
+                if (!in.consume(']')) {
+                    do {
+                        if (!decodeSample(in, converter, result.values)) return false;
+                    } while (in.consume(','));
+                    if (!in.consume(']')) return false;
+                }
+            } else if (!in.skipValue()) {
+                return false;
+            }
+        } while (in.consume(','));
+        if (!in.consume('}')) return false;
+    }
+    if (!in.atEnd()) return false;
+
+    result.values.sortByTime();
+    data = std::move(result);
+    return true;
+}
+
 AirQualityIndex parseAirQualityIndex(const QJsonDocument &json) {
+    static Metrics::Histogram &duration =
+        Metrics::instance().histogram("pogoda_parser_seconds", "function=\"parseAirQualityIndex\"");
+    Metrics::ScopedTimer timer(duration);
     AirQualityIndex index;
     QJsonObject obj = json.object();
 
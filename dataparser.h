@@ -37,6 +37,20 @@ namespace DataParser {
      */
     MeasurementData parseSensorData(const QJsonDocument &json);
 
+    /**
+     * @brief Dekoduje dane pomiarowe bezpośrednio z treści odpowiedzi getData
+     *
+     * Jednoprzebiegowy dekoder strumieniowy (bez budowania drzewa QJsonDocument),
+     * zapisujący próbki wprost do zarezerwowanych kolumn TimeSeries. Daty w formacie
+     * "yyyy-MM-dd HH:mm:ss" są zamieniane na czas od epoki arytmetyką całkowitą,
+     * a przesunięcie strefy czasowej jest liczone raz na dobę.
+     * @param payload Treść odpowiedzi JSON
+     * @param data Dane wyjściowe
+     * @return true, jeśli dekodowanie się powiodło; false oznacza niepoprawny
+     *         lub nietypowy dokument, który należy przetworzyć przez parseSensorData
+     */
+    bool decodeSensorData(const QByteArray &payload, MeasurementData &data);
+
     /**
      * @brief Parsuje indeks jakości powietrza z dokumentu JSON
      * @param json Dokument JSON
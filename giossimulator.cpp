@@ -0,0 +1,302 @@
+#include "giossimulator.h"
+#include "syntheticdata.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QFile>
+#include <QCryptographicHash>
+#include <QRegularExpression>
+#include <memory>
+
+namespace {
+
+constexpr qsizetype MaxHeaderBytes = 64 * 1024;
+constexpr int BodyChunkIntervalMs = 100;
+
+QByteArray reasonPhrase(int status)
+{
+    switch (status) {
+    case 200: return "OK";
+    case 304: return "Not Modified";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "Unknown";
+    }
+}
+
+QByteArray errorBody(int status)
+{
+    return "{\"error\":\"" + reasonPhrase(status) + "\"}";
+}
+
+}
+
+GiosSimulator::GiosSimulator(const Options &options, QObject *parent)
+    : QObject(parent),
+    server(new QTcpServer(this))
+{
+    setOptions(options);
+    clock.start();
+    connect(server, &QTcpServer::newConnection, this, &GiosSimulator::onNewConnection);
+}
+
+bool GiosSimulator::listen(const QHostAddress &address, quint16 port)
+{
+    return server->listen(address, port);
+}
+
+QString GiosSimulator::baseUrl() const
+{
+    QString host = server->serverAddress().toString();
+    if (server->serverAddress().protocol() == QAbstractSocket::IPv6Protocol) {
+        host = '[' + host + ']';
+    }
+    return QString("http://%1:%2/pjp-api/rest").arg(host).arg(server->serverPort());
+}
+
+void GiosSimulator::setOptions(const Options &options)
+{
+    this->options = options;
+    randomState = options.seed;
+    tokens = options.burst;
+    bodies.clear();
+}
+
+double GiosSimulator::random()
+{
+    // splitmix64 - powtarzalny niezależnie od platformy i biblioteki standardowej
+    quint64 z = (randomState += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return double(z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+bool GiosSimulator::takeToken()
+{
+    const qint64 now = clock.elapsed();
+    tokens = qMin<double>(options.burst, tokens + (now - lastRefillMs) * options.requestsPerSecond / 1000.0);
+    lastRefillMs = now;
+    if (tokens < 1.0) return false;
+    tokens -= 1.0;
+    return true;
+}
+
+void GiosSimulator::onNewConnection()
+{
+    while (QTcpSocket *socket = server->nextPendingConnection()) {
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { processBuffer(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            buffers.remove(socket);
+            busy.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void GiosSimulator::processBuffer(QTcpSocket *socket)
+{
+    QByteArray &buffer = buffers[socket];
+    buffer += socket->readAll();
+    if (busy.value(socket)) return; // Kolejne żądanie połączenia po zakończeniu bieżącej odpowiedzi
+
+    const qsizetype headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (buffer.size() > MaxHeaderBytes) socket->abort();
+        return;
+    }
+
+    const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    buffer.remove(0, headerEnd + 4);
+
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() < 2) {
+        socket->abort();
+        return;
+    }
+
+    Request request;
+    request.method = requestLine[0];
+    QByteArray target = requestLine[1];
+    const qsizetype query = target.indexOf('?');
+    if (query >= 0) target.truncate(query);
+    request.path = QString::fromLatin1(target);
+    if (request.path.startsWith("/pjp-api/rest")) {
+        request.path.remove(0, int(qstrlen("/pjp-api/rest")));
+    }
+
+    for (qsizetype i = 1; i < lines.size(); ++i) {
+        const qsizetype colon = lines[i].indexOf(':');
+        if (colon > 0) {
+            request.headers.insert(lines[i].left(colon).trimmed().toLower(), lines[i].mid(colon + 1).trimmed());
+        }
+    }
+    handle(socket, request);
+}
+
+void GiosSimulator::handle(QTcpSocket *socket, const Request &request)
+{
+    ++stats.requests;
+    busy[socket] = true;
+
+    // Stała liczba losowań na żądanie - zmiana parametrów nie przesuwa sekwencji losowej
+    const double jitter = random();
+    const double tail = random();
+    const int delayMs = options.latencyMs + int(jitter * (options.jitterMs + 1))
+                        + (tail < options.tailProbability ? options.tailLatencyMs : 0);
+
+    // Gniazdo jako kontekst - odpowiedź przepada razem z zamkniętym połączeniem
+    QTimer::singleShot(delayMs, socket, [this, socket, request]() { respond(socket, request); });
+}
+
+void GiosSimulator::respond(QTcpSocket *socket, const Request &request)
+{
+    const bool keepAlive = request.headers.value("connection").toLower() != "close";
+    const double drop = random();
+    const double error = random();
+    const double errorKind = random();
+
+    if (drop < options.dropRate) {
+        ++stats.dropped;
+        emit requestServed(request.path, 0);
+        socket->abort();
+        return;
+    }
+
+    int status = 200;
+    QByteArray payload;
+    QByteArray extraHeaders;
+    if (options.requestsPerSecond > 0 && !takeToken()) {
+        ++stats.throttled;
+        status = 429;
+        payload = errorBody(status);
+        extraHeaders = "Retry-After: 1\r\n";
+    } else if (error < options.errorRate) {
+        ++stats.errors;
+        status = errorKind < 0.5 ? 500 : 503;
+        payload = errorBody(status);
+    } else if (request.method != "GET") {
+        status = 405;
+        payload = errorBody(status);
+    } else {
+        payload = body(request.path);
+        if (payload.isEmpty()) {
+            ++stats.notFound;
+            status = 404;
+            payload = errorBody(status);
+        } else {
+            const QByteArray etag = '"' + QCryptographicHash::hash(payload, QCryptographicHash::Md5).toHex() + '"';
+            extraHeaders = "ETag: " + etag + "\r\n";
+            if (request.headers.value("if-none-match") == etag) {
+                ++stats.notModified;
+                status = 304;
+                payload.clear();
+            } else {
+                ++stats.ok;
+            }
+        }
+    }
+
+    QByteArray head = "HTTP/1.1 " + QByteArray::number(status) + ' ' + reasonPhrase(status) + "\r\n"
+                      + "Content-Type: application/json;charset=UTF-8\r\n"
+                      + "Content-Length: " + QByteArray::number(payload.size()) + "\r\n"
+                      + extraHeaders
+                      + "Connection: " + (keepAlive ? "keep-alive" : "close") + "\r\n\r\n";
+    socket->write(head);
+    emit requestServed(request.path, status);
+    sendBody(socket, payload, keepAlive);
+}
+
+void GiosSimulator::sendBody(QTcpSocket *socket, const QByteArray &body, bool keepAlive)
+{
+    if (options.bodyBytesPerSecond <= 0 || body.isEmpty()) {
+        socket->write(body);
+        finishResponse(socket, keepAlive);
+        return;
+    }
+
+    // Powolna treść: porcje co 100 ms w zadanym tempie
+    const qsizetype chunk = qMax(1, options.bodyBytesPerSecond * BodyChunkIntervalMs / 1000);
+    auto offset = std::make_shared<qsizetype>(0);
+    QTimer *timer = new QTimer(socket);
+    timer->setInterval(BodyChunkIntervalMs);
+    connect(timer, &QTimer::timeout, socket, [this, socket, timer, body, chunk, offset, keepAlive]() {
+        socket->write(body.mid(*offset, chunk));
+        *offset += chunk;
+        if (*offset >= body.size()) {
+            timer->stop();
+            timer->deleteLater();
+            finishResponse(socket, keepAlive);
+        }
+    });
+    timer->start();
+}
+
+void GiosSimulator::finishResponse(QTcpSocket *socket, bool keepAlive)
+{
+    busy[socket] = false;
+    if (!keepAlive) {
+        socket->disconnectFromHost();
+        return;
+    }
+    if (!buffers.value(socket).isEmpty()) {
+        processBuffer(socket);
+    }
+}
+
+QByteArray GiosSimulator::body(const QString &path)
+{
+    auto cached = bodies.constFind(path);
+    if (cached != bodies.constEnd()) return *cached;
+
+    QByteArray result = options.recordingDirectory.isEmpty() ? QByteArray() : recordedBody(path);
+    if (result.isEmpty()) {
+        result = syntheticBody(path);
+    }
+
+    if (!result.isEmpty()) {
+        bodies.insert(path, result);
+    }
+    return result;
+}
+
+QByteArray GiosSimulator::recordedBody(const QString &path) const
+{
+    QFile file(options.recordingDirectory + path + ".json");
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+QByteArray GiosSimulator::syntheticBody(const QString &path) const
+{
+    if (path == "/station/findAll") {
+        return SyntheticData::stations(options.stationCount, options.seed);
+    }
+
+    static const QRegularExpression endpoint("^/(station/sensors|data/getData|aqindex/getIndex)/(\\d+)$");
+    const QRegularExpressionMatch match = endpoint.match(path);
+    if (!match.hasMatch()) return QByteArray();
+
+    const QString kind = match.captured(1);
+    const int id = match.captured(2).toInt();
+    if (kind == "station/sensors") {
+        // Nieznana stacja - pusta lista, jak w API GIOŚ
+        return (id >= 1 && id <= options.stationCount) ? SyntheticData::sensors(id, options.sensorsPerStation)
+                                                        : QByteArray("[]");
+    }
+    if (kind == "aqindex/getIndex") {
+        return (id >= 1 && id <= options.stationCount) ? SyntheticData::airQualityIndex(id) : QByteArray();
+    }
+
+    // ID czujnika = ID stacji * 100 + numer czujnika (jak w SyntheticData::sensors)
+    const int station = id / 100;
+    const int index = id % 100;
+    if (station < 1 || station > options.stationCount || index >= options.sensorsPerStation) {
+        return QByteArray();
+    }
+    const QStringList codes = SyntheticData::parameterCodes();
+    return SyntheticData::sensorData(options.samplesPerSensor, codes[index % codes.size()],
+                                     QDate::currentDate(), 0.02, options.seed ^ quint32(id));
+}
@@ -0,0 +1,153 @@
+/**
+ * @file giossimulator.h
+ * @brief Definicja klasy GiosSimulator - lokalnego serwera HTTP udającego API GIOŚ
+ */
+#ifndef GIOSSIMULATOR_H
+#define GIOSSIMULATOR_H
+
+#include <QObject>
+#include <QHash>
+#include <QHostAddress>
+#include <QElapsedTimer>
+
+class QTcpServer;
+class QTcpSocket;
+
+/**
+ * @class GiosSimulator
+ * @brief Serwer HTTP/1.1 na interfejsie lokalnym odpowiadający jak API GIOŚ
+ *
+ * Obsługuje endpointy /station/findAll, /station/sensors/{id}, /data/getData/{id}
+ * i /aqindex/getIndex/{id}. Odpowiedzi pochodzą z katalogu nagrań (plik
+ * <katalog>/<endpoint>.json, np. data/getData/642.json) albo z SyntheticData.
+ * Symulator potrafi wstrzykiwać opóźnienia (w tym rzadkie opóźnienia "ogona"),
+ * błędy HTTP, zerwane połączenia, powolne przesyłanie treści i ograniczanie
+ * tempa (429), a wszystkie losowania wykonuje generatorem o stałym ziarnie,
+ * więc przebieg testu obciążeniowego jest powtarzalny. Obsługuje też
+ * połączenia keep-alive i nagłówek If-None-Match (304).
+ */
+class GiosSimulator : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @struct Options
+     * @brief Parametry symulacji
+     */
+    struct Options {
+        int stationCount = 250; // Liczba stacji w /station/findAll
+        int sensorsPerStation = 6; // Liczba czujników stacji
+        int samplesPerSensor = 72; // Liczba pomiarów w /data/getData
+        int latencyMs = 0; // Stałe opóźnienie odpowiedzi
+        int jitterMs = 0; // Losowe dodatkowe opóźnienie z przedziału [0, jitterMs]
+        double tailProbability = 0.0; // Prawdopodobieństwo opóźnienia ogona
+        int tailLatencyMs = 0; // Dodatkowe opóźnienie ogona
+        double errorRate = 0.0; // Udział odpowiedzi 500/503
+        double dropRate = 0.0; // Udział połączeń zrywanych bez odpowiedzi
+        int bodyBytesPerSecond = 0; // Tempo wysyłania treści (0 - bez ograniczenia)
+        double requestsPerSecond = 0.0; // Limit tempa żądań (0 - bez limitu, powyżej - 429)
+        int burst = 10; // Pojemność wiadra żetonów limitu tempa
+        QString recordingDirectory; // Katalog z nagranymi odpowiedziami
+        quint32 seed = 1; // Ziarno generatora losowego
+    };
+
+    /**
+     * @struct Statistics
+     * @brief Liczniki obsłużonych żądań
+     */
+    struct Statistics {
+        quint64 requests = 0; // Wszystkie żądania
+        quint64 ok = 0; // Odpowiedzi 200
+        quint64 notModified = 0; // Odpowiedzi 304
+        quint64 errors = 0; // Wstrzyknięte błędy 5xx
+        quint64 dropped = 0; // Zerwane połączenia
+        quint64 throttled = 0; // Odpowiedzi 429
+        quint64 notFound = 0; // Nieznane endpointy
+    };
+
+    /**
+     * @brief Konstruktor klasy GiosSimulator
+     * @param options Parametry symulacji
+     * @param parent Wskaźnik na obiekt rodzica
+     */
+    explicit GiosSimulator(const Options &options = Options(), QObject *parent = nullptr);
+
+    /**
+     * @brief Uruchamia nasłuchiwanie
+     * @param address Adres (domyślnie interfejs lokalny)
+     * @param port Port (0 - dowolny wolny)
+     * @return true, jeśli serwer nasłuchuje
+     */
+    bool listen(const QHostAddress &address = QHostAddress::LocalHost, quint16 port = 0);
+
+    /**
+     * @brief Zwraca bazowy URL do ApiClient::setBaseUrl
+     * @return URL postaci http://127.0.0.1:port/pjp-api/rest
+     */
+    QString baseUrl() const;
+
+    /**
+     * @brief Zmienia parametry symulacji (dotyczy kolejnych żądań)
+     * @param options Parametry symulacji
+     */
+    void setOptions(const Options &options);
+
+    /**
+     * @brief Zwraca liczniki obsłużonych żądań
+     * @return Liczniki
+     */
+    Statistics statistics() const { return stats; }
+
+signals:
+
+    /**
+     * @brief Sygnał emitowany po obsłużeniu żądania
+     * @param path Ścieżka żądania
+     * @param status Kod odpowiedzi HTTP (0 dla zerwanego połączenia)
+     */
+    void requestServed(const QString &path, int status);
+
+private:
+    /**
+     * @struct Request
+     * @brief Przeanalizowane żądanie HTTP
+     */
+    struct Request {
+        QByteArray method; // Metoda HTTP
+        QString path; // Ścieżka bez prefiksu /pjp-api/rest
+        QHash<QByteArray, QByteArray> headers; // Nagłówki (nazwy małymi literami)
+    };
+
+    QTcpServer *server; // Gniazdo nasłuchujące
+    Options options; // Parametry symulacji
+    Statistics stats; // Liczniki
+    QHash<QTcpSocket *, QByteArray> buffers; // Nieprzetworzone dane połączeń
+    QHash<QTcpSocket *, bool> busy; // Połączenia w trakcie odpowiedzi
+    QHash<QString, QByteArray> bodies; // Wygenerowane odpowiedzi według ścieżki
+    quint64 randomState; // Stan generatora splitmix64
+    double tokens = 0.0; // Żetony limitu tempa
+    QElapsedTimer clock; // Zegar uzupełniania żetonów
+    qint64 lastRefillMs = 0; // Czas ostatniego uzupełnienia
+
+    void onNewConnection();
+    void processBuffer(QTcpSocket *socket);
+    void handle(QTcpSocket *socket, const Request &request);
+    void respond(QTcpSocket *socket, const Request &request);
+    void finishResponse(QTcpSocket *socket, bool keepAlive);
+    void sendBody(QTcpSocket *socket, const QByteArray &body, bool keepAlive);
+    bool takeToken();
+    double random();
+
+    /// Zwraca treść odpowiedzi endpointu (pusta tablica dla nieznanego endpointu)
+    QByteArray body(const QString &path);
+
+    /// Wczytuje nagraną odpowiedź z katalogu nagrań
+    QByteArray recordedBody(const QString &path) const;
+
+    /// Generuje odpowiedź przez SyntheticData
+    QByteArray syntheticBody(const QString &path) const;
+};
+
+#endif // GIOSSIMULATOR_H
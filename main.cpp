@@ -1,10 +1,12 @@
 #include "mainwindow.h"
+#include "metricsexporter.h"
 
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+    MetricsExporter::fromEnvironment(&a);
     MainWindow w;
     w.show();
     return a.exec();
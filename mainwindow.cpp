@@ -1,19 +1,67 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "datamanager.h"
+#include "seriespyramid.h"
+#include "seriesjoin.h"
+#include "analysis.h"
+#include "metrics.h"
 #include <QMessageBox>
+#include <QDockWidget>
+#include <QPlainTextEdit>
+#include <QFileDialog>
+#include <QShortcut>
+#include <QTimer>
+#include <QFontDatabase>
+#include <QCompleter>
+#include <QAbstractItemView>
+#include <QLineEdit>
 #include <QtCharts>
 #include <QDateTimeAxis>
 #include <QValueAxis>
+#include <algorithm>
+#include <limits>
+#include <memory>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , apiClient(new ApiClient(this))
+    , prefetcher(new PrefetchScheduler(apiClient, PrefetchScheduler::Options(), this))
     , dataManager(new DataManager(this))
+    , stationModel(new StationListModel(this))
+    , searchModel(new StationListModel(this))
 {
     ui->setupUi(this);
 
+    // Lista stacji z wyszukiwaniem: pole edycji filtruje podpowiedzi przez indeks trigramowy
+    ui->stationComboBox->setModel(stationModel);
+    ui->stationComboBox->setEditable(true);
+    ui->stationComboBox->setInsertPolicy(QComboBox::NoInsert);
+    ui->stationComboBox->lineEdit()->setPlaceholderText(tr("Wybierz lub wyszukaj stację..."));
+
+    QCompleter *completer = new QCompleter(searchModel, this);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    ui->stationComboBox->setCompleter(completer);
+
+    connect(ui->stationComboBox->lineEdit(), &QLineEdit::textEdited, this, [this, completer](const QString &text) {
+        searchModel->setFilter(text);
+        completer->complete();
+    });
+    connect(completer, QOverload<const QModelIndex &>::of(&QCompleter::activated),
+            this, [this](const QModelIndex &index) {
+        const int row = ui->stationComboBox->findData(index.data(StationListModel::StationIdRole));
+        if (row >= 0) ui->stationComboBox->setCurrentIndex(row);
+    });
+
+    // Najechanie kursorem na stację rozgrzewa jej listę czujników
+    auto warm = [this](const QModelIndex &index) {
+        prefetcher->warmStation(index.data(StationListModel::StationIdRole).toInt());
+    };
+    ui->stationComboBox->view()->setMouseTracking(true);
+    connect(ui->stationComboBox->view(), &QAbstractItemView::entered, this, warm);
+    completer->popup()->setMouseTracking(true);
+    connect(completer->popup(), &QAbstractItemView::entered, this, warm);
+
     connect(apiClient, &ApiClient::errorOccurred,
             this, &MainWindow::onApiError);
 
@@ -32,38 +80,99 @@ MainWindow::MainWindow(QWidget *parent)
             this, &MainWindow::onShowChartClicked);
     connect(ui->analyzeButton, &QPushButton::clicked,
             this, &MainWindow::onAnalyzeDataClicked);
+    connect(ui->historyChartButton, &QPushButton::clicked,
+            this, &MainWindow::onHistoryChartClicked);
+    connect(ui->addCompareButton, &QPushButton::clicked,
+            this, &MainWindow::onAddCompareClicked);
+    connect(ui->compareButton, &QPushButton::clicked,
+            this, &MainWindow::onCompareClicked);
+    connect(ui->clearCompareButton, &QPushButton::clicked,
+            this, &MainWindow::onClearCompareClicked);
+
+    QShortcut *metricsShortcut = new QShortcut(QKeySequence(tr("Ctrl+Shift+M")), this);
+    connect(metricsShortcut, &QShortcut::activated, this, &MainWindow::toggleMetricsPanel);
+
+    loadCatalogSnapshot();
 }
 
 MainWindow::~MainWindow()
 {
+    if (catalogDirty) {
+        saveCatalogSnapshot();
+    }
     delete ui;
 }
 
+void MainWindow::loadCatalogSnapshot()
+{
+    if (!CatalogSnapshot::load(CatalogSnapshot::defaultPath(), catalog) || catalog.stations.isEmpty()) return;
+
+    currentStations = catalog.stations;
+    spatialIndex.update(currentStations);
+    stationModel->setStations(currentStations);
+    searchModel->setStations(currentStations);
+    ui->stationComboBox->setCurrentIndex(0);
+
+    on_fetchStationsButton_clicked();
+}
+
+void MainWindow::saveCatalogSnapshot()
+{
+    catalog.savedAtMs = QDateTime::currentMSecsSinceEpoch();
+    CatalogSnapshot::save(CatalogSnapshot::defaultPath(), catalog);
+    catalogDirty = false;
+}
+
 void MainWindow::on_fetchStationsButton_clicked()
 {
     ui->statusLabel->setText(tr("Pobieranie stacji..."));
     ui->fetchStationsButton->setEnabled(false);
 
     auto future = apiClient->fetchAllStations();
-    future.then([this](QList<Station> stations) {
-        currentStations = stations;
-        ui->stationComboBox->clear();
-
-        for (const Station &station : stations) {
-            ui->stationComboBox->addItem(
-                QString("%1 (%2)").arg(station.stationName, station.city.name),
-                station.id
-                );
+    future.then(this, [this](QList<Station> stations) {
+        ui->fetchStationsButton->setEnabled(true);
+
+        if (currentStations.isEmpty()) {
+            currentStations = stations;
+            spatialIndex.update(stations);
+
+            // Cała lista trafia do modeli jednym resetem zamiast addItem() dla każdej stacji
+            ui->stationComboBox->setCurrentIndex(-1);
+            stationModel->setStations(stations);
+            searchModel->setStations(stations);
+            ui->stationComboBox->setCurrentIndex(stations.isEmpty() ? -1 : 0);
+            ui->statusLabel->setText(tr("Pobrano %1 stacji").arg(stations.size()));
+        } else if (stations.isEmpty()) {
+            // Błąd sieci - lista z zapisanego katalogu pozostaje w użyciu
+            ui->statusLabel->setText(tr("Nie udało się odświeżyć listy stacji"));
+            return;
+        } else {
+            // Do modeli trafiają tylko zmienione stacje - wybór użytkownika zostaje zachowany
+            const int changes = stationModel->updateStations(stations);
+            searchModel->updateStations(stations);
+            currentStations = stationModel->allStations();
+            if (changes > 0) {
+                spatialIndex.update(currentStations);
+            }
+            ui->statusLabel->setText(tr("Pobrano %1 stacji (zmienione: %2)").arg(stations.size()).arg(changes));
         }
 
-        ui->statusLabel->setText(tr("Pobrano %1 stacji").arg(stations.size()));
-        ui->fetchStationsButton->setEnabled(true);
+        if (!stations.isEmpty()) {
+            catalog.stations = currentStations;
+            saveCatalogSnapshot();
+        }
     });
     qDebug() << "Fetch Stations przycisk kliknięty!";
 }
 
 void MainWindow::onStationSelected(int index)
 {
+    // Przewijanie listy zmienia stację wiele razy - wcześniejsze pobieranie jest już niepotrzebne
+    pendingSensors.cancel();
+    pendingData.cancel();
+    pendingIndex.cancel();
+    ui->airQualityLabel->clear();
+
     if (index < 0) {
         ui->sensorComboBox->clear();
         ui->sensorComboBox->setEnabled(false);
@@ -72,35 +181,79 @@ void MainWindow::onStationSelected(int index)
 
     int stationId = ui->stationComboBox->currentData().toInt();
     ui->statusLabel->setText(tr("Pobieranie czujników dla stacji ID: %1...").arg(stationId));
-    ui->sensorComboBox->setEnabled(false);
-
-    auto future = apiClient->fetchStationSensors(stationId);
-    future.then([this](QList<MeasurementStation> sensors) {
-              currentSensors = sensors;
-              ui->sensorComboBox->clear();
-
-              for (const MeasurementStation &sensor : sensors) {
-                  ui->sensorComboBox->addItem(
-                      QString("%1 (%2)").arg(sensor.parameterName).arg(sensor.parameterCode),
-                      sensor.id
-                      );
-              }
+    if (index < currentStations.size()) {
+        showNearestStations(currentStations[index]);
+    }
 
-              ui->statusLabel->setText(tr("Znaleziono %1 czujników").arg(sensors.size()));
-              ui->sensorComboBox->setEnabled(!sensors.isEmpty());
+    pendingIndex = prefetcher->airQualityIndex(stationId);
+    pendingIndex.then(this, [this, stationId](AirQualityIndex index) {
+        if (ui->stationComboBox->currentData().toInt() != stationId || index.stationId == 0) return;
+        ui->airQualityLabel->setText(tr("Indeks jakości powietrza: %1 (%2)")
+                                         .arg(index.indexLevelName,
+                                              index.calculationDate.toString("yyyy-MM-dd HH:mm")));
+    });
+
+    // Czujniki z zapisanego katalogu są pokazywane od razu, sieć tylko je potwierdza
+    const auto known = catalog.sensors.constFind(stationId);
+    if (known != catalog.sensors.constEnd()) {
+        showSensors(stationId, *known);
+    } else {
+        currentSensors.clear();
+        ui->sensorComboBox->setEnabled(false);
+    }
+
+    pendingSensors = prefetcher->stationSensors(stationId);
+    pendingSensors.then(this, [this, stationId](QList<MeasurementStation> sensors) {
+              // Wynik mógł dotrzeć tuż przed zmianą stacji, gdy nie dało się go już anulować
+              if (ui->stationComboBox->currentData().toInt() != stationId) return;
+              if (sensors.isEmpty() && !currentSensors.isEmpty()) return; // Błąd sieci - lista z katalogu zostaje
+              if (!sensors.isEmpty() && sensors == currentSensors) return; // Bez zmian - wybór czujnika zostaje
 
               if (!sensors.isEmpty()) {
-                  ui->sensorComboBox->setCurrentIndex(0); // Automatycznie wybierz pierwszy czujnik
+                  catalog.sensors.insert(stationId, sensors);
+                  catalogDirty = true;
               }
-          }).onFailed([this]() {
-            ui->sensorComboBox->setEnabled(false);
+              showSensors(stationId, sensors);
+          }).onFailed(this, [this]() {
+            if (currentSensors.isEmpty()) {
+                ui->sensorComboBox->setEnabled(false);
+            }
         });
 }
 
+void MainWindow::showSensors(int stationId, const QList<MeasurementStation> &sensors)
+{
+    currentSensors = sensors;
+    // Dane wszystkich czujników pobierane w tle - zmiana czujnika nie czeka na sieć
+    prefetcher->prefetchStation(stationId, sensors);
+    ui->sensorComboBox->clear();
+
+    for (const MeasurementStation &sensor : sensors) {
+        ui->sensorComboBox->addItem(
+            QString("%1 (%2)").arg(StringPool::resolve(sensor.parameterName),
+                                  StringPool::resolve(sensor.parameterCode)),
+            sensor.id
+            );
+    }
+
+    ui->statusLabel->setText(tr("Znaleziono %1 czujników").arg(sensors.size()));
+    ui->sensorComboBox->setEnabled(!sensors.isEmpty());
+
+    if (!sensors.isEmpty()) {
+        ui->sensorComboBox->setCurrentIndex(0); // Automatycznie wybierz pierwszy czujnik
+    }
+}
+
 void MainWindow::onSensorSelected(int index)
 {
     if (index < 0 || index >= currentSensors.size()) return;
     ui->fetchDataButton->setEnabled(true);
+    ui->historyChartButton->setEnabled(true);
+
+    // Dane pobrane już w tle są pokazywane od razu, bez klikania "Pobierz dane"
+    if (prefetcher->hasSensorData(currentSensors[index].id)) {
+        onFetchDataClicked();
+    }
 }
 
 void MainWindow::onFetchDataClicked()
@@ -111,8 +264,11 @@ void MainWindow::onFetchDataClicked()
     int sensorId = currentSensors[sensorIndex].id;
     ui->statusLabel->setText(tr("Pobieranie danych dla czujnika ID: %1...").arg(sensorId));
 
-    auto future = apiClient->fetchSensorData(sensorId);
-    future.then([this](MeasurementData data) {
+    pendingData.cancel();
+    pendingData = prefetcher->sensorData(sensorId);
+    pendingData.then(this, [this, sensorId](MeasurementData data) {
+        const int current = ui->sensorComboBox->currentIndex();
+        if (current < 0 || current >= currentSensors.size() || currentSensors[current].id != sensorId) return;
         currentData = data;
         ui->statusLabel->setText(
             tr("Pobrano %1 pomiarów dla %2").arg(data.values.size()).arg(data.parameterName)
@@ -120,6 +276,7 @@ void MainWindow::onFetchDataClicked()
         ui->showChartButton->setEnabled(true);
         ui->analyzeButton->setEnabled(true);
         ui->saveDataButton->setEnabled(true);
+        ui->addCompareButton->setEnabled(true);
     });
 }
 
@@ -137,8 +294,9 @@ void MainWindow::onSaveDataClicked()
         int stationId = currentStations[stationIndex].id;
         int sensorId = currentSensors[sensorIndex].id;
 
-        dataManager->saveMeasurementData(stationId, sensorId, currentData);
-        ui->statusLabel->setText(tr("Dane zapisane do bazy"));
+        MergeStats stats = dataManager->saveMeasurementData(stationId, sensorId, currentData);
+        ui->statusLabel->setText(tr("Dane zapisane do bazy (nowe: %1, skorygowane: %2, bez zmian: %3)")
+                                     .arg(stats.inserted).arg(stats.updated).arg(stats.unchanged));
     }
 }
 
@@ -153,6 +311,86 @@ void MainWindow::onShowChartClicked()
               tr("Wykres dla %1 (%2)").arg(currentData.parameterName, currentData.parameterCode));
 }
 
+void MainWindow::onHistoryChartClicked()
+{
+    const int stationIndex = ui->stationComboBox->currentIndex();
+    const int sensorIndex = ui->sensorComboBox->currentIndex();
+    if (stationIndex < 0 || stationIndex >= currentStations.size()
+        || sensorIndex < 0 || sensorIndex >= currentSensors.size()) return;
+
+    const int stationId = currentStations[stationIndex].id;
+    const int sensorId = currentSensors[sensorIndex].id;
+    QDateTime first, last;
+    if (!dataManager->storedRange(stationId, sensorId, first, last)) {
+        QMessageBox::information(this, tr("Wykres historii"), tr("Brak zapisanych danych dla tego czujnika"));
+        return;
+    }
+
+    // Długa historia jest czytana z agregatów dobowych lub miesięcznych zamiast z próbek godzinowych
+    RollupTier tier = RollupTier::Hourly;
+    const MeasurementData history = dataManager->loadSeries(stationId, sensorId, first, last, 1000, &tier);
+    const QString resolution = tier == RollupTier::Monthly ? tr("średnie miesięczne")
+                               : tier == RollupTier::Daily ? tr("średnie dobowe")
+                                                           : tr("pomiary godzinowe");
+    showChart(history.values, tr("Historia %1 (%2)").arg(StringPool::resolve(currentSensors[sensorIndex].parameterName), resolution));
+}
+
+void MainWindow::onAddCompareClicked()
+{
+    if (currentData.values.isEmpty()) return;
+
+    const int stationIndex = ui->stationComboBox->currentIndex();
+    const QString station = stationIndex >= 0 && stationIndex < currentStations.size()
+                                ? currentStations[stationIndex].stationName : QString();
+    const QString label = tr("%1 - %2").arg(station, currentData.parameterCode);
+    compareLabels.append(label);
+    compareSeries.append(currentData.values);
+    ui->compareList->addItem(label);
+    ui->compareButton->setEnabled(compareSeries.size() >= 2);
+}
+
+void MainWindow::onCompareClicked()
+{
+    if (compareSeries.size() < 2) return;
+
+    SeriesJoin::Options options;
+    options.gapFill = SeriesJoin::GapFill::Linear;
+    switch (ui->compareResolutionComboBox->currentIndex()) {
+    case 1:
+        options.resample = true;
+        options.resolution = RollupTier::Daily;
+        options.maxGapMs = 3 * 24 * 3600 * qint64(1000);
+        break;
+    case 2:
+        options.resample = true;
+        options.resolution = RollupTier::Monthly;
+        options.maxGapMs = 93 * 24 * 3600 * qint64(1000);
+        break;
+    default:
+        break;
+    }
+
+    // Złączenie długich serii działa w puli wątków - okno pozostaje responsywne
+    ui->statusLabel->setText(tr("Wyrównywanie %1 serii...").arg(compareSeries.size()));
+    const QStringList labels = compareLabels;
+    pendingJoin.cancel();
+    pendingJoin = SeriesJoin::joinAsync(compareSeries, options);
+    pendingJoin.then(this, [this, labels](const QList<TimeSeries> &columns) {
+        const qsizetype rows = columns.isEmpty() ? 0 : columns.first().size();
+        ui->statusLabel->setText(tr("Wyrównano %1 serii (%2 wspólnych chwil)").arg(columns.size()).arg(rows));
+        showOverlayChart(columns, labels, tr("Porównanie serii"));
+    });
+}
+
+void MainWindow::onClearCompareClicked()
+{
+    pendingJoin.cancel();
+    compareSeries.clear();
+    compareLabels.clear();
+    ui->compareList->clear();
+    ui->compareButton->setEnabled(false);
+}
+
 void MainWindow::onAnalyzeDataClicked()
 {
     if (currentData.values.isEmpty()) {
@@ -169,33 +407,148 @@ void MainWindow::onApiError(const QString &message)
     ui->statusLabel->setText(tr("Błąd: %1").arg(message));
 }
 
-void MainWindow::showChart(const QList<QPair<QDateTime, double>> &data, const QString &title)
+void MainWindow::showNearestStations(const Station &station)
 {
-    QChart *chart = new QChart();
-    chart->setTitle(title);
+    const QList<SpatialIndex::Neighbor> neighbors =
+        spatialIndex.nearest(station.gegrLat, station.gegrLon, 5, [&station](int id) { return id != station.id; });
+
+    QString text = tr("<h3>Najbliższe stacje</h3><ul>");
+    for (const SpatialIndex::Neighbor &neighbor : neighbors) {
+        for (const Station &other : std::as_const(currentStations)) {
+            if (other.id == neighbor.stationId) {
+                text += tr("<li>%1 (%2) - %3 km</li>")
+                            .arg(other.stationName, StringPool::resolve(other.city.name))
+                            .arg(neighbor.distanceKm, 0, 'f', 1);
+                break;
+            }
+        }
+    }
+    text += "</ul>";
+    ui->dataDisplay->setHtml(text);
+}
 
-    QLineSeries *series = new QLineSeries();
-    for (const auto &point : data) {
-        series->append(point.first.toMSecsSinceEpoch(), point.second);
+void MainWindow::toggleMetricsPanel()
+{
+    if (!metricsDock) {
+        metricsDock = new QDockWidget(tr("Metryki"), this);
+        metricsDock->setObjectName("metricsDock");
+
+        QWidget *panel = new QWidget(metricsDock);
+        QVBoxLayout *layout = new QVBoxLayout(panel);
+        metricsView = new QPlainTextEdit(panel);
+        metricsView->setReadOnly(true);
+        metricsView->setLineWrapMode(QPlainTextEdit::NoWrap);
+        metricsView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+        layout->addWidget(metricsView);
+
+        QPushButton *exportButton = new QPushButton(tr("Zapisz eksport..."), panel);
+        layout->addWidget(exportButton);
+        connect(exportButton, &QPushButton::clicked, this, [this]() {
+            const QString path = QFileDialog::getSaveFileName(this, tr("Zapisz metryki"), "metrics.prom",
+                                                              tr("Prometheus (*.prom *.txt);;JSON (*.json)"));
+            if (!path.isEmpty() && !Metrics::instance().writeToFile(path)) {
+                QMessageBox::warning(this, tr("Błąd"), tr("Nie można zapisać pliku %1").arg(path));
+            }
+        });
+        metricsDock->setWidget(panel);
+        addDockWidget(Qt::RightDockWidgetArea, metricsDock);
+
+        auto refresh = [this]() {
+            const QString summary = Metrics::instance().summary();
+            metricsView->setPlainText(summary.isEmpty() ? tr("Brak pomiarów") : summary);
+        };
+        metricsTimer = new QTimer(this);
+        metricsTimer->setInterval(1000);
+        connect(metricsTimer, &QTimer::timeout, this, refresh);
+        connect(metricsDock, &QDockWidget::visibilityChanged, this, [this, refresh](bool visible) {
+            if (visible) {
+                refresh();
+                metricsTimer->start();
+            } else {
+                metricsTimer->stop();
+            }
+        });
+        metricsDock->hide();
     }
 
-    chart->addSeries(series);
+    if (metricsDock->isVisible()) {
+        metricsDock->hide();
+        return;
+    }
+    Metrics::setEnabled(true);
+    metricsDock->show();
+}
+
+void MainWindow::showChart(const TimeSeries &data, const QString &title)
+{
+    showOverlayChart({data}, {title}, title);
+}
+
+void MainWindow::showOverlayChart(const QList<TimeSeries> &columns, const QStringList &labels, const QString &title)
+{
+    QChart *chart = new QChart();
+    chart->setTitle(title);
+    chart->legend()->setVisible(columns.size() > 1);
 
     QDateTimeAxis *axisX = new QDateTimeAxis();
     axisX->setFormat("dd.MM.yyyy hh:mm");
     axisX->setTitleText(tr("Data"));
     chart->addAxis(axisX, Qt::AlignBottom);
-    series->attachAxis(axisX);
 
     QValueAxis *axisY = new QValueAxis();
     axisY->setTitleText(tr("Wartość"));
     chart->addAxis(axisY, Qt::AlignLeft);
-    series->attachAxis(axisY);
+
+    // Piramidy są budowane raz, a punkty są dobierane do widocznego zakresu i szerokości wykresu
+    QList<QPair<QLineSeries *, std::shared_ptr<SeriesPyramid>>> layers;
+    qint64 first = std::numeric_limits<qint64>::max();
+    qint64 last = std::numeric_limits<qint64>::min();
+    for (qsizetype i = 0; i < columns.size(); ++i) {
+        auto pyramid = std::make_shared<SeriesPyramid>(columns[i]);
+        QLineSeries *series = new QLineSeries();
+        series->setName(labels.value(i));
+        chart->addSeries(series);
+        series->attachAxis(axisX); // Wspólna oś czasu wszystkich serii
+        series->attachAxis(axisY);
+        layers.append({series, pyramid});
+
+        if (!pyramid->isEmpty()) {
+            first = qMin(first, pyramid->firstTimestamp());
+            last = qMax(last, pyramid->lastTimestamp());
+        }
+    }
+    if (first <= last) {
+        axisX->setRange(QDateTime::fromMSecsSinceEpoch(first), QDateTime::fromMSecsSinceEpoch(last));
+    }
+
+    auto refresh = [chart, axisX, axisY, layers]() {
+        const int pixelWidth = chart->plotArea().width() > 0 ? int(chart->plotArea().width()) : 800;
+        double low = std::numeric_limits<double>::max();
+        double high = std::numeric_limits<double>::lowest();
+        for (const auto &[series, pyramid] : layers) {
+            const QList<QPointF> points = pyramid->select(axisX->min().toMSecsSinceEpoch(),
+                                                          axisX->max().toMSecsSinceEpoch(), pixelWidth);
+            series->replace(points); // Jedna operacja zamiast dodawania punktów pojedynczo
+            for (const QPointF &point : points) {
+                low = qMin(low, point.y());
+                high = qMax(high, point.y());
+            }
+        }
+        if (low > high) return;
+
+        const double margin = qMax((high - low) * 0.05, 0.5);
+        axisY->setRange(low - margin, high + margin);
+    };
+    connect(axisX, &QDateTimeAxis::rangeChanged, chart, refresh);
+    connect(chart, &QChart::plotAreaChanged, chart, refresh);
+    refresh();
 
     QChartView *chartView = new QChartView(chart);
     chartView->setRenderHint(QPainter::Antialiasing);
+    chartView->setRubberBand(QChartView::HorizontalRubberBand); // Zaznaczenie przybliża, prawy przycisk oddala
 
     QDialog *chartDialog = new QDialog(this);
+    chartDialog->setAttribute(Qt::WA_DeleteOnClose);
     chartDialog->setWindowTitle(title);
     chartDialog->resize(800, 600);
 
@@ -213,33 +566,40 @@ void MainWindow::showAnalysis(const MeasurementData &data)
         return;
     }
 
-    double min = std::numeric_limits<double>::max();
-    double max = std::numeric_limits<double>::lowest();
-    double sum = 0.0;
-    QDateTime minTime, maxTime;
-
-    for (const auto &point : data.values) {
-        double value = point.second;
-        if (value < min) {
-            min = value;
-            minTime = point.first;
-        }
-        if (value > max) {
-            max = value;
-            maxTime = point.first;
-        }
-        sum += value;
+    const TimeSeries &values = data.values;
+    const Analysis::Summary summary = Analysis::summarize(values);
+    if (summary.count == 0) {
+        QMessageBox::information(this, tr("Analiza"), tr("Brak poprawnych pomiarów do analizy"));
+        return;
     }
 
-    double avg = sum / data.values.size();
+    Analysis::QuantileSketch sketch;
+    sketch.add(values);
+
+    QDateTime minTime = values.dateTimeAt(summary.minIndex);
+    QDateTime maxTime = values.dateTimeAt(summary.maxIndex);
 
     QString analysis = tr("<h2>Analiza danych: %1</h2>").arg(data.parameterName);
-    analysis += tr("<p><b>Liczba pomiarów:</b> %1</p>").arg(data.values.size());
+    analysis += tr("<p><b>Liczba pomiarów:</b> %1</p>").arg(summary.count);
+    analysis += tr("<p><b>Brakujące pomiary:</b> %1</p>").arg(summary.nullCount);
     analysis += tr("<p><b>Wartość minimalna:</b> %1 (%2)</p>")
-                    .arg(min).arg(minTime.toString("dd.MM.yyyy hh:mm"));
+                    .arg(summary.min).arg(minTime.toString("dd.MM.yyyy hh:mm"));
     analysis += tr("<p><b>Wartość maksymalna:</b> %1 (%2)</p>")
-                    .arg(max).arg(maxTime.toString("dd.MM.yyyy hh:mm"));
-    analysis += tr("<p><b>Średnia wartość:</b> %1</p>").arg(avg);
+                    .arg(summary.max).arg(maxTime.toString("dd.MM.yyyy hh:mm"));
+    analysis += tr("<p><b>Średnia wartość:</b> %1</p>").arg(summary.mean);
+    analysis += tr("<p><b>Odchylenie standardowe:</b> %1</p>").arg(summary.stdDev);
+    analysis += tr("<p><b>Mediana / P95 / P98:</b> %1 / %2 / %3</p>")
+                    .arg(sketch.quantile(0.50), 0, 'f', 1)
+                    .arg(sketch.quantile(0.95), 0, 'f', 1)
+                    .arg(sketch.quantile(0.98), 0, 'f', 1);
+
+    // Klucz odpowiedzi getData jest kodem parametru (np. PM10)
+    const QString code = data.parameterCode.isEmpty() ? data.parameterName : data.parameterCode;
+    for (const Analysis::Norm &norm : Analysis::normsFor(code)) {
+        analysis += tr("<p><b>%1:</b> %2</p>")
+                        .arg(norm.description)
+                        .arg(Analysis::countExceedances(values, norm));
+    }
 
     QMessageBox::information(this, tr("Analiza danych"), analysis);
 }
@@ -10,7 +10,15 @@
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QChart>
 #include "apiclient.h"
+#include "prefetchscheduler.h"
+#include "catalogsnapshot.h"
 #include "datamanager.h"
+#include "spatialindex.h"
+#include "stationlistmodel.h"
+
+class QDockWidget;
+class QPlainTextEdit;
+class QTimer;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -60,6 +68,18 @@ private slots:
     /// Slot obsługujący kliknięcie przycisku wyświetlania wykresu
     void onShowChartClicked();
 
+    /// Slot obsługujący kliknięcie przycisku wykresu zapisanej historii czujnika
+    void onHistoryChartClicked();
+
+    /// Slot dodający aktualne dane do listy porównania
+    void onAddCompareClicked();
+
+    /// Slot wyrównujący serie z listy porównania i pokazujący je na wspólnym wykresie
+    void onCompareClicked();
+
+    /// Slot czyszczący listę porównania
+    void onClearCompareClicked();
+
     /// Slot obsługujący kliknięcie przycisku analizy danych
     void onAnalyzeDataClicked();
 
@@ -69,17 +89,71 @@ private slots:
 private:
     Ui::MainWindow *ui; // Wskaźnik na interfejs użytkownika
     ApiClient *apiClient; // Wskaźnik na klienta API
+    PrefetchScheduler *prefetcher; // Pobieranie danych wybranej stacji z wyprzedzeniem
     DataManager *dataManager; //Wskaźnik na menadżera danych
+    StationListModel *stationModel; // Model listy stacji w stationComboBox
+    StationListModel *searchModel; // Model podpowiedzi filtrowany wpisywanym tekstem
     QList<Station> currentStations; //Lista aktualnie załadowanych stacji
     QList<MeasurementStation> currentSensors; //Lista aktualnie załadowanych czujników
     MeasurementData currentData; // Aktualnie załadowane dane pomiarowe
+    SpatialIndex spatialIndex; // Indeks przestrzenny załadowanych stacji
+    QFuture<QList<MeasurementStation>> pendingSensors; // Pobieranie czujników ostatnio wybranej stacji
+    QFuture<MeasurementData> pendingData; // Pobieranie danych ostatnio wybranego czujnika
+    QFuture<AirQualityIndex> pendingIndex; // Pobieranie indeksu ostatnio wybranej stacji
+    QFuture<QList<TimeSeries>> pendingJoin; // Wyrównywanie serii do porównania
+    QList<TimeSeries> compareSeries; // Serie dodane do porównania
+    QStringList compareLabels; // Opisy serii porównania
+    StationCatalog catalog; // Katalog stacji i czujników zapisywany między uruchomieniami
+    bool catalogDirty = false; // Czy katalog zmienił się od ostatniego zapisu
+    QDockWidget *metricsDock = nullptr; // Panel diagnostyczny metryk (tworzony przy pierwszym otwarciu)
+    QPlainTextEdit *metricsView = nullptr; // Zestawienie metryk w panelu
+    QTimer *metricsTimer = nullptr; // Odświeżanie panelu, gdy jest widoczny
+
+    /**
+     * @brief Wypełnia listę stacji z zapisanego katalogu i odświeża ją w tle
+     *
+     * Lista jest dostępna od razu po starcie; wynik odświeżenia nanosi tylko zmiany.
+     */
+    void loadCatalogSnapshot();
+
+    /// Zapisuje katalog stacji i czujników
+    void saveCatalogSnapshot();
+
+    /**
+     * @brief Wypełnia listę czujników i planuje pobranie ich danych w tle
+     * @param stationId ID stacji
+     * @param sensors Czujniki stacji
+     */
+    void showSensors(int stationId, const QList<MeasurementStation> &sensors);
+
+    /**
+     * @brief Wyświetla najbliższe stacje w polu danych
+     * @param station Wybrana stacja
+     */
+    void showNearestStations(const Station &station);
+
+    /**
+     * @brief Pokazuje lub ukrywa panel diagnostyczny metryk (Ctrl+Shift+M)
+     *
+     * Otwarcie panelu włącza zbieranie metryk; zestawienie jest odświeżane co sekundę,
+     * a eksport JSON lub Prometheus można zapisać do pliku.
+     */
+    void toggleMetricsPanel();
 
     /**
      * @brief Wyświetla wykres danych
      * @param data Dane do wyświetlenia
      * @param title Tytuł wykresu
      */
-    void showChart(const QList<QPair<QDateTime, double>> &data, const QString &title);
+    void showChart(const TimeSeries &data, const QString &title);
+
+    /**
+     * @brief Wyświetla kilka serii na jednym wykresie ze wspólną osią czasu
+     * @param columns Serie (np. kolumny wyniku SeriesJoin::join)
+     * @param labels Nazwy serii w legendzie
+     * @param title Tytuł wykresu
+     */
+    void showOverlayChart(const QList<TimeSeries> &columns, const QStringList &labels, const QString &title);
 
     /**
      * @brief Wyświetla analizę danych
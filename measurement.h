@@ -7,7 +7,8 @@
 
 #include <QDateTime>
 #include <QList>
-#include <QPair>
+#include "timeseries.h"
+#include "stringpool.h"
 
 /**
  * @struct MeasurementData
@@ -16,7 +17,7 @@
 struct MeasurementData {
     QString parameterName; //Nazwa parametru
     QString parameterCode; //Kod parametru
-    QList<QPair<QDateTime, double>> values; // Lista wartości pomiarowych z datami
+    TimeSeries values; // Szereg wartości pomiarowych z datami
 };
 
 /**
@@ -33,12 +34,21 @@ struct AirQualityIndex {
 /**
  * @struct MeasurementStation
  * @brief Struktura opisująca stanowisko pomiarowe
+ *
+ * Nazwa i kod parametru są identyfikatorami z StringPool.
  */
 struct MeasurementStation {
     int id; //ID stanowiska
     int stationId; //ID stacji
-    QString parameterName; //Nazwa mierzonego parametru
-    QString parameterCode; // Kod parametru
+    SymbolId parameterName; //Nazwa mierzonego parametru
+    SymbolId parameterCode; // Kod parametru
 };
 
+inline bool operator==(const MeasurementStation &a, const MeasurementStation &b)
+{
+    return a.id == b.id && a.stationId == b.stationId
+           && a.parameterName == b.parameterName && a.parameterCode == b.parameterCode;
+}
+inline bool operator!=(const MeasurementStation &a, const MeasurementStation &b) { return !(a == b); }
+
 #endif // MEASUREMENT_H
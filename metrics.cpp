@@ -0,0 +1,292 @@
+#include "metrics.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QMutexLocker>
+#include <QList>
+#include <QPair>
+#include <QtAlgorithms>
+#include <cmath>
+#include <limits>
+
+std::atomic<bool> Metrics::active{qEnvironmentVariableIntValue("POGODA_METRICS") != 0};
+
+namespace {
+
+// Rozdziela klucz rejestru "nazwa{etykiety}" na nazwę i etykiety
+QPair<QString, QString> splitKey(const QString &key)
+{
+    const qsizetype brace = key.indexOf('{');
+    if (brace < 0) return {key, QString()};
+    return {key.left(brace), key.mid(brace + 1, key.size() - brace - 2)};
+}
+
+QString makeKey(const QString &name, const QString &labels)
+{
+    return labels.isEmpty() ? name : name + '{' + labels + '}';
+}
+
+QByteArray seriesName(const QString &name, const QString &labels, const QString &extraLabel = QString())
+{
+    QString all = labels;
+    if (!extraLabel.isEmpty()) {
+        all += (all.isEmpty() ? "" : ",") + extraLabel;
+    }
+    return (all.isEmpty() ? name : name + '{' + all + '}').toUtf8();
+}
+
+QByteArray number(double value)
+{
+    return QByteArray::number(value, 'g', 9);
+}
+
+}
+
+int Metrics::Histogram::bucketIndex(quint64 value)
+{
+    if (value < quint64(SubBuckets)) return int(value);
+    const int msb = 63 - qCountLeadingZeroBits(value);
+    const int shift = msb - SubBucketBits;
+    return (shift + 1) * SubBuckets + int((value >> shift) & (SubBuckets - 1));
+}
+
+quint64 Metrics::Histogram::bucketLowerBound(int index)
+{
+    if (index < SubBuckets) return quint64(index);
+    if (index >= BucketCount) return std::numeric_limits<quint64>::max();
+    const int shift = index / SubBuckets - 1;
+    return quint64(SubBuckets + index % SubBuckets) << shift;
+}
+
+void Metrics::Histogram::record(qint64 micros)
+{
+    const quint64 value = micros > 0 ? quint64(micros) : 0;
+    buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+
+    quint64 previous = max.load(std::memory_order_relaxed);
+    while (previous < value && !max.compare_exchange_weak(previous, value, std::memory_order_relaxed)) {
+    }
+}
+
+Metrics::Histogram::Snapshot Metrics::Histogram::snapshot() const
+{
+    Snapshot result;
+    for (int i = 0; i < BucketCount; ++i) {
+        result.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+        result.count += result.buckets[i]; // Suma kubełków - liczność zgodna z kopią kubełków
+    }
+    result.sumMicros = sum.load(std::memory_order_relaxed);
+    result.maxMicros = max.load(std::memory_order_relaxed);
+    return result;
+}
+
+double Metrics::Histogram::Snapshot::quantile(double q) const
+{
+    if (count == 0) return 0.0;
+
+    const quint64 rank = qMax<quint64>(1, quint64(std::ceil(qBound(0.0, q, 1.0) * double(count))));
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            // Środek kubełka, ale nie więcej niż zaobserwowane maksimum
+            const quint64 low = bucketLowerBound(i);
+            const quint64 high = bucketLowerBound(i + 1);
+            return qMin(double(maxMicros), low + (high - low - 1) / 2.0);
+        }
+    }
+    return double(maxMicros);
+}
+
+Metrics::ScopedTimer::ScopedTimer(Histogram &histogram)
+    : target(Metrics::enabled() ? &histogram : nullptr)
+{
+    if (target) timer.start();
+}
+
+Metrics::ScopedTimer::~ScopedTimer()
+{
+    if (target) target->record(timer.nsecsElapsed() / 1000);
+}
+
+Metrics::Metrics()
+{
+    registerSampledGauge("pogoda_threadpool_active_threads",
+                         []() { return double(QThreadPool::globalInstance()->activeThreadCount()); });
+    registerSampledGauge("pogoda_threadpool_max_threads",
+                         []() { return double(QThreadPool::globalInstance()->maxThreadCount()); });
+}
+
+Metrics &Metrics::instance()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+Metrics::Counter &Metrics::counter(const QString &name, const QString &labels)
+{
+    QMutexLocker locker(&mutex);
+    std::unique_ptr<Counter> &entry = counters[makeKey(name, labels)];
+    if (!entry) entry = std::make_unique<Counter>();
+    return *entry;
+}
+
+Metrics::Gauge &Metrics::gauge(const QString &name, const QString &labels)
+{
+    QMutexLocker locker(&mutex);
+    std::unique_ptr<Gauge> &entry = gauges[makeKey(name, labels)];
+    if (!entry) entry = std::make_unique<Gauge>();
+    return *entry;
+}
+
+Metrics::Histogram &Metrics::histogram(const QString &name, const QString &labels)
+{
+    QMutexLocker locker(&mutex);
+    std::unique_ptr<Histogram> &entry = histograms[makeKey(name, labels)];
+    if (!entry) entry = std::make_unique<Histogram>();
+    return *entry;
+}
+
+void Metrics::registerSampledGauge(const QString &name, std::function<double()> sample)
+{
+    QMutexLocker locker(&mutex);
+    sampledGauges[name] = std::move(sample);
+}
+
+QByteArray Metrics::dump(Format format) const
+{
+    return format == Format::Json ? toJson() : toPrometheus();
+}
+
+bool Metrics::writeToFile(const QString &path) const
+{
+    // Zapis atomowy - czytelnik pliku nigdy nie zobaczy połowy eksportu
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(dump(path.endsWith(".json", Qt::CaseInsensitive) ? Format::Json : Format::Prometheus));
+    return file.commit();
+}
+
+QByteArray Metrics::toJson() const
+{
+    QJsonObject counterValues;
+    QJsonObject gaugeValues;
+    QJsonObject histogramValues;
+    std::map<QString, std::function<double()>> samplers;
+    {
+        QMutexLocker locker(&mutex);
+        for (const auto &[key, counter] : counters) {
+            counterValues[key] = double(counter->value());
+        }
+        for (const auto &[key, gauge] : gauges) {
+            gaugeValues[key] = double(gauge->value());
+        }
+        for (const auto &[key, histogram] : histograms) {
+            const Histogram::Snapshot snapshot = histogram->snapshot();
+            QJsonObject entry;
+            entry["count"] = double(snapshot.count);
+            entry["sumSeconds"] = snapshot.sumMicros / 1e6;
+            entry["maxSeconds"] = snapshot.maxMicros / 1e6;
+            entry["p50Seconds"] = snapshot.quantile(0.50) / 1e6;
+            entry["p90Seconds"] = snapshot.quantile(0.90) / 1e6;
+            entry["p95Seconds"] = snapshot.quantile(0.95) / 1e6;
+            entry["p99Seconds"] = snapshot.quantile(0.99) / 1e6;
+            entry["p999Seconds"] = snapshot.quantile(0.999) / 1e6;
+            histogramValues[key] = entry;
+        }
+        samplers = sampledGauges;
+    }
+    // Funkcje próbkujące są wywoływane poza blokadą - mogą same sięgać do rejestru
+    for (const auto &[name, sample] : samplers) {
+        gaugeValues[name] = sample();
+    }
+
+    QJsonObject root;
+    root["counters"] = counterValues;
+    root["gauges"] = gaugeValues;
+    root["histograms"] = histogramValues;
+    return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+QByteArray Metrics::toPrometheus() const
+{
+    QByteArray text;
+    QString lastName;
+    auto typeLine = [&text, &lastName](const QString &name, const char *type) {
+        if (name == lastName) return;
+        lastName = name;
+        text += "# TYPE " + name.toUtf8() + ' ' + type + '\n';
+    };
+
+    std::map<QString, std::function<double()>> samplers;
+    {
+        QMutexLocker locker(&mutex);
+        for (const auto &[key, counter] : counters) {
+            const auto [name, labels] = splitKey(key);
+            typeLine(name, "counter");
+            text += seriesName(name, labels) + ' ' + QByteArray::number(counter->value()) + '\n';
+        }
+        for (const auto &[key, gauge] : gauges) {
+            const auto [name, labels] = splitKey(key);
+            typeLine(name, "gauge");
+            text += seriesName(name, labels) + ' ' + QByteArray::number(gauge->value()) + '\n';
+        }
+        for (const auto &[key, histogram] : histograms) {
+            const auto [name, labels] = splitKey(key);
+            const Histogram::Snapshot snapshot = histogram->snapshot();
+            typeLine(name, "histogram");
+
+            // Tylko niepuste kubełki - granice są i tak stałe, a pełna lista ma prawie tysiąc pozycji
+            quint64 cumulative = 0;
+            for (int i = 0; i < Histogram::BucketCount; ++i) {
+                if (snapshot.buckets[i] == 0) continue;
+                cumulative += snapshot.buckets[i];
+                const double upperSeconds = Histogram::bucketLowerBound(i + 1) / 1e6;
+                text += seriesName(name + "_bucket", labels, "le=\"" + QString::fromLatin1(number(upperSeconds)) + '"')
+                        + ' ' + QByteArray::number(cumulative) + '\n';
+            }
+            text += seriesName(name + "_bucket", labels, "le=\"+Inf\"") + ' ' + QByteArray::number(snapshot.count) + '\n';
+            text += seriesName(name + "_sum", labels) + ' ' + number(snapshot.sumMicros / 1e6) + '\n';
+            text += seriesName(name + "_count", labels) + ' ' + QByteArray::number(snapshot.count) + '\n';
+        }
+        samplers = sampledGauges;
+    }
+    for (const auto &[name, sample] : samplers) {
+        typeLine(name, "gauge");
+        text += name.toUtf8() + ' ' + number(sample()) + '\n';
+    }
+    return text;
+}
+
+QString Metrics::summary() const
+{
+    QString text;
+    std::map<QString, std::function<double()>> samplers;
+    {
+        QMutexLocker locker(&mutex);
+        for (const auto &[key, histogram] : histograms) {
+            const Histogram::Snapshot snapshot = histogram->snapshot();
+            if (snapshot.count == 0) continue;
+            text += QString("%1\n    n=%2  p50=%3 ms  p95=%4 ms  p99=%5 ms  max=%6 ms\n")
+                        .arg(key).arg(snapshot.count)
+                        .arg(snapshot.quantile(0.50) / 1000.0, 0, 'f', 2)
+                        .arg(snapshot.quantile(0.95) / 1000.0, 0, 'f', 2)
+                        .arg(snapshot.quantile(0.99) / 1000.0, 0, 'f', 2)
+                        .arg(snapshot.maxMicros / 1000.0, 0, 'f', 2);
+        }
+        for (const auto &[key, counter] : counters) {
+            text += QString("%1 = %2\n").arg(key).arg(counter->value());
+        }
+        for (const auto &[key, gauge] : gauges) {
+            text += QString("%1 = %2\n").arg(key).arg(gauge->value());
+        }
+        samplers = sampledGauges;
+    }
+    for (const auto &[name, sample] : samplers) {
+        text += QString("%1 = %2\n").arg(name).arg(sample());
+    }
+    return text;
+}
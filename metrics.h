@@ -0,0 +1,225 @@
+/**
+ * @file metrics.h
+ * @brief Definicja klasy Metrics - liczników i histogramów czasów ścieżek krytycznych
+ */
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QString>
+#include <QByteArray>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <atomic>
+#include <array>
+#include <functional>
+#include <map>
+#include <memory>
+
+/**
+ * @class Metrics
+ * @brief Globalny rejestr metryk: liczników, wskaźników i histogramów opóźnień
+ *
+ * Zapis metryki to jedna operacja atomowa bez blokad, a gdy zbieranie jest
+ * wyłączone, miejsca pomiaru kończą się na odczycie jednej flagi (enabled()).
+ * Rejestr jest blokowany tylko przy pierwszym odwołaniu do danej serii i przy
+ * eksporcie. Nazwy i etykiety serii są zgodne z konwencją Prometheusa, np.
+ * pogoda_http_phase_seconds{endpoint="data/getData",phase="ttfb"}.
+ * Zbieranie włącza setEnabled() albo zmienna środowiskowa POGODA_METRICS=1.
+ */
+class Metrics
+{
+public:
+
+    /**
+     * @class Counter
+     * @brief Licznik monotoniczny
+     */
+    class Counter
+    {
+    public:
+        void add(quint64 n = 1) { count.fetch_add(n, std::memory_order_relaxed); }
+        quint64 value() const { return count.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<quint64> count{0};
+    };
+
+    /**
+     * @class Gauge
+     * @brief Wartość chwilowa (np. liczba żądań w locie)
+     */
+    class Gauge
+    {
+    public:
+        void add(qint64 n) { current.fetch_add(n, std::memory_order_relaxed); }
+        void set(qint64 n) { current.store(n, std::memory_order_relaxed); }
+        qint64 value() const { return current.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<qint64> current{0};
+    };
+
+    /**
+     * @class Histogram
+     * @brief Histogram czasów w mikrosekundach o kubełkach logarytmiczno-liniowych
+     *
+     * Jak w HdrHistogram każda potęga dwójki jest dzielona na 16 równych kubełków,
+     * więc błąd względny kwantyla nie przekracza ok. 6% w całym zakresie od
+     * mikrosekund do dni, a zapis to wyznaczenie indeksu i jeden fetch_add.
+     */
+    class Histogram
+    {
+    public:
+        static constexpr int SubBucketBits = 4;
+        static constexpr int SubBuckets = 1 << SubBucketBits;
+        static constexpr int BucketCount = SubBuckets * (64 - SubBucketBits + 1);
+
+        /**
+         * @struct Snapshot
+         * @brief Kopia histogramu do eksportu (liczniki odczytywane bez blokady)
+         */
+        struct Snapshot {
+            quint64 count = 0; // Liczba pomiarów
+            quint64 sumMicros = 0; // Suma czasów
+            quint64 maxMicros = 0; // Najdłuższy czas
+            std::array<quint64, BucketCount> buckets{}; // Liczności kubełków
+
+            /// Zwraca kwantyl q w mikrosekundach (0 dla pustego histogramu)
+            double quantile(double q) const;
+        };
+
+        /**
+         * @brief Dodaje pomiar
+         * @param micros Czas w mikrosekundach
+         */
+        void record(qint64 micros);
+
+        /**
+         * @brief Zwraca kopię histogramu
+         * @return Kopia liczników
+         */
+        Snapshot snapshot() const;
+
+        /// Zwraca indeks kubełka dla wartości
+        static int bucketIndex(quint64 value);
+
+        /// Zwraca dolną granicę kubełka
+        static quint64 bucketLowerBound(int index);
+
+    private:
+        std::array<std::atomic<quint64>, BucketCount> buckets{};
+        std::atomic<quint64> count{0};
+        std::atomic<quint64> sum{0};
+        std::atomic<quint64> max{0};
+    };
+
+    /**
+     * @class ScopedTimer
+     * @brief Mierzy czas życia obiektu i zapisuje go w histogramie
+     *
+     * Przy wyłączonych metrykach nie odczytuje zegara.
+     */
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Histogram &histogram);
+        ~ScopedTimer();
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        Histogram *target; // nullptr, gdy metryki są wyłączone
+        QElapsedTimer timer;
+    };
+
+    /// Format eksportu
+    enum class Format {
+        Json, // Dokument JSON
+        Prometheus // Format tekstowy Prometheusa
+    };
+
+    /**
+     * @brief Zwraca globalny rejestr metryk
+     * @return Referencja na rejestr
+     */
+    static Metrics &instance();
+
+    /**
+     * @brief Sprawdza, czy metryki są zbierane
+     * @return true, jeśli metryki są włączone
+     */
+    static bool enabled() { return active.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Włącza lub wyłącza zbieranie metryk
+     * @param enabled true, jeśli metryki mają być zbierane
+     */
+    static void setEnabled(bool enabled) { active.store(enabled, std::memory_order_relaxed); }
+
+    /**
+     * @brief Zwraca licznik o podanej nazwie i etykietach (tworzy go przy pierwszym użyciu)
+     * @param name Nazwa serii
+     * @param labels Etykiety w składni Prometheusa bez nawiasów, np. endpoint="x"
+     * @return Referencja ważna przez cały czas działania programu
+     */
+    Counter &counter(const QString &name, const QString &labels = QString());
+
+    /**
+     * @brief Zwraca wskaźnik o podanej nazwie i etykietach
+     * @param name Nazwa serii
+     * @param labels Etykiety serii
+     * @return Referencja ważna przez cały czas działania programu
+     */
+    Gauge &gauge(const QString &name, const QString &labels = QString());
+
+    /**
+     * @brief Zwraca histogram o podanej nazwie i etykietach
+     * @param name Nazwa serii (wartości eksportowane są w sekundach)
+     * @param labels Etykiety serii
+     * @return Referencja ważna przez cały czas działania programu
+     */
+    Histogram &histogram(const QString &name, const QString &labels = QString());
+
+    /**
+     * @brief Rejestruje wskaźnik odczytywany dopiero przy eksporcie
+     * @param name Nazwa serii
+     * @param sample Funkcja zwracająca bieżącą wartość
+     */
+    void registerSampledGauge(const QString &name, std::function<double()> sample);
+
+    /**
+     * @brief Eksportuje wszystkie metryki
+     * @param format Format eksportu
+     * @return Treść eksportu
+     */
+    QByteArray dump(Format format) const;
+
+    /**
+     * @brief Zwraca czytelne zestawienie metryk (kwantyle histogramów w milisekundach)
+     * @return Tekst zestawienia
+     */
+    QString summary() const;
+
+    /**
+     * @brief Zapisuje eksport do pliku (format JSON dla rozszerzenia .json, inaczej Prometheus)
+     * @param path Ścieżka pliku
+     * @return true, jeśli zapis się powiódł
+     */
+    bool writeToFile(const QString &path) const;
+
+private:
+    Metrics();
+
+    static std::atomic<bool> active; // Flaga zbierania (domyślnie z POGODA_METRICS)
+
+    mutable QMutex mutex; // Ochrona rejestru (nie samych wartości)
+    std::map<QString, std::unique_ptr<Counter>> counters; // Klucz: nazwa{etykiety}
+    std::map<QString, std::unique_ptr<Gauge>> gauges;
+    std::map<QString, std::unique_ptr<Histogram>> histograms;
+    std::map<QString, std::function<double()>> sampledGauges;
+
+    QByteArray toJson() const;
+    QByteArray toPrometheus() const;
+};
+
+#endif // METRICS_H
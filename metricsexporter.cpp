@@ -0,0 +1,81 @@
+#include "metricsexporter.h"
+#include "metrics.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTimer>
+#include <QDebug>
+
+MetricsExporter::MetricsExporter(QObject *parent)
+    : QObject(parent)
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    if (!dumpPath.isEmpty()) {
+        Metrics::instance().writeToFile(dumpPath);
+    }
+}
+
+MetricsExporter *MetricsExporter::fromEnvironment(QObject *parent)
+{
+    const QString socketName = qEnvironmentVariable("POGODA_METRICS_SOCKET");
+    const QString filePath = qEnvironmentVariable("POGODA_METRICS_FILE");
+    if (socketName.isEmpty() && filePath.isEmpty()) return nullptr;
+
+    Metrics::setEnabled(true);
+    auto *exporter = new MetricsExporter(parent);
+    if (!socketName.isEmpty() && !exporter->listen(socketName)) {
+        qWarning() << "Could not listen on metrics socket" << socketName;
+    }
+    if (!filePath.isEmpty()) {
+        bool ok = false;
+        const int interval = qEnvironmentVariableIntValue("POGODA_METRICS_INTERVAL", &ok);
+        exporter->startFileDump(filePath, ok && interval > 0 ? interval : 10000);
+    }
+    return exporter;
+}
+
+bool MetricsExporter::listen(const QString &name)
+{
+    if (!server) {
+        server = new QLocalServer(this);
+        connect(server, &QLocalServer::newConnection, this, &MetricsExporter::onNewConnection);
+    }
+    QLocalServer::removeServer(name); // Gniazdo po poprzednim, przerwanym uruchomieniu
+    return server->listen(name);
+}
+
+void MetricsExporter::startFileDump(const QString &path, int intervalMs)
+{
+    dumpPath = path;
+    if (!dumpTimer) {
+        dumpTimer = new QTimer(this);
+        connect(dumpTimer, &QTimer::timeout, this, [this]() {
+            if (!Metrics::instance().writeToFile(dumpPath)) {
+                qWarning() << "Could not write metrics to" << dumpPath;
+            }
+        });
+    }
+    dumpTimer->start(intervalMs);
+}
+
+void MetricsExporter::onNewConnection()
+{
+    while (QLocalSocket *socket = server->nextPendingConnection()) {
+        auto reply = [socket]() {
+            if (socket->property("answered").toBool()) return;
+            const QByteArray request = socket->readAll().trimmed().toLower();
+            socket->setProperty("answered", true);
+            socket->write(Metrics::instance().dump(request == "json" ? Metrics::Format::Json
+                                                                     : Metrics::Format::Prometheus));
+            socket->disconnectFromServer();
+        };
+        // Odpowiedź po pierwszym wierszu żądania albo po 200 ms ciszy (np. klient tylko czytający)
+        connect(socket, &QLocalSocket::readyRead, socket, [socket, reply]() {
+            if (socket->canReadLine()) reply();
+        });
+        QTimer::singleShot(200, socket, reply);
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+    }
+}
@@ -0,0 +1,73 @@
+/**
+ * @file metricsexporter.h
+ * @brief Definicja klasy MetricsExporter - udostępniania metryk przez gniazdo lokalne i plik
+ */
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+#include <QObject>
+#include <QString>
+
+class QLocalServer;
+class QTimer;
+
+/**
+ * @class MetricsExporter
+ * @brief Udostępnia eksport Metrics na gnieździe lokalnym i okresowo zapisuje go do pliku
+ *
+ * Klient gniazda lokalnego może wysłać wiersz "json" albo "prometheus"
+ * (domyślnie Prometheus po pustym wierszu lub rozłączeniu strony zapisu),
+ * w odpowiedzi dostaje eksport i połączenie jest zamykane, np.
+ * `echo json | socat - UNIX-CONNECT:/tmp/pogoda-metrics`.
+ */
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Konstruktor klasy MetricsExporter
+     * @param parent Wskaźnik na obiekt rodzica
+     */
+    explicit MetricsExporter(QObject *parent = nullptr);
+
+    /**
+     * @brief Destruktor - zapisuje ostatni eksport do pliku, jeśli zapis okresowy jest włączony
+     */
+    ~MetricsExporter() override;
+
+    /**
+     * @brief Konfiguruje eksport ze zmiennych środowiskowych
+     *
+     * POGODA_METRICS_SOCKET - nazwa gniazda lokalnego, POGODA_METRICS_FILE - plik
+     * zapisywany co POGODA_METRICS_INTERVAL ms (domyślnie 10000). Ustawienie
+     * którejkolwiek zmiennej włącza zbieranie metryk.
+     * @param parent Rodzic utworzonego obiektu
+     * @return Utworzony eksporter albo nullptr, jeśli żadna zmienna nie jest ustawiona
+     */
+    static MetricsExporter *fromEnvironment(QObject *parent);
+
+    /**
+     * @brief Uruchamia gniazdo lokalne
+     * @param name Nazwa gniazda (ścieżka w systemach Unix)
+     * @return true, jeśli gniazdo nasłuchuje
+     */
+    bool listen(const QString &name);
+
+    /**
+     * @brief Włącza okresowy zapis eksportu do pliku
+     * @param path Ścieżka pliku (.json - JSON, inaczej format Prometheusa)
+     * @param intervalMs Odstęp zapisów
+     */
+    void startFileDump(const QString &path, int intervalMs);
+
+private:
+    QLocalServer *server = nullptr; // Gniazdo lokalne (tworzone przy listen)
+    QTimer *dumpTimer = nullptr; // Timer zapisu okresowego
+    QString dumpPath; // Plik zapisu okresowego
+
+    void onNewConnection();
+};
+
+#endif // METRICSEXPORTER_H
@@ -0,0 +1,666 @@
+/**
+ * @file pogodabench.cpp
+ * @brief Benchmarki przetwarzania danych (QtTest, QBENCHMARK)
+ *
+ * Dla każdego przypadku, poza czasem raportowanym przez QtTest, zapisywane są
+ * ns/próbkę, MB/s i liczba alokacji na wywołanie. Wyniki trafiają do pliku
+ * wskazanego zmienną POGODA_BENCH_OUTPUT (domyślnie pogoda_bench.json, rozszerzenie
+ * .csv wybiera format CSV), co pozwala porównywać kolejne uruchomienia.
+ *
+ * Zmienne środowiskowe:
+ * - POGODA_BENCH_MAX_SAMPLES - największy rozmiar danych (domyślnie 1000000, maks. 10000000),
+ * - POGODA_BENCH_FIXTURES - katalog z nagranymi odpowiedziami GIOŚ (findAll*.json,
+ *   sensors*.json, getData*.json), dodawanymi jako dodatkowe przypadki.
+ */
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "dataparser.h"
+#include "datamanager.h"
+#include "analysis.h"
+#include "seriespyramid.h"
+#include "seriesjoin.h"
+#include "columncodec.h"
+#include "queryengine.h"
+#include "stringpool.h"
+#include "syntheticdata.h"
+
+namespace {
+
+std::atomic<quint64> allocationCount{0};
+
+}
+
+#if defined(__GLIBC__)
+// glibc: przechwycenie malloc obejmuje również alokacje kontenerów Qt (QArrayData używa malloc)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+
+void *malloc(size_t size) noexcept
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) noexcept
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) noexcept
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(pointer, size);
+}
+}
+#else
+// Pozostałe platformy: liczone są tylko alokacje przez operator new
+void *operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+#endif
+
+namespace {
+
+// Pomiar jednego przypadku: czas i alokacje sumowane po iteracjach QBENCHMARK
+class Measurement
+{
+public:
+    void begin()
+    {
+        allocationsAtStart = allocationCount.load(std::memory_order_relaxed);
+        timer.start();
+    }
+
+    void end()
+    {
+        nanoseconds += timer.nsecsElapsed();
+        allocations += allocationCount.load(std::memory_order_relaxed) - allocationsAtStart;
+        ++iterations;
+    }
+
+    qint64 nanoseconds = 0; // Łączny czas
+    quint64 allocations = 0; // Łączna liczba alokacji
+    qint64 iterations = 0; // Liczba wywołań
+
+private:
+    QElapsedTimer timer;
+    quint64 allocationsAtStart = 0;
+};
+
+struct Result {
+    QString benchmark; // Nazwa funkcji testowej
+    QString dataTag; // Przypadek
+    qsizetype samples; // Liczba próbek (stacji, czujników) na wywołanie
+    qint64 bytes; // Rozmiar danych wejściowych na wywołanie
+    double nsPerCall;
+    double nsPerSample;
+    double megabytesPerSecond;
+    double allocationsPerCall;
+};
+
+const qsizetype SampleSizes[] = {1000, 10000, 100000, 1000000, 10000000};
+
+}
+
+class PogodaBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void parseStations_data();
+    void parseStations();
+    void parseSensors_data();
+    void parseSensors();
+    void parseSensorData_data();
+    void parseSensorData();
+    void decodeSensorData_data();
+    void decodeSensorData();
+    void saveMeasurementData_data();
+    void saveMeasurementData();
+    void resaveMeasurementData_data();
+    void resaveMeasurementData();
+    void columnCodec_data();
+    void columnCodec();
+    void rangeStats_data();
+    void rangeStats();
+    void historySeries_data();
+    void historySeries();
+    void crossStationQuery_data();
+    void crossStationQuery();
+    void seriesJoin_data();
+    void seriesJoin();
+    void analysis_data();
+    void analysis();
+    void chartSeries_data();
+    void chartSeries();
+
+private:
+    qsizetype maxSamples = 1000000;
+    QString fixtureDirectory;
+    QHash<qsizetype, QByteArray> sensorPayloads; // Wygenerowane odpowiedzi getData według rozmiaru
+    QList<Result> results;
+
+    const QByteArray &sensorPayload(qsizetype samples);
+    void addSampleRows();
+    void addPayloadRows(const QString &recordedPattern, const QList<QPair<QString, QByteArray>> &synthetic);
+    void record(const Measurement &measurement, qsizetype samples, qint64 bytes);
+    void writeResults() const;
+};
+
+void PogodaBench::initTestCase()
+{
+    bool ok = false;
+    const qsizetype limit = qEnvironmentVariable("POGODA_BENCH_MAX_SAMPLES").toLongLong(&ok);
+    if (ok && limit > 0) maxSamples = limit;
+    fixtureDirectory = qEnvironmentVariable("POGODA_BENCH_FIXTURES");
+}
+
+void PogodaBench::cleanupTestCase()
+{
+    writeResults();
+}
+
+const QByteArray &PogodaBench::sensorPayload(qsizetype samples)
+{
+    auto it = sensorPayloads.find(samples);
+    if (it == sensorPayloads.end()) {
+        it = sensorPayloads.insert(samples, SyntheticData::sensorData(samples));
+    }
+    return *it;
+}
+
+void PogodaBench::addSampleRows()
+{
+    QTest::addColumn<qsizetype>("samples");
+    for (qsizetype samples : SampleSizes) {
+        if (samples > maxSamples) break;
+        QTest::newRow(qPrintable(QString::number(samples))) << samples;
+    }
+}
+
+void PogodaBench::addPayloadRows(const QString &recordedPattern, const QList<QPair<QString, QByteArray>> &synthetic)
+{
+    QTest::addColumn<QByteArray>("payload");
+    for (const auto &[tag, payload] : synthetic) {
+        QTest::newRow(qPrintable(tag)) << payload;
+    }
+
+    if (fixtureDirectory.isEmpty()) return;
+    const QDir directory(fixtureDirectory);
+    for (const QString &name : directory.entryList({recordedPattern}, QDir::Files, QDir::Name)) {
+        QFile file(directory.filePath(name));
+        if (file.open(QIODevice::ReadOnly)) {
+            QTest::newRow(qPrintable("recorded:" + name)) << file.readAll();
+        }
+    }
+}
+
+void PogodaBench::record(const Measurement &measurement, qsizetype samples, qint64 bytes)
+{
+    if (measurement.iterations == 0) return;
+
+    Result result;
+    result.benchmark = QTest::currentTestFunction();
+    result.dataTag = QTest::currentDataTag();
+    result.samples = samples;
+    result.bytes = bytes;
+    result.nsPerCall = double(measurement.nanoseconds) / measurement.iterations;
+    result.nsPerSample = samples > 0 ? result.nsPerCall / samples : 0.0;
+    result.megabytesPerSecond = result.nsPerCall > 0 ? bytes / result.nsPerCall * 1e9 / 1e6 : 0.0;
+    result.allocationsPerCall = double(measurement.allocations) / measurement.iterations;
+    results.append(result);
+
+    qInfo("%s/%s: %.1f ns/sample, %.1f MB/s, %.1f alloc/call", qPrintable(result.benchmark),
+          qPrintable(result.dataTag), result.nsPerSample, result.megabytesPerSecond, result.allocationsPerCall);
+}
+
+void PogodaBench::writeResults() const
+{
+    const QString path = qEnvironmentVariable("POGODA_BENCH_OUTPUT", "pogoda_bench.json");
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Could not write benchmark results:" << path << file.errorString();
+        return;
+    }
+
+    if (path.endsWith(".csv", Qt::CaseInsensitive)) {
+        QTextStream stream(&file);
+        stream << "benchmark,dataTag,samples,bytes,nsPerCall,nsPerSample,megabytesPerSecond,allocationsPerCall\n";
+        for (const Result &result : results) {
+            stream << result.benchmark << ',' << result.dataTag << ',' << result.samples << ','
+                   << result.bytes << ',' << result.nsPerCall << ',' << result.nsPerSample << ','
+                   << result.megabytesPerSecond << ',' << result.allocationsPerCall << '\n';
+        }
+        return;
+    }
+
+    QJsonArray array;
+    for (const Result &result : results) {
+        array.append(QJsonObject{
+            {"benchmark", result.benchmark},
+            {"dataTag", result.dataTag},
+            {"samples", qint64(result.samples)},
+            {"bytes", result.bytes},
+            {"nsPerCall", result.nsPerCall},
+            {"nsPerSample", result.nsPerSample},
+            {"megabytesPerSecond", result.megabytesPerSecond},
+            {"allocationsPerCall", result.allocationsPerCall},
+        });
+    }
+    QJsonObject root{
+        {"qtVersion", qVersion()},
+        {"buildAbi", QSysInfo::buildAbi()},
+        {"timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+        {"results", array},
+    };
+    file.write(QJsonDocument(root).toJson());
+}
+
+void PogodaBench::parseStations_data()
+{
+    addPayloadRows("findAll*.json", {
+        {"synthetic:300", SyntheticData::stations(300)},
+        {"synthetic:3000", SyntheticData::stations(3000)},
+        {"synthetic:30000", SyntheticData::stations(30000)},
+    });
+}
+
+void PogodaBench::parseStations()
+{
+    QFETCH(QByteArray, payload);
+    qsizetype count = 0;
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.begin();
+        const QList<Station> stations = DataParser::parseStations(QJsonDocument::fromJson(payload));
+        measurement.end();
+        count = stations.size();
+    }
+    QVERIFY(count > 0);
+    record(measurement, count, payload.size());
+}
+
+void PogodaBench::parseSensors_data()
+{
+    addPayloadRows("sensors*.json", {
+        {"synthetic:6", SyntheticData::sensors(1, 6)},
+        {"synthetic:60", SyntheticData::sensors(1, 60)},
+    });
+}
+
+void PogodaBench::parseSensors()
+{
+    QFETCH(QByteArray, payload);
+    qsizetype count = 0;
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.begin();
+        const QList<MeasurementStation> sensors = DataParser::parseSensors(QJsonDocument::fromJson(payload));
+        measurement.end();
+        count = sensors.size();
+    }
+    QVERIFY(count > 0);
+    record(measurement, count, payload.size());
+}
+
+void PogodaBench::parseSensorData_data()
+{
+    QList<QPair<QString, QByteArray>> synthetic;
+    for (qsizetype samples : SampleSizes) {
+        if (samples > maxSamples) break;
+        synthetic.append({"synthetic:" + QString::number(samples), sensorPayload(samples)});
+    }
+    addPayloadRows("getData*.json", synthetic);
+}
+
+void PogodaBench::parseSensorData()
+{
+    QFETCH(QByteArray, payload);
+    qsizetype count = 0;
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.begin();
+        const MeasurementData data = DataParser::parseSensorData(QJsonDocument::fromJson(payload));
+        measurement.end();
+        count = data.values.size();
+    }
+    QVERIFY(count > 0);
+    record(measurement, count, payload.size());
+}
+
+void PogodaBench::decodeSensorData_data()
+{
+    parseSensorData_data();
+}
+
+void PogodaBench::decodeSensorData()
+{
+    QFETCH(QByteArray, payload);
+    qsizetype count = 0;
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.begin();
+        MeasurementData data;
+        const bool decoded = DataParser::decodeSensorData(payload, data);
+        measurement.end();
+        QVERIFY(decoded);
+        count = data.values.size();
+    }
+    QVERIFY(count > 0);
+    record(measurement, count, payload.size());
+}
+
+void PogodaBench::saveMeasurementData_data()
+{
+    addSampleRows();
+}
+
+void PogodaBench::saveMeasurementData()
+{
+    QFETCH(qsizetype, samples);
+    MeasurementData data;
+    data.parameterName = "pył zawieszony PM10";
+    data.parameterCode = "PM10";
+    data.values = SyntheticData::series(samples);
+
+    // Zapis do pustego magazynu - każda iteracja ma nowy katalog
+    Measurement measurement;
+    QBENCHMARK {
+        QTemporaryDir directory;
+        DataManager manager(directory.path());
+        measurement.begin();
+        const MergeStats stats = manager.saveMeasurementData(1, 1, data);
+        measurement.end();
+        QCOMPARE(stats.inserted, data.values.size());
+    }
+    record(measurement, samples, samples * qint64(sizeof(qint64) + sizeof(double)));
+}
+
+void PogodaBench::resaveMeasurementData_data()
+{
+    addSampleRows();
+}
+
+void PogodaBench::resaveMeasurementData()
+{
+    QFETCH(qsizetype, samples);
+    MeasurementData data;
+    data.parameterName = "pył zawieszony PM10";
+    data.parameterCode = "PM10";
+    data.values = SyntheticData::series(samples);
+
+    // Ponowny zapis tych samych danych - ścieżka porównania bez zapisu na dysk
+    QTemporaryDir directory;
+    DataManager manager(directory.path());
+    manager.saveMeasurementData(1, 1, data);
+
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.begin();
+        const MergeStats stats = manager.saveMeasurementData(1, 1, data);
+        measurement.end();
+        QCOMPARE(stats.written(), qsizetype(0));
+    }
+    record(measurement, samples, samples * qint64(sizeof(qint64) + sizeof(double)));
+}
+
+void PogodaBench::columnCodec_data()
+{
+    addSampleRows();
+}
+
+void PogodaBench::columnCodec()
+{
+    QFETCH(qsizetype, samples);
+    const TimeSeries series = SyntheticData::series(samples);
+
+    QList<QByteArray> blocks;
+    for (qsizetype first = 0; first < samples; first += ColumnCodec::BlockSamples) {
+        blocks.append(ColumnCodec::encodeBlock(series, first, qMin(first + ColumnCodec::BlockSamples, samples)));
+    }
+    qint64 encodedBytes = 0;
+    for (const QByteArray &block : blocks) encodedBytes += block.size();
+    qInfo("%s: %.2f B/sample", QTest::currentDataTag(), double(encodedBytes) / samples);
+
+    // Odczyt zimnego segmentu: dekodowanie wszystkich bloków do jednego szeregu
+    qsizetype count = 0;
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.begin();
+        TimeSeries decoded;
+        decoded.reserve(samples);
+        for (qsizetype i = 0; i < blocks.size(); ++i) {
+            const qsizetype blockCount = qMin(ColumnCodec::BlockSamples, samples - i * ColumnCodec::BlockSamples);
+            ColumnCodec::decodeBlock(reinterpret_cast<const uchar *>(blocks[i].constData()), blocks[i].size(),
+                                     blockCount, decoded);
+        }
+        measurement.end();
+        count = decoded.size();
+    }
+    QCOMPARE(count, samples);
+    record(measurement, samples, encodedBytes);
+}
+
+void PogodaBench::rangeStats_data()
+{
+    addSampleRows();
+}
+
+void PogodaBench::rangeStats()
+{
+    QFETCH(qsizetype, samples);
+    MeasurementData data;
+    data.parameterCode = "PM10";
+    data.values = SyntheticData::series(samples);
+
+    QTemporaryDir directory;
+    DataManager manager(directory.path());
+    manager.saveMeasurementData(1, 1, data);
+
+    // Zapytanie o środkowe 80% historii z progiem normy dobowej PM10
+    const qint64 first = data.values.timestampAt(0);
+    const qint64 span = data.values.timestampAt(samples - 1) - first;
+    const QDateTime from = QDateTime::fromMSecsSinceEpoch(first + span / 10);
+    const QDateTime to = QDateTime::fromMSecsSinceEpoch(first + span * 9 / 10);
+
+    RangeStats stats;
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.begin();
+        stats = manager.stats(1, 1, from, to, 50.0);
+        measurement.end();
+    }
+    QVERIFY(stats.count > 0);
+    qInfo("%s: %lld blocks from zone maps, %lld decoded", QTest::currentDataTag(),
+          qint64(stats.blocksFromZoneMaps), qint64(stats.blocksDecoded));
+    record(measurement, stats.count, stats.count * qint64(sizeof(qint64) + sizeof(double)));
+}
+
+void PogodaBench::historySeries_data()
+{
+    addSampleRows();
+}
+
+void PogodaBench::historySeries()
+{
+    QFETCH(qsizetype, samples);
+    MeasurementData data;
+    data.parameterCode = "PM10";
+    data.values = SyntheticData::series(samples);
+
+    QTemporaryDir directory;
+    DataManager manager(directory.path());
+    manager.saveMeasurementData(1, 1, data);
+
+    // Cała historia na wykresie o szerokości 1000 punktów - długie serie są czytane z agregatów
+    const QDateTime from = data.values.dateTimeAt(0);
+    const QDateTime to = data.values.dateTimeAt(samples - 1);
+    MeasurementData history;
+    RollupTier tier = RollupTier::Hourly;
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.begin();
+        history = manager.loadSeries(1, 1, from, to, 1000, &tier);
+        measurement.end();
+    }
+    QVERIFY(!history.values.isEmpty());
+    qInfo("%s: tier %d, %lld points", QTest::currentDataTag(), int(tier), qint64(history.values.size()));
+    record(measurement, samples, history.values.size() * qint64(sizeof(qint64) + sizeof(double)));
+}
+
+void PogodaBench::crossStationQuery_data()
+{
+    addSampleRows();
+}
+
+void PogodaBench::crossStationQuery()
+{
+    QFETCH(qsizetype, samples);
+    constexpr int Sensors = 64;
+    const qsizetype perSensor = qMax<qsizetype>(24, samples / Sensors);
+
+    QTemporaryDir directory;
+    DataManager manager(directory.path());
+    QueryEngine engine(&manager);
+    QueryEngine::Query query;
+    for (int i = 0; i < Sensors; ++i) {
+        MeasurementData data;
+        data.parameterCode = "PM2.5";
+        data.values = SyntheticData::series(perSensor, 1577836800000, 0.02, quint32(i + 1));
+        manager.saveMeasurementData(i + 1, i + 1, data);
+
+        QueryEngine::Source source;
+        source.station = Station{i + 1, QString("Stacja %1").arg(i + 1), 0.0, 0.0,
+                                 City{i + 1, 0, 0, 0, StringPool::intern(QString("Województwo %1").arg(i % 16)), QString()}};
+        source.sensorId = i + 1;
+        query.sources.append(source);
+    }
+
+    // Średnia godzinowa według województw z całej historii
+    query.from = QDateTime::fromMSecsSinceEpoch(1577836800000);
+    query.to = query.from.addSecs(perSensor * 3600);
+    query.resolution = RollupTier::Hourly;
+    query.series = true;
+
+    QueryEngine::Result result;
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.begin();
+        result = engine.run(query).result();
+        measurement.end();
+    }
+    QCOMPARE(result.groups.size(), qsizetype(16));
+    record(measurement, perSensor * Sensors, perSensor * Sensors * qint64(sizeof(qint64) + sizeof(double)));
+}
+
+void PogodaBench::seriesJoin_data()
+{
+    addSampleRows();
+}
+
+void PogodaBench::seriesJoin()
+{
+    QFETCH(qsizetype, samples);
+    constexpr int Inputs = 8;
+    const qsizetype perInput = qMax<qsizetype>(24, samples / Inputs);
+
+    // Szeregi przesunięte o kilka minut i z różnymi lukami - prawie każda chwila jest osobnym wierszem
+    QList<TimeSeries> inputs;
+    for (int i = 0; i < Inputs; ++i) {
+        inputs.append(SyntheticData::series(perInput, 1577836800000 + i * 60000, 0.05, quint32(i + 1)));
+    }
+    SeriesJoin::Options options;
+    options.gapFill = SeriesJoin::GapFill::Linear;
+
+    QList<TimeSeries> columns;
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.begin();
+        columns = SeriesJoin::join(inputs, options);
+        measurement.end();
+    }
+    QCOMPARE(columns.size(), qsizetype(Inputs));
+    record(measurement, perInput * Inputs, perInput * Inputs * qint64(sizeof(qint64) + sizeof(double)));
+}
+
+void PogodaBench::analysis_data()
+{
+    addSampleRows();
+}
+
+void PogodaBench::analysis()
+{
+    QFETCH(qsizetype, samples);
+    const TimeSeries series = SyntheticData::series(samples);
+    const QList<Analysis::Norm> norms = Analysis::normsFor("PM10");
+
+    // Jak MainWindow::showAnalysis: statystyki, kwantyle i przekroczenia norm
+    double sink = 0.0;
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.begin();
+        const Analysis::Summary summary = Analysis::summarize(series);
+        Analysis::QuantileSketch sketch;
+        sketch.add(series);
+        sink += summary.mean + sketch.quantile(0.5) + sketch.quantile(0.95) + sketch.quantile(0.98);
+        for (const Analysis::Norm &norm : norms) {
+            sink += Analysis::countExceedances(series, norm);
+        }
+        measurement.end();
+    }
+    QVERIFY(sink > 0.0);
+    record(measurement, samples, samples * qint64(sizeof(qint64) + sizeof(double)));
+}
+
+void PogodaBench::chartSeries_data()
+{
+    addSampleRows();
+}
+
+void PogodaBench::chartSeries()
+{
+    QFETCH(qsizetype, samples);
+    const TimeSeries series = SyntheticData::series(samples);
+
+    // Jak MainWindow::showChart: piramida i punkty dla całego zakresu przy szerokości 1200 px
+    qsizetype points = 0;
+    Measurement measurement;
+    QBENCHMARK {
+        measurement.begin();
+        const SeriesPyramid pyramid(series);
+        points = pyramid.select(pyramid.firstTimestamp(), pyramid.lastTimestamp(), 1200).size();
+        measurement.end();
+    }
+    QVERIFY(points > 0);
+    record(measurement, samples, samples * qint64(sizeof(qint64) + sizeof(double)));
+}
+
+QTEST_GUILESS_MAIN(PogodaBench)
+
+#include "pogodabench.moc"
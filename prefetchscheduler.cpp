@@ -0,0 +1,220 @@
+#include "prefetchscheduler.h"
+#include <QFutureWatcher>
+#include <QTimer>
+
+PrefetchScheduler::PrefetchScheduler(ApiClient *apiClient, const Options &options, QObject *parent)
+    : QObject(parent),
+    apiClient(apiClient),
+    options(options),
+    hoverTimer(new QTimer(this))
+{
+    dataCache.setMaxCost(options.maxCachedSamples);
+    sensorCache.setMaxCost(options.maxCachedStations);
+    indexCache.setMaxCost(options.maxCachedStations);
+    clock.start();
+
+    hoverTimer->setSingleShot(true);
+    hoverTimer->setInterval(options.hoverDelayMs);
+    connect(hoverTimer, &QTimer::timeout, this, [this]() {
+        const Task task{TaskKind::StationSensors, hoverStation, hoverStation};
+        if (hoverStation < 0 || hoverStation == currentStation || isCached(task)) return;
+        // Lista czujników jest mała, a użytkownik zaraz może wybrać stację - przed pozostałymi zadaniami
+        queue.prepend(task);
+        schedule();
+    });
+}
+
+QFuture<QList<MeasurementStation>> PrefetchScheduler::stationSensors(int stationId)
+{
+    const Entry<QList<MeasurementStation>> *entry = sensorCache.object(stationId);
+    if (isFresh(entry)) {
+        return QtFuture::makeReadyValueFuture(entry->value);
+    }
+
+    QFuture<QList<MeasurementStation>> fetch = apiClient->fetchStationSensors(stationId);
+    QFuture<QList<MeasurementStation>> result = fetch.then(this, [this, stationId](const QList<MeasurementStation> &sensors) {
+        storeSensors(stationId, sensors);
+        return sensors;
+    });
+    forwardCancel(QFuture<void>(result), QFuture<void>(fetch));
+    return result;
+}
+
+QFuture<MeasurementData> PrefetchScheduler::sensorData(int sensorId)
+{
+    const Entry<MeasurementData> *entry = dataCache.object(sensorId);
+    if (isFresh(entry)) {
+        return QtFuture::makeReadyValueFuture(entry->value);
+    }
+
+    // Zadanie w kolejce jest zbędne - żądanie z normalnym priorytetem pobierze ten sam zasób
+    queue.removeIf([sensorId](const Task &task) { return task.kind == TaskKind::SensorData && task.id == sensorId; });
+
+    QFuture<MeasurementData> fetch = apiClient->fetchSensorData(sensorId);
+    QFuture<MeasurementData> result = fetch.then(this, [this, sensorId](const MeasurementData &data) {
+        storeData(sensorId, data);
+        return data;
+    });
+    forwardCancel(QFuture<void>(result), QFuture<void>(fetch));
+    return result;
+}
+
+QFuture<AirQualityIndex> PrefetchScheduler::airQualityIndex(int stationId)
+{
+    const Entry<AirQualityIndex> *entry = indexCache.object(stationId);
+    if (isFresh(entry)) {
+        return QtFuture::makeReadyValueFuture(entry->value);
+    }
+
+    queue.removeIf([stationId](const Task &task) { return task.kind == TaskKind::AirQualityIndex && task.id == stationId; });
+
+    QFuture<AirQualityIndex> fetch = apiClient->fetchAirQualityIndex(stationId);
+    QFuture<AirQualityIndex> result = fetch.then(this, [this, stationId](const AirQualityIndex &index) {
+        storeIndex(stationId, index);
+        return index;
+    });
+    forwardCancel(QFuture<void>(result), QFuture<void>(fetch));
+    return result;
+}
+
+bool PrefetchScheduler::hasSensorData(int sensorId) const
+{
+    return isFresh(dataCache.object(sensorId));
+}
+
+void PrefetchScheduler::prefetchStation(int stationId, const QList<MeasurementStation> &sensors)
+{
+    currentStation = stationId;
+
+    // Dane poprzednio wybranej stacji nie są już potrzebne; rozgrzane listy czujników zostają
+    queue.removeIf([stationId](const Task &task) {
+        return task.kind != TaskKind::StationSensors && task.stationId != stationId;
+    });
+    for (auto it = running.begin(); it != running.end();) {
+        if (it->kind != TaskKind::StationSensors && it->stationId != stationId) {
+            it->future.cancel();
+            it = running.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    const Task index{TaskKind::AirQualityIndex, stationId, stationId};
+    if (!isCached(index)) {
+        queue.enqueue(index);
+    }
+    for (const MeasurementStation &sensor : sensors) {
+        const Task data{TaskKind::SensorData, sensor.id, stationId};
+        if (!isCached(data)) {
+            queue.enqueue(data);
+        }
+    }
+    schedule();
+}
+
+void PrefetchScheduler::warmStation(int stationId)
+{
+    if (stationId == hoverStation && hoverTimer->isActive()) return;
+    hoverStation = stationId;
+    hoverTimer->start(); // Przesuwanie kursora po liście tylko przestawia timer
+}
+
+void PrefetchScheduler::schedule()
+{
+    while (running.size() < options.maxConcurrent && !queue.isEmpty()) {
+        const Task task = queue.dequeue();
+        if (isCached(task)) continue;
+
+        const quint64 number = nextTaskNumber++;
+        running.insert(number, RunningTask{task.kind, task.stationId, start(task, number)});
+    }
+}
+
+QFuture<void> PrefetchScheduler::start(const Task &task, quint64 number)
+{
+    // Niski priorytet - żądania użytkownika wyprzedzają pobieranie w tle w kolejce menadżera sieci
+    // Miejsce zadania jest zwalniane także po błędzie i anulowaniu - inaczej kolejka by stanęła
+    switch (task.kind) {
+    case TaskKind::StationSensors: {
+        QFuture<QList<MeasurementStation>> fetch = apiClient->fetchStationSensors(task.id, QNetworkRequest::LowPriority);
+        fetch.then(this, [this, task, number](const QList<MeasurementStation> &sensors) {
+            storeSensors(task.id, sensors);
+            finishTask(number);
+        })
+        .onFailed(this, [this, number]() { finishTask(number); })
+        .onCanceled(this, [this, number]() { finishTask(number); });
+        return QFuture<void>(fetch);
+    }
+    case TaskKind::SensorData: {
+        QFuture<MeasurementData> fetch = apiClient->fetchSensorData(task.id, QNetworkRequest::LowPriority);
+        fetch.then(this, [this, task, number](const MeasurementData &data) {
+            storeData(task.id, data);
+            finishTask(number);
+        })
+        .onFailed(this, [this, number]() { finishTask(number); })
+        .onCanceled(this, [this, number]() { finishTask(number); });
+        return QFuture<void>(fetch);
+    }
+    case TaskKind::AirQualityIndex: {
+        QFuture<AirQualityIndex> fetch = apiClient->fetchAirQualityIndex(task.id, QNetworkRequest::LowPriority);
+        fetch.then(this, [this, task, number](const AirQualityIndex &index) {
+            storeIndex(task.id, index);
+            finishTask(number);
+        })
+        .onFailed(this, [this, number]() { finishTask(number); })
+        .onCanceled(this, [this, number]() { finishTask(number); });
+        return QFuture<void>(fetch);
+    }
+    }
+    return QFuture<void>();
+}
+
+void PrefetchScheduler::finishTask(quint64 number)
+{
+    // Zadanie anulowane przez prefetchStation zostało już usunięte
+    if (running.remove(number)) {
+        schedule();
+    }
+}
+
+bool PrefetchScheduler::isCached(const Task &task) const
+{
+    switch (task.kind) {
+    case TaskKind::StationSensors:
+        return isFresh(sensorCache.object(task.id));
+    case TaskKind::SensorData:
+        return isFresh(dataCache.object(task.id));
+    case TaskKind::AirQualityIndex:
+        return isFresh(indexCache.object(task.id));
+    }
+    return false;
+}
+
+void PrefetchScheduler::forwardCancel(QFuture<void> returned, QFuture<void> source)
+{
+    if (returned.isFinished()) return;
+
+    auto *watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcherBase::canceled, this, [source]() mutable { source.cancel(); });
+    connect(watcher, &QFutureWatcherBase::finished, watcher, &QObject::deleteLater);
+    watcher->setFuture(returned);
+}
+
+void PrefetchScheduler::storeSensors(int stationId, const QList<MeasurementStation> &sensors)
+{
+    if (sensors.isEmpty()) return; // Błąd pobierania - następne wywołanie spróbuje ponownie
+    sensorCache.insert(stationId, new Entry<QList<MeasurementStation>>{sensors, clock.elapsed()});
+}
+
+void PrefetchScheduler::storeData(int sensorId, const MeasurementData &data)
+{
+    if (data.values.isEmpty()) return;
+    // Koszt wpisu to liczba próbek - pamięć jest ograniczona niezależnie od długości szeregów
+    dataCache.insert(sensorId, new Entry<MeasurementData>{data, clock.elapsed()}, int(qMin<qsizetype>(data.values.size(), options.maxCachedSamples)));
+}
+
+void PrefetchScheduler::storeIndex(int stationId, const AirQualityIndex &index)
+{
+    if (index.stationId == 0) return;
+    indexCache.insert(stationId, new Entry<AirQualityIndex>{index, clock.elapsed()});
+}
@@ -0,0 +1,171 @@
+/**
+ * @file prefetchscheduler.h
+ * @brief Definicja klasy PrefetchScheduler - pobierania danych stacji z wyprzedzeniem
+ */
+#ifndef PREFETCHSCHEDULER_H
+#define PREFETCHSCHEDULER_H
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QQueue>
+#include <QFuture>
+#include <QElapsedTimer>
+#include "apiclient.h"
+
+class QTimer;
+
+/**
+ * @class PrefetchScheduler
+ * @brief Pobiera w tle dane wybranej stacji i przechowuje je w ograniczonej pamięci podręcznej
+ *
+ * Po wyborze stacji harmonogram pobiera z niskim priorytetem dane wszystkich
+ * jej czujników i indeks jakości powietrza, najwyżej kilka żądań naraz, a
+ * najechanie kursorem na stację na liście rozgrzewa jej listę czujników.
+ * Wyniki trafiają do QCache, którego koszt to liczba próbek, więc pamięć jest
+ * ograniczona niezależnie od długości szeregów. Metody stationSensors,
+ * sensorData i airQualityIndex zwracają gotowy wynik z pamięci, jeśli jest
+ * aktualny, a w przeciwnym razie pobierają go z normalnym priorytetem.
+ */
+class PrefetchScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @struct Options
+     * @brief Parametry harmonogramu
+     */
+    struct Options {
+        int maxConcurrent = 2; // Równoczesne żądania w tle
+        int maxCachedSamples = 2000000; // Pojemność pamięci danych pomiarowych (w próbkach)
+        int maxCachedStations = 512; // Pojemność pamięci list czujników i indeksów
+        int maxAgeMs = 15 * 60 * 1000; // Wiek, po którym wpis jest pobierany ponownie
+        int hoverDelayMs = 150; // Opóźnienie rozgrzewania po najechaniu kursorem
+    };
+
+    /**
+     * @brief Konstruktor klasy PrefetchScheduler
+     * @param apiClient Klient API
+     * @param options Parametry harmonogramu
+     * @param parent Wskaźnik na obiekt rodzica
+     */
+    PrefetchScheduler(ApiClient *apiClient, const Options &options = Options(), QObject *parent = nullptr);
+
+    /**
+     * @brief Zwraca listę czujników stacji
+     * @param stationId ID stacji
+     * @return Gotowy wynik z pamięci albo wynik pobierania
+     */
+    QFuture<QList<MeasurementStation>> stationSensors(int stationId);
+
+    /**
+     * @brief Zwraca dane pomiarowe czujnika
+     * @param sensorId ID czujnika
+     * @return Gotowy wynik z pamięci albo wynik pobierania
+     */
+    QFuture<MeasurementData> sensorData(int sensorId);
+
+    /**
+     * @brief Zwraca indeks jakości powietrza stacji
+     * @param stationId ID stacji
+     * @return Gotowy wynik z pamięci albo wynik pobierania
+     */
+    QFuture<AirQualityIndex> airQualityIndex(int stationId);
+
+    /**
+     * @brief Sprawdza, czy dane czujnika są w pamięci i są aktualne
+     * @param sensorId ID czujnika
+     * @return true, jeśli sensorData zwróci gotowy wynik
+     */
+    bool hasSensorData(int sensorId) const;
+
+    /**
+     * @brief Planuje pobranie w tle danych czujników i indeksu stacji
+     *
+     * Zadania wcześniej wybranej stacji, które nie zdążyły się zakończyć, są anulowane.
+     * @param stationId ID stacji
+     * @param sensors Czujniki stacji
+     */
+    void prefetchStation(int stationId, const QList<MeasurementStation> &sensors);
+
+    /**
+     * @brief Rozgrzewa listę czujników stacji wskazanej kursorem (z opóźnieniem)
+     * @param stationId ID stacji
+     */
+    void warmStation(int stationId);
+
+private:
+
+    /**
+     * @struct Entry
+     * @brief Wpis pamięci podręcznej z czasem pobrania
+     */
+    template <typename T>
+    struct Entry {
+        T value; // Wynik
+        qint64 fetchedAtMs; // Czas pobrania według zegara harmonogramu
+    };
+
+    /// Rodzaj zadania w tle
+    enum class TaskKind { StationSensors, SensorData, AirQualityIndex };
+
+    /**
+     * @struct Task
+     * @brief Zadanie pobrania w tle
+     */
+    struct Task {
+        TaskKind kind; // Rodzaj zasobu
+        int id; // ID czujnika lub stacji
+        int stationId; // Stacja, dla której zaplanowano zadanie
+    };
+
+    /**
+     * @struct RunningTask
+     * @brief Zadanie w toku
+     */
+    struct RunningTask {
+        TaskKind kind; // Rodzaj zasobu
+        int stationId; // Stacja, dla której zaplanowano zadanie
+        QFuture<void> future; // Wynik pobierania (do anulowania)
+    };
+
+    ApiClient *apiClient; // Klient API
+    Options options; // Parametry
+    QCache<int, Entry<MeasurementData>> dataCache; // Dane według ID czujnika (koszt - liczba próbek)
+    QCache<int, Entry<QList<MeasurementStation>>> sensorCache; // Czujniki według ID stacji
+    QCache<int, Entry<AirQualityIndex>> indexCache; // Indeksy według ID stacji
+    QQueue<Task> queue; // Zadania oczekujące
+    QHash<quint64, RunningTask> running; // Zadania w toku według numeru
+    quint64 nextTaskNumber = 0; // Numer kolejnego zadania
+    int currentStation = -1; // Stacja ostatnio przekazana do prefetchStation
+    int hoverStation = -1; // Stacja wskazana kursorem
+    QTimer *hoverTimer; // Opóźnienie rozgrzewania
+    QElapsedTimer clock; // Zegar wieku wpisów
+
+    /// Uruchamia oczekujące zadania do limitu równoczesnych żądań
+    void schedule();
+
+    /// Uruchamia zadanie i zwraca przyszły wynik pobierania
+    QFuture<void> start(const Task &task, quint64 number);
+
+    /// Usuwa zakończone zadanie i uruchamia kolejne
+    void finishTask(quint64 number);
+
+    /// Anulowanie zwróconego wyniku anuluje pobieranie (a w nim żądanie sieciowe)
+    void forwardCancel(QFuture<void> returned, QFuture<void> source);
+
+    /// Sprawdza, czy zasób zadania jest już w pamięci
+    bool isCached(const Task &task) const;
+
+    /// Sprawdza, czy wpis jest dostatecznie świeży
+    template <typename T>
+    bool isFresh(const Entry<T> *entry) const { return entry && clock.elapsed() - entry->fetchedAtMs < options.maxAgeMs; }
+
+    void storeSensors(int stationId, const QList<MeasurementStation> &sensors);
+    void storeData(int sensorId, const MeasurementData &data);
+    void storeIndex(int stationId, const AirQualityIndex &index);
+};
+
+#endif // PREFETCHSCHEDULER_H
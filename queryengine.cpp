@@ -0,0 +1,151 @@
+#include "queryengine.h"
+#include "datamanager.h"
+#include "stringpool.h"
+#include "metrics.h"
+#include <QtConcurrent/QtConcurrent>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <memory>
+
+QueryEngine::QueryEngine(DataManager *dataManager, QObject *parent)
+    : QObject(parent),
+    dataManager(dataManager)
+{
+}
+
+QList<QueryEngine::Source> QueryEngine::sources(const StationCatalog &catalog, const QString &parameterCode)
+{
+    QList<Source> result;
+    for (const Station &station : catalog.stations) {
+        for (const MeasurementStation &sensor : catalog.sensors.value(station.id)) {
+            if (StringPool::resolve(sensor.parameterCode).compare(parameterCode, Qt::CaseInsensitive) != 0) continue;
+            Source source;
+            source.station = station;
+            source.sensorId = sensor.id;
+            result.append(source);
+        }
+    }
+    return result;
+}
+
+QFuture<QueryEngine::Result> QueryEngine::run(const Query &query)
+{
+    // Parametry bez listy czujników - kopiowane do każdego zadania map
+    Query settings = query;
+    settings.sources.clear();
+    DataManager *manager = dataManager;
+    auto clock = std::make_shared<QElapsedTimer>();
+    clock->start();
+
+    return QtConcurrent::mappedReduced<Partial>(
+               query.sources,
+               [manager, settings](const Source &source) { return aggregate(manager, settings, source); },
+               &QueryEngine::merge,
+               QtConcurrent::UnorderedReduce)
+        .then([settings, clock](const Partial &partial) {
+            if (Metrics::enabled()) {
+                static Metrics::Histogram &duration = Metrics::instance().histogram("pogoda_query_seconds");
+                duration.record(clock->nsecsElapsed() / 1000);
+            }
+            return finish(partial, settings);
+        });
+}
+
+QueryEngine::Partial QueryEngine::aggregate(DataManager *dataManager, const Query &query, const Source &source)
+{
+    const qint64 fromMs = RollupStore::bucketStart(query.resolution, query.from.toMSecsSinceEpoch());
+    const qint64 toMs = query.to.toMSecsSinceEpoch();
+    const QList<RollupBucket> buckets =
+        source.series.isEmpty()
+            ? dataManager->rollups(source.station.id, source.sensorId, query.resolution,
+                                   QDateTime::fromMSecsSinceEpoch(fromMs), query.to)
+            : RollupStore::bucketize(source.series, query.resolution, fromMs, toMs);
+
+    Partial partial;
+    if (buckets.isEmpty()) return partial;
+
+    qint64 key = 0;
+    QString label;
+    switch (query.groupBy) {
+    case GroupBy::Country:
+        label = tr("Polska");
+        break;
+    case GroupBy::Province:
+        key = source.station.city.province;
+        label = StringPool::resolve(source.station.city.province);
+        break;
+    case GroupBy::District:
+        key = source.station.city.district;
+        label = StringPool::resolve(source.station.city.district);
+        break;
+    case GroupBy::Station:
+        key = source.station.id;
+        label = source.station.stationName;
+        break;
+    }
+
+    GroupState &group = partial.groups[key];
+    group.label = label;
+    group.stations.insert(source.station.id);
+    for (const RollupBucket &bucket : buckets) {
+        group.total.add(bucket);
+        if (query.series) {
+            group.series.insert(bucket.startMs, bucket);
+        }
+    }
+    partial.sensors = 1;
+    return partial;
+}
+
+void QueryEngine::merge(Partial &result, const Partial &partial)
+{
+    result.sensors += partial.sensors;
+    for (auto it = partial.groups.cbegin(); it != partial.groups.cend(); ++it) {
+        auto target = result.groups.find(it.key());
+        if (target == result.groups.end()) {
+            result.groups.insert(it.key(), it.value());
+            continue;
+        }
+
+        GroupState &group = *target;
+        group.stations.unite(it->stations);
+        group.total.add(it->total);
+        for (auto bucket = it->series.cbegin(); bucket != it->series.cend(); ++bucket) {
+            auto slot = group.series.find(bucket.key());
+            if (slot == group.series.end()) {
+                group.series.insert(bucket.key(), bucket.value());
+            } else {
+                slot->add(bucket.value());
+            }
+        }
+    }
+}
+
+QueryEngine::Result QueryEngine::finish(const Partial &partial, const Query &query)
+{
+    Result result;
+    result.sensors = partial.sensors;
+    result.groups.reserve(partial.groups.size());
+    for (const GroupState &state : partial.groups) {
+        Group group;
+        group.label = state.label;
+        group.stations = state.stations.size();
+        group.total = state.total;
+        group.series = state.series.values();
+        result.groups.append(group);
+    }
+
+    if (query.limit > 0) {
+        std::sort(result.groups.begin(), result.groups.end(), [](const Group &a, const Group &b) {
+            return a.total.mean() > b.total.mean();
+        });
+        if (result.groups.size() > query.limit) {
+            result.groups.resize(query.limit);
+        }
+    } else {
+        std::sort(result.groups.begin(), result.groups.end(), [](const Group &a, const Group &b) {
+            return QString::localeAwareCompare(a.label, b.label) < 0;
+        });
+    }
+    return result;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file queryengine.h
+ * @brief Definicja klasy QueryEngine - równoległych zapytań agregujących po wielu czujnikach
+ */
+#ifndef QUERYENGINE_H
+#define QUERYENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QDateTime>
+#include <QFuture>
+#include "station.h"
+#include "catalogsnapshot.h"
+#include "rollupstore.h"
+
+class DataManager;
+
+/**
+ * @class QueryEngine
+ * @brief Agregacja danych wielu czujników w schemacie map-reduce (QtConcurrent::mappedReduced)
+ *
+ * Każdy czujnik jest podsumowywany osobno w puli wątków (agregaty z RollupStore
+ * albo próbki z magazynu), a wyniki częściowe - sumowalne RollupBucket według
+ * grupy i przedziału czasu - są łączone w wynik zapytania. Czujniki są
+ * niezależne, więc czas zapytania maleje niemal liniowo z liczbą rdzeni.
+ * Przykłady: średnia godzinowa PM2.5 według województw albo 10 stacji
+ * o najwyższej średniej z ostatniego tygodnia.
+ */
+class QueryEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /// Sposób grupowania czujników
+    enum class GroupBy {
+        Country, // Jedna grupa dla całego kraju
+        Province, // Województwo (Station::city.province)
+        District, // Powiat (Station::city.district)
+        Station // Stacja
+    };
+
+    /**
+     * @struct Source
+     * @brief Czujnik objęty zapytaniem
+     */
+    struct Source {
+        Station station; // Stacja czujnika (pola grupowania)
+        int sensorId = 0; // ID czujnika
+        TimeSeries series; // Dane w pamięci; pusty szereg - dane zapisane w DataManager
+    };
+
+    /**
+     * @struct Query
+     * @brief Parametry zapytania
+     *
+     * Przedział [from, to] jest rozszerzany do pełnych przedziałów poziomu resolution.
+     */
+    struct Query {
+        QList<Source> sources; // Czujniki
+        QDateTime from; // Początek przedziału
+        QDateTime to; // Koniec przedziału
+        GroupBy groupBy = GroupBy::Province; // Grupowanie
+        RollupTier resolution = RollupTier::Hourly; // Poziom, z którego czytane są dane
+        bool series = false; // Czy wyznaczać szereg grupy w przedziałach resolution
+        int limit = 0; // Najwyżej tyle grup o najwyższej średniej (0 - wszystkie, według nazwy)
+    };
+
+    /**
+     * @struct Group
+     * @brief Wynik dla jednej grupy
+     */
+    struct Group {
+        QString label; // Nazwa województwa, powiatu lub stacji
+        qsizetype stations = 0; // Liczba stacji z danymi
+        RollupBucket total; // Agregat całego przedziału
+        QList<RollupBucket> series; // Agregaty kolejnych przedziałów (gdy Query::series)
+    };
+
+    /**
+     * @struct Result
+     * @brief Wynik zapytania
+     */
+    struct Result {
+        QList<Group> groups; // Grupy według średniej malejąco (z limitem) albo według nazwy
+        qsizetype sensors = 0; // Czujniki, które miały dane w przedziale
+    };
+
+    /**
+     * @brief Konstruktor klasy QueryEngine
+     * @param dataManager Menadżer danych zapisanych
+     * @param parent Wskaźnik na obiekt rodzica
+     */
+    explicit QueryEngine(DataManager *dataManager, QObject *parent = nullptr);
+
+    /**
+     * @brief Wybiera z katalogu czujniki mierzące parametr
+     * @param catalog Katalog stacji i czujników
+     * @param parameterCode Kod parametru (np. PM2.5), bez rozróżniania wielkości liter
+     * @return Czujniki z pustymi szeregami (dane z DataManager)
+     */
+    static QList<Source> sources(const StationCatalog &catalog, const QString &parameterCode);
+
+    /**
+     * @brief Uruchamia zapytanie w globalnej puli wątków
+     * @param query Parametry zapytania
+     * @return Przyszły wynik
+     */
+    QFuture<Result> run(const Query &query);
+
+private:
+
+    /**
+     * @struct GroupState
+     * @brief Częściowy agregat grupy
+     */
+    struct GroupState {
+        QString label; // Nazwa grupy
+        QSet<int> stations; // Stacje z danymi
+        RollupBucket total{0, 0, 0.0, 0.0, 0.0, 0.0}; // Agregat przedziału
+        QMap<qint64, RollupBucket> series; // Agregaty według początku przedziału
+    };
+
+    /**
+     * @struct Partial
+     * @brief Wynik częściowy - łączny dla dowolnego podzbioru czujników
+     */
+    struct Partial {
+        QHash<qint64, GroupState> groups; // Grupy według klucza (ID symbolu lub stacji)
+        qsizetype sensors = 0; // Czujniki z danymi
+    };
+
+    DataManager *dataManager; // Menadżer danych zapisanych
+
+    /// Podsumowuje jeden czujnik (etap map)
+    static Partial aggregate(DataManager *dataManager, const Query &query, const Source &source);
+
+    /// Dołącza wynik częściowy do wyniku (etap reduce)
+    static void merge(Partial &result, const Partial &partial);
+
+    /// Porządkuje grupy i stosuje limit
+    static Result finish(const Partial &partial, const Query &query);
+};
+
+#endif // QUERYENGINE_H
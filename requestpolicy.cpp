@@ -0,0 +1,132 @@
+#include "requestpolicy.h"
+#include "metrics.h"
+#include <QRandomGenerator>
+#include <algorithm>
+
+RequestPolicy::RequestPolicy(const Options &options)
+    : opts(options),
+    retryTokens(options.retryBudgetCap)
+{
+    clock.start();
+}
+
+void RequestPolicy::setOptions(const Options &options)
+{
+    opts = options;
+    retryTokens = qMin(retryTokens, opts.retryBudgetCap);
+}
+
+const RequestPolicy::LatencyWindow *RequestPolicy::percentiles(const QString &kind)
+{
+    auto it = windows.find(kind);
+    if (it == windows.end() || it->samples.size() < opts.minSamples) return nullptr;
+
+    if (it->dirty) {
+        QList<qint64> sorted = it->samples;
+        const qsizetype p95 = (sorted.size() * 95) / 100;
+        const qsizetype p99 = qMin(sorted.size() - 1, (sorted.size() * 99) / 100);
+        std::nth_element(sorted.begin(), sorted.begin() + p99, sorted.end());
+        it->p99 = sorted[p99];
+        std::nth_element(sorted.begin(), sorted.begin() + p95, sorted.begin() + p99);
+        it->p95 = p95 < p99 ? sorted[p95] : it->p99;
+        it->dirty = false;
+    }
+    return &*it;
+}
+
+int RequestPolicy::timeoutMs(const QString &kind)
+{
+    const LatencyWindow *window = percentiles(kind);
+    if (!window) return opts.maxTimeoutMs;
+    return int(qBound<qint64>(opts.minTimeoutMs, qint64(window->p99 * opts.timeoutFactor), opts.maxTimeoutMs));
+}
+
+int RequestPolicy::hedgeDelayMs(const QString &kind)
+{
+    if (!opts.hedging) return -1;
+    const LatencyWindow *window = percentiles(kind);
+    if (!window) return -1;
+    return int(qMax<qint64>(opts.minHedgeDelayMs, window->p95));
+}
+
+int RequestPolicy::backoffMs(int attempt) const
+{
+    const int exponent = qBound(0, attempt - 1, 20);
+    const qint64 ceiling = qMin<qint64>(opts.maxBackoffMs, qint64(opts.baseBackoffMs) << exponent);
+    // Pełny losowy rozrzut - ponowienia wielu klientów nie trafiają do serwera jednocześnie
+    return int(QRandomGenerator::global()->bounded(ceiling + 1));
+}
+
+void RequestPolicy::recordLatency(const QString &kind, qint64 elapsedMs)
+{
+    LatencyWindow &window = windows[kind];
+    if (window.samples.size() < WindowSize) {
+        window.samples.append(elapsedMs);
+    } else {
+        window.samples[window.next] = elapsedMs;
+        window.next = (window.next + 1) % WindowSize;
+    }
+    window.dirty = true;
+}
+
+void RequestPolicy::recordRequest()
+{
+    retryTokens = qMin(opts.retryBudgetCap, retryTokens + opts.retryBudgetRatio);
+}
+
+bool RequestPolicy::tryAcquireRetry()
+{
+    if (retryTokens < 1.0) return false;
+    retryTokens -= 1.0;
+    return true;
+}
+
+bool RequestPolicy::allowRequest()
+{
+    switch (state) {
+    case BreakerState::Closed:
+        return true;
+    case BreakerState::Open:
+        if (clock.elapsed() - openedAtMs < opts.breakerOpenMs) return false;
+        setState(BreakerState::HalfOpen);
+        openedAtMs = clock.elapsed();
+        return true; // Żądanie próbne
+    case BreakerState::HalfOpen:
+        // Żądanie próbne bez odpowiedzi (np. anulowane) nie blokuje bezpiecznika na zawsze
+        if (clock.elapsed() - openedAtMs < opts.breakerOpenMs) return false;
+        openedAtMs = clock.elapsed();
+        return true;
+    }
+    return true;
+}
+
+void RequestPolicy::recordSuccess()
+{
+    consecutiveFailures = 0;
+    if (state != BreakerState::Closed) {
+        setState(BreakerState::Closed);
+    }
+}
+
+void RequestPolicy::recordFailure()
+{
+    ++consecutiveFailures;
+    const bool trip = state == BreakerState::HalfOpen
+                      || (opts.breakerThreshold > 0 && consecutiveFailures >= opts.breakerThreshold);
+    if (trip) {
+        if (state != BreakerState::Open) {
+            qWarning("API circuit breaker opened after %d consecutive failures", consecutiveFailures);
+        }
+        setState(BreakerState::Open);
+        openedAtMs = clock.elapsed();
+    }
+}
+
+void RequestPolicy::setState(BreakerState newState)
+{
+    state = newState;
+    if (Metrics::enabled()) {
+        static Metrics::Gauge &gauge = Metrics::instance().gauge("pogoda_circuit_breaker_state");
+        gauge.set(int(state));
+    }
+}
@@ -0,0 +1,156 @@
+/**
+ * @file requestpolicy.h
+ * @brief Definicja klasy RequestPolicy - adaptacyjnych limitów czasu, ponowień i bezpiecznika żądań API
+ */
+#ifndef REQUESTPOLICY_H
+#define REQUESTPOLICY_H
+
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QElapsedTimer>
+
+/**
+ * @class RequestPolicy
+ * @brief Decyzje o limitach czasu, żądaniach zabezpieczających, ponowieniach i bezpieczniku
+ *
+ * Dla każdego rodzaju endpointu przechowywane jest okno ostatnich czasów
+ * odpowiedzi. Limit czasu to P99 okna pomnożony przez stały współczynnik,
+ * a żądanie zabezpieczające (hedge) jest wysyłane, gdy odpowiedź nie nadeszła
+ * w czasie P95. Ponowienia czekają wykładniczo rosnący, losowy czas (full jitter).
+ * Ponowienia i żądania zabezpieczające pobierają żetony z budżetu zasilanego
+ * ułamkiem zwykłych żądań, więc przy awarii serwera ruch rośnie najwyżej o ten
+ * ułamek. Bezpiecznik (circuit breaker) po serii błędów przestaje wysyłać
+ * żądania, a po czasie przepuszcza jedno żądanie próbne.
+ *
+ * Obiekt nie jest bezpieczny wątkowo - ApiClient używa go tylko w swoim wątku.
+ */
+class RequestPolicy
+{
+public:
+
+    /**
+     * @struct Options
+     * @brief Parametry polityki
+     */
+    struct Options {
+        int minTimeoutMs = 2000; // Dolna granica adaptacyjnego limitu czasu
+        int maxTimeoutMs = 10000; // Górna granica i limit przed zebraniem minSamples próbek
+        double timeoutFactor = 3.0; // Limit czasu = P99 * timeoutFactor
+        bool hedging = true; // Czy wysyłać żądania zabezpieczające po P95
+        int minHedgeDelayMs = 50; // Najkrótsze opóźnienie żądania zabezpieczającego
+        int minSamples = 20; // Liczba próbek, od której percentyle są używane
+        int maxAttempts = 3; // Liczba prób żądania (pierwsza i ponowienia)
+        int baseBackoffMs = 250; // Podstawa opóźnienia ponowienia
+        int maxBackoffMs = 8000; // Górna granica opóźnienia ponowienia
+        double retryBudgetRatio = 0.1; // Żetony budżetu ponowień dodawane za każde żądanie
+        double retryBudgetCap = 10.0; // Pojemność budżetu ponowień
+        int breakerThreshold = 5; // Kolejne błędy otwierające bezpiecznik (0 - wyłączony)
+        int breakerOpenMs = 30000; // Czas otwarcia bezpiecznika przed żądaniem próbnym
+    };
+
+    /// Stan bezpiecznika
+    enum class BreakerState {
+        Closed, // Żądania są wysyłane normalnie
+        Open, // Żądania są odrzucane bez wysyłania
+        HalfOpen // Wysłano jedno żądanie próbne
+    };
+
+    /**
+     * @brief Konstruktor klasy RequestPolicy
+     * @param options Parametry polityki
+     */
+    explicit RequestPolicy(const Options &options = Options());
+
+    /**
+     * @brief Zmienia parametry polityki (zebrane czasy odpowiedzi są zachowywane)
+     * @param options Parametry polityki
+     */
+    void setOptions(const Options &options);
+
+    /// Zwraca parametry polityki
+    const Options &options() const { return opts; }
+
+    /**
+     * @brief Zwraca limit czasu żądania
+     * @param kind Rodzaj endpointu
+     * @return Limit w milisekundach
+     */
+    int timeoutMs(const QString &kind);
+
+    /**
+     * @brief Zwraca opóźnienie żądania zabezpieczającego
+     * @param kind Rodzaj endpointu
+     * @return Opóźnienie w milisekundach albo -1, jeśli żądanie nie ma być wysyłane
+     */
+    int hedgeDelayMs(const QString &kind);
+
+    /**
+     * @brief Zwraca losowe opóźnienie ponowienia
+     * @param attempt Numer ponowienia (od 1)
+     * @return Opóźnienie z przedziału [0, min(maxBackoffMs, baseBackoffMs * 2^(attempt-1))]
+     */
+    int backoffMs(int attempt) const;
+
+    /**
+     * @brief Zapisuje czas odpowiedzi (także próby przerwanej po limicie czasu)
+     * @param kind Rodzaj endpointu
+     * @param elapsedMs Czas w milisekundach
+     */
+    void recordLatency(const QString &kind, qint64 elapsedMs);
+
+    /// Zasila budżet ponowień nowym żądaniem
+    void recordRequest();
+
+    /**
+     * @brief Pobiera żeton z budżetu ponowień
+     * @return true, jeśli ponowienie lub żądanie zabezpieczające może zostać wysłane
+     */
+    bool tryAcquireRetry();
+
+    /**
+     * @brief Sprawdza bezpiecznik przed wysłaniem żądania
+     * @return true, jeśli żądanie może zostać wysłane
+     */
+    bool allowRequest();
+
+    /// Zapisuje odpowiedź serwera (zamyka bezpiecznik)
+    void recordSuccess();
+
+    /// Zapisuje błąd serwera lub sieci
+    void recordFailure();
+
+    /// Zwraca stan bezpiecznika
+    BreakerState breakerState() const { return state; }
+
+private:
+
+    /**
+     * @struct LatencyWindow
+     * @brief Okno ostatnich czasów odpowiedzi endpointu z buforowanymi percentylami
+     */
+    struct LatencyWindow {
+        QList<qint64> samples; // Bufor cykliczny
+        qsizetype next = 0; // Pozycja kolejnego zapisu
+        bool dirty = false; // Czy percentyle wymagają przeliczenia
+        qint64 p95 = 0;
+        qint64 p99 = 0;
+    };
+
+    static constexpr qsizetype WindowSize = 256;
+
+    Options opts; // Parametry
+    QHash<QString, LatencyWindow> windows; // Okna według rodzaju endpointu
+    double retryTokens = 0.0; // Budżet ponowień
+    BreakerState state = BreakerState::Closed; // Stan bezpiecznika
+    int consecutiveFailures = 0; // Kolejne błędy
+    qint64 openedAtMs = 0; // Chwila otwarcia bezpiecznika lub wysłania żądania próbnego
+    QElapsedTimer clock; // Zegar bezpiecznika
+
+    /// Zwraca okno z aktualnymi percentylami albo nullptr przy zbyt małej liczbie próbek
+    const LatencyWindow *percentiles(const QString &kind);
+
+    void setState(BreakerState newState);
+};
+
+#endif // REQUESTPOLICY_H
@@ -0,0 +1,226 @@
+#include "responsecache.h"
+#include <QFile>
+#include <QDir>
+#include <QDataStream>
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+constexpr quint32 CacheMagic = 0x50474843; // "PGHC"
+constexpr quint32 CacheVersion = 2; // 2: kluczem jest bazowy URL + endpoint
+constexpr qint64 FetchedAtOffset = 8; // Pozycja pola fetchedAt w nagłówku pliku
+constexpr qint64 Minute = 60 * 1000;
+constexpr qint64 Hour = 60 * Minute;
+constexpr qint64 Day = 24 * Hour;
+constexpr qint64 DefaultMaxBytes = 64 * 1024 * 1024;
+constexpr int HotBodiesBytes = 16 * 1024 * 1024;
+}
+
+ResponseCache::ResponseCache(QObject *parent)
+    : ResponseCache(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/pogoda_http",
+                    DefaultMaxBytes, parent)
+{
+}
+
+ResponseCache::ResponseCache(const QString &directory, qint64 maxBytes, QObject *parent)
+    : QObject(parent),
+    directory(directory),
+    maxBytes(maxBytes),
+    hotBodies(HotBodiesBytes)
+{
+    QDir().mkpath(directory);
+    loadIndex();
+}
+
+ResponseCache::Policy ResponseCache::policyFor(const QString &endpoint)
+{
+    // Katalog stacji i czujników zmienia się rzadko, dane pomiarowe co godzinę
+    if (endpoint.startsWith("/station/")) {
+        return {Day, 30 * Day};
+    }
+    if (endpoint.startsWith("/data/getData/") || endpoint.startsWith("/aqindex/getIndex/")) {
+        return {15 * Minute, 2 * Hour};
+    }
+    return {0, 0};
+}
+
+ResponseCache::Lookup ResponseCache::lookup(const QString &baseUrl, const QString &endpoint)
+{
+    Lookup result;
+    const Policy policy = policyFor(endpoint);
+    if (policy.ttlMs == 0) return result;
+
+    const QString url = baseUrl + endpoint;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    Meta meta;
+    {
+        QMutexLocker locker(&mutex);
+        auto it = index.find(url);
+        if (it == index.end()) return result;
+        it->lastAccess = now;
+        meta = *it;
+        if (QByteArray *hot = hotBodies.object(url)) {
+            result.body = *hot;
+        }
+    }
+
+    if (result.body.isEmpty()) {
+        // Plik jest czytany bez blokady - zapisy i inne wyszukiwania nie czekają na dysk
+        QFile file(directory + "/" + meta.fileName);
+        bool valid = file.open(QIODevice::ReadOnly);
+        if (valid) {
+            QDataStream in(&file);
+            quint32 magic, version;
+            qint64 fetchedAt;
+            QString storedUrl;
+            QByteArray etag, lastModified;
+            in >> magic >> version >> fetchedAt >> storedUrl >> etag >> lastModified >> result.body;
+            valid = in.status() == QDataStream::Ok && storedUrl == url;
+            if (!valid) {
+                qWarning() << "Corrupted cache entry:" << file.fileName();
+            }
+        }
+        file.close();
+
+        QMutexLocker locker(&mutex);
+        auto it = index.find(url);
+        // Wpis mógł zostać w tym czasie zapisany na nowo - wtedy wynik odczytu nie dotyczy indeksu
+        const bool unchanged = it != index.end() && it->fetchedAt == meta.fetchedAt;
+        if (!valid) {
+            if (unchanged) {
+                if (file.exists()) file.remove();
+                totalBytes -= it->size;
+                index.erase(it);
+            }
+            return Lookup();
+        }
+        if (unchanged) {
+            hotBodies.insert(url, new QByteArray(result.body), result.body.size());
+        }
+    }
+
+    const qint64 age = now - meta.fetchedAt;
+    result.etag = meta.etag;
+    result.lastModified = meta.lastModified;
+    if (age < policy.ttlMs) {
+        result.freshness = Freshness::Fresh;
+    } else if (age < policy.ttlMs + policy.staleMs) {
+        result.freshness = Freshness::Stale;
+    } else {
+        result.freshness = Freshness::Expired;
+    }
+    return result;
+}
+
+void ResponseCache::store(const QString &baseUrl, const QString &endpoint, const QByteArray &body,
+                          const QByteArray &etag, const QByteArray &lastModified)
+{
+    if (policyFor(endpoint).ttlMs == 0 || body.isEmpty()) return;
+
+    const QString url = baseUrl + endpoint;
+    QMutexLocker locker(&mutex);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const QString fileName = fileNameFor(url);
+
+    // Zapis do pliku tymczasowego i podmiana, aby nie zostawić uszkodzonego wpisu
+    QFile file(directory + "/" + fileName + ".tmp");
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not open cache file for writing:" << file.fileName();
+        return;
+    }
+    QDataStream out(&file);
+    out << CacheMagic << CacheVersion << now << url << etag << lastModified << body;
+    const qint64 size = file.size();
+    file.close();
+
+    const QString finalPath = directory + "/" + fileName;
+    QFile::remove(finalPath);
+    if (!file.rename(finalPath)) {
+        qWarning() << "Could not replace cache file:" << finalPath;
+        file.remove();
+        return;
+    }
+
+    Meta &meta = index[url];
+    totalBytes += size - meta.size;
+    meta.fileName = fileName;
+    meta.etag = etag;
+    meta.lastModified = lastModified;
+    meta.fetchedAt = now;
+    meta.lastAccess = now;
+    meta.size = size;
+    hotBodies.insert(url, new QByteArray(body), body.size());
+
+    evict();
+}
+
+void ResponseCache::refresh(const QString &baseUrl, const QString &endpoint)
+{
+    QMutexLocker locker(&mutex);
+    auto it = index.find(baseUrl + endpoint);
+    if (it == index.end()) return;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QFile file(directory + "/" + it->fileName);
+    if (file.open(QIODevice::ReadWrite) && file.seek(FetchedAtOffset)) {
+        QDataStream out(&file);
+        out << now;
+    }
+    it->fetchedAt = now;
+    it->lastAccess = now;
+}
+
+void ResponseCache::loadIndex()
+{
+    const QStringList files = QDir(directory).entryList({"*.bin"}, QDir::Files);
+    for (const QString &fileName : files) {
+        QFile file(directory + "/" + fileName);
+        if (!file.open(QIODevice::ReadOnly)) continue;
+
+        QDataStream in(&file);
+        quint32 magic, version;
+        Meta meta;
+        QString url;
+        in >> magic >> version >> meta.fetchedAt >> url >> meta.etag >> meta.lastModified;
+        if (in.status() != QDataStream::Ok || magic != CacheMagic || version != CacheVersion) {
+            file.remove();
+            continue;
+        }
+        meta.fileName = fileName;
+        meta.lastAccess = meta.fetchedAt;
+        meta.size = file.size();
+        totalBytes += meta.size;
+        index.insert(url, meta);
+    }
+    evict();
+}
+
+void ResponseCache::evict()
+{
+    if (totalBytes <= maxBytes) return;
+
+    QList<QString> byAccess = index.keys();
+    std::sort(byAccess.begin(), byAccess.end(), [this](const QString &a, const QString &b) {
+        return index.value(a).lastAccess < index.value(b).lastAccess;
+    });
+
+    // Usuwanie do 90% limitu, aby nie sprzątać przy każdym zapisie
+    const qint64 target = maxBytes * 9 / 10;
+    for (const QString &url : byAccess) {
+        if (totalBytes <= target) break;
+        const Meta meta = index.take(url);
+        QFile::remove(directory + "/" + meta.fileName);
+        hotBodies.remove(url);
+        totalBytes -= meta.size;
+    }
+}
+
+QString ResponseCache::fileNameFor(const QString &url)
+{
+    return QString::fromLatin1(QCryptographicHash::hash(url.toUtf8(),
+                                                        QCryptographicHash::Sha1).toHex()) + ".bin";
+}
@@ -0,0 +1,145 @@
+/**
+ * @file responsecache.h
+ * @brief Definicja klasy ResponseCache - dyskowej pamięci podręcznej odpowiedzi API
+ */
+#ifndef RESPONSECACHE_H
+#define RESPONSECACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QCache>
+#include <QMutex>
+
+/**
+ * @class ResponseCache
+ * @brief Trwała pamięć podręczna odpowiedzi HTTP z rewalidacją warunkową
+ *
+ * Każdy endpoint jest zapisywany w osobnym pliku (nagłówek z metadanymi + treść).
+ * Kluczem wpisu jest bazowy URL wraz z endpointem, więc odpowiedzi różnych
+ * serwerów (np. GIOŚ i symulatora pogoda_sim) nie mieszają się ze sobą.
+ * Czas ważności zależy od klasy endpointu, po jego upływie odpowiedź może być
+ * jeszcze serwowana jako nieaktualna (stale-while-revalidate), a odświeżenie
+ * korzysta z nagłówków ETag/Last-Modified. Rozmiar jest ograniczony, a najdawniej
+ * używane wpisy są usuwane (LRU). Najczęściej używane treści są trzymane w pamięci.
+ */
+class ResponseCache : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @enum Freshness
+     * @brief Stan wpisu w pamięci podręcznej
+     */
+    enum class Freshness {
+        Missing, ///< Brak wpisu
+        Fresh,   ///< Wpis aktualny - można go użyć bez sieci
+        Stale,   ///< Wpis nieaktualny, ale może zostać użyty w trakcie odświeżania
+        Expired  ///< Wpis przeterminowany - wymaga rewalidacji przed użyciem
+    };
+
+    /**
+     * @struct Lookup
+     * @brief Wynik wyszukiwania w pamięci podręcznej
+     */
+    struct Lookup {
+        Freshness freshness = Freshness::Missing; // Stan wpisu
+        QByteArray body; // Treść odpowiedzi
+        QByteArray etag; // Nagłówek ETag
+        QByteArray lastModified; // Nagłówek Last-Modified
+    };
+
+    /**
+     * @struct Policy
+     * @brief Polityka ważności dla klasy endpointów
+     */
+    struct Policy {
+        qint64 ttlMs; // Czas, przez który odpowiedź jest aktualna
+        qint64 staleMs; // Dodatkowy czas, w którym można serwować nieaktualną odpowiedź
+    };
+
+    /**
+     * @brief Konstruktor z domyślną lokalizacją i rozmiarem
+     * @param parent Wskaźnik na obiekt rodzica
+     */
+    explicit ResponseCache(QObject *parent = nullptr);
+
+    /**
+     * @brief Konstruktor klasy ResponseCache
+     * @param directory Katalog z plikami pamięci podręcznej
+     * @param maxBytes Maksymalny łączny rozmiar plików
+     * @param parent Wskaźnik na obiekt rodzica
+     */
+    ResponseCache(const QString &directory, qint64 maxBytes, QObject *parent = nullptr);
+
+    /**
+     * @brief Wyszukuje odpowiedź dla endpointu
+     *
+     * Treść spoza pamięci jest czytana z pliku (bez blokady indeksu), dlatego
+     * metodę należy wywoływać poza wątkiem GUI - ApiClient robi to w puli wątków.
+     * @param baseUrl Bazowy URL API
+     * @param endpoint Endpoint API
+     * @return Wynik wyszukiwania wraz ze stanem aktualności
+     */
+    Lookup lookup(const QString &baseUrl, const QString &endpoint);
+
+    /**
+     * @brief Zapisuje odpowiedź dla endpointu
+     * @param baseUrl Bazowy URL API
+     * @param endpoint Endpoint API
+     * @param body Treść odpowiedzi
+     * @param etag Nagłówek ETag (może być pusty)
+     * @param lastModified Nagłówek Last-Modified (może być pusty)
+     */
+    void store(const QString &baseUrl, const QString &endpoint, const QByteArray &body,
+               const QByteArray &etag, const QByteArray &lastModified);
+
+    /**
+     * @brief Odnawia ważność wpisu po odpowiedzi 304 Not Modified
+     * @param baseUrl Bazowy URL API
+     * @param endpoint Endpoint API
+     */
+    void refresh(const QString &baseUrl, const QString &endpoint);
+
+    /**
+     * @brief Zwraca politykę ważności dla endpointu
+     * @param endpoint Endpoint API
+     * @return Polityka ważności (ttlMs == 0 oznacza brak buforowania)
+     */
+    static Policy policyFor(const QString &endpoint);
+
+private:
+    /**
+     * @struct Meta
+     * @brief Metadane wpisu trzymane w pamięci
+     */
+    struct Meta {
+        QString fileName; // Nazwa pliku wpisu
+        QByteArray etag; // Nagłówek ETag
+        QByteArray lastModified; // Nagłówek Last-Modified
+        qint64 fetchedAt = 0; // Czas pobrania/rewalidacji (ms od epoki)
+        qint64 lastAccess = 0; // Czas ostatniego użycia (ms od epoki)
+        qint64 size = 0; // Rozmiar pliku
+    };
+
+    QString directory; // Katalog pamięci podręcznej
+    qint64 maxBytes; // Limit rozmiaru na dysku
+    qint64 totalBytes = 0; // Aktualny rozmiar na dysku
+    QHash<QString, Meta> index; // Indeks adres (bazowy URL + endpoint) -> metadane
+    QCache<QString, QByteArray> hotBodies; // Treści trzymane w pamięci
+    QMutex mutex; // Ochrona indeksu
+
+    /// Wczytuje nagłówki istniejących plików do indeksu
+    void loadIndex();
+
+    /// Usuwa najdawniej używane wpisy aż do zejścia poniżej limitu
+    void evict();
+
+    /// Zwraca nazwę pliku dla adresu (bazowy URL + endpoint)
+    static QString fileNameFor(const QString &url);
+};
+
+#endif // RESPONSECACHE_H
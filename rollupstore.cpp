@@ -0,0 +1,324 @@
+#include "rollupstore.h"
+#include "segmentstore.h"
+#include "metrics.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+constexpr quint32 RollupMagic = 0x55524750; // "PGRU"
+constexpr quint16 RollupVersion = 1;
+constexpr qint64 HourMs = 3600 * 1000;
+constexpr qint64 DayMs = 24 * HourMs;
+
+/**
+ * @struct RollupHeader
+ * @brief Nagłówek pliku agregatów (32 bajty); za nim RollupBucket[count]
+ */
+struct RollupHeader {
+    quint32 magic; // Sygnatura "PGRU"
+    quint16 version; // Wersja formatu
+    quint16 tier; // Poziom agregacji (RollupTier)
+    qint64 count; // Liczba agregatów
+    quint32 payloadChecksum; // Suma kontrolna agregatów
+    quint32 headerChecksum; // Suma kontrolna poprzednich pól nagłówka
+    quint64 reserved; // Zarezerwowane
+};
+static_assert(sizeof(RollupHeader) == 32, "RollupHeader must stay 32 bytes");
+
+quint32 checksum(const void *data, qsizetype size)
+{
+    return qChecksum(QByteArrayView(static_cast<const char *>(data), size), Qt::ChecksumIso3309);
+}
+
+QString tierPath(const QString &directory, RollupTier tier)
+{
+    return directory + (tier == RollupTier::Monthly ? "/rollup_monthly.bin" : "/rollup_daily.bin");
+}
+
+bool startsBefore(const RollupBucket &bucket, qint64 startMs)
+{
+    return bucket.startMs < startMs;
+}
+
+}
+
+RollupStore::RollupStore(SegmentStore *store, QObject *parent)
+    : QObject(parent),
+    store(store)
+{
+}
+
+void RollupStore::update(int stationId, int sensorId, const TimeSeries &changed)
+{
+    if (changed.isEmpty()) return;
+
+    static Metrics::Histogram &duration =
+        Metrics::instance().histogram("pogoda_rollup_seconds", "function=\"update\"");
+    Metrics::ScopedTimer timer(duration);
+
+    const QString directory = store->sensorDirectory(stationId, sensorId);
+    QMutexLocker locker(&mutex);
+    bool rebuilt = false;
+    Tiers &tiers = tiersFor(stationId, sensorId, directory, rebuilt);
+    if (rebuilt) return; // Pełna historia zawiera już zmienione próbki
+
+    QSet<qint64> days;
+    for (qsizetype i = 0; i < changed.size(); ++i) {
+        days.insert(bucketStart(RollupTier::Daily, changed.timestampAt(i)));
+    }
+    QList<qint64> sortedDays(days.cbegin(), days.cend());
+    std::sort(sortedDays.begin(), sortedDays.end());
+
+    // Doba jest liczona od nowa z magazynu - korekta zastępuje starą wartość, a nie jest do niej dodawana
+    QSet<qint64> months;
+    for (qint64 day : sortedDays) {
+        const TimeSeries samples = store->load(stationId, sensorId, day, nextBucket(RollupTier::Daily, day) - 1);
+        replace(tiers.daily, summarize(day, samples, 0, samples.size()));
+        months.insert(bucketStart(RollupTier::Monthly, day));
+    }
+    for (qint64 month : months) {
+        const auto first = std::lower_bound(tiers.daily.cbegin(), tiers.daily.cend(), month, startsBefore);
+        const auto last = std::lower_bound(first, tiers.daily.cend(),
+                                           nextBucket(RollupTier::Monthly, month), startsBefore);
+        replace(tiers.monthly, combine(month, tiers.daily, first - tiers.daily.cbegin(), last - tiers.daily.cbegin()));
+    }
+
+    writeTier(tierPath(directory, RollupTier::Daily), RollupTier::Daily, tiers.daily);
+    writeTier(tierPath(directory, RollupTier::Monthly), RollupTier::Monthly, tiers.monthly);
+
+    if (Metrics::enabled()) {
+        static Metrics::Counter &recomputed = Metrics::instance().counter("pogoda_rollup_buckets_recomputed_total");
+        recomputed.add(quint64(days.size() + months.size()));
+    }
+}
+
+QList<RollupBucket> RollupStore::buckets(int stationId, int sensorId, RollupTier tier, qint64 fromMs, qint64 toMs)
+{
+    const QString directory = store->sensorDirectory(stationId, sensorId);
+    {
+        QMutexLocker locker(&mutex);
+        auto it = cache.constFind(directory);
+        if (it != cache.constEnd()) return slice(*it, tier, fromMs, toMs);
+    }
+
+    // Wczytanie poza blokadą - równoległe zapytania o różne czujniki nie czekają na siebie
+    bool rebuilt = false;
+    const Tiers tiers = loadTiers(stationId, sensorId, directory, rebuilt);
+    QMutexLocker locker(&mutex);
+    return slice(adopt(directory, tiers, rebuilt), tier, fromMs, toMs);
+}
+
+qint64 RollupStore::bucketStart(RollupTier tier, qint64 timestampMs)
+{
+    if (tier == RollupTier::Hourly) {
+        return timestampMs - ((timestampMs % HourMs) + HourMs) % HourMs;
+    }
+    const QDate date = QDateTime::fromMSecsSinceEpoch(timestampMs).date();
+    if (tier == RollupTier::Daily) {
+        return date.startOfDay().toMSecsSinceEpoch();
+    }
+    return QDate(date.year(), date.month(), 1).startOfDay().toMSecsSinceEpoch();
+}
+
+qint64 RollupStore::nextBucket(RollupTier tier, qint64 startMs)
+{
+    if (tier == RollupTier::Hourly) return startMs + HourMs;
+    // Przez datę, a nie stały krok - doba przy zmianie czasu ma 23 albo 25 godzin
+    const QDate date = QDateTime::fromMSecsSinceEpoch(startMs).date();
+    return (tier == RollupTier::Daily ? date.addDays(1) : date.addMonths(1)).startOfDay().toMSecsSinceEpoch();
+}
+
+RollupTier RollupStore::tierFor(qint64 fromMs, qint64 toMs, qsizetype maxPoints)
+{
+    const qint64 span = qMax<qint64>(0, toMs - fromMs);
+    if (span / HourMs + 1 <= maxPoints) return RollupTier::Hourly;
+    if (span / DayMs + 1 <= maxPoints) return RollupTier::Daily;
+    return RollupTier::Monthly;
+}
+
+RollupBucket RollupStore::summarize(qint64 startMs, const TimeSeries &samples, qsizetype first, qsizetype last)
+{
+    RollupBucket bucket{startMs, 0, 0.0, std::numeric_limits<double>::quiet_NaN(),
+                        std::numeric_limits<double>::quiet_NaN(), 0.0};
+    for (qsizetype i = first; i < last; ++i) {
+        if (!samples.isValid(i)) continue;
+        const double value = samples.valueAt(i);
+        bucket.min = bucket.count == 0 ? value : qMin(bucket.min, value);
+        bucket.max = bucket.count == 0 ? value : qMax(bucket.max, value);
+        bucket.sum += value;
+        bucket.sumSquares += value * value;
+        ++bucket.count;
+    }
+    return bucket;
+}
+
+QList<RollupBucket> RollupStore::bucketize(const TimeSeries &series, RollupTier tier, qint64 fromMs, qint64 toMs)
+{
+    QList<RollupBucket> buckets;
+    const qint64 *timestamps = series.timestamps();
+    qsizetype first = std::lower_bound(timestamps, timestamps + series.size(), fromMs) - timestamps;
+    const qsizetype end = std::upper_bound(timestamps, timestamps + series.size(), toMs) - timestamps;
+    while (first < end) {
+        const qint64 start = bucketStart(tier, timestamps[first]);
+        const qint64 next = nextBucket(tier, start);
+        qsizetype last = first;
+        while (last < end && timestamps[last] < next) ++last;
+        const RollupBucket bucket = summarize(start, series, first, last);
+        if (bucket.count > 0) buckets.append(bucket);
+        first = last;
+    }
+    return buckets;
+}
+
+RollupBucket RollupStore::combine(qint64 startMs, const QList<RollupBucket> &daily, qsizetype first, qsizetype last)
+{
+    RollupBucket bucket{startMs, 0, 0.0, std::numeric_limits<double>::quiet_NaN(),
+                        std::numeric_limits<double>::quiet_NaN(), 0.0};
+    for (qsizetype i = first; i < last; ++i) {
+        bucket.add(daily[i]);
+    }
+    return bucket;
+}
+
+void RollupStore::replace(QList<RollupBucket> &list, const RollupBucket &bucket)
+{
+    auto it = std::lower_bound(list.begin(), list.end(), bucket.startMs, startsBefore);
+    const bool exists = it != list.end() && it->startMs == bucket.startMs;
+    if (bucket.count == 0) {
+        if (exists) list.erase(it);
+    } else if (exists) {
+        *it = bucket;
+    } else {
+        list.insert(it, bucket);
+    }
+}
+
+RollupStore::Tiers RollupStore::build(const TimeSeries &samples)
+{
+    Tiers tiers;
+    qsizetype first = 0;
+    while (first < samples.size()) {
+        const qint64 day = bucketStart(RollupTier::Daily, samples.timestampAt(first));
+        const qint64 next = nextBucket(RollupTier::Daily, day);
+        qsizetype last = first;
+        while (last < samples.size() && samples.timestampAt(last) < next) ++last;
+        const RollupBucket bucket = summarize(day, samples, first, last);
+        if (bucket.count > 0) tiers.daily.append(bucket);
+        first = last;
+    }
+
+    qsizetype day = 0;
+    while (day < tiers.daily.size()) {
+        const qint64 month = bucketStart(RollupTier::Monthly, tiers.daily[day].startMs);
+        const qint64 next = nextBucket(RollupTier::Monthly, month);
+        qsizetype last = day;
+        while (last < tiers.daily.size() && tiers.daily[last].startMs < next) ++last;
+        tiers.monthly.append(combine(month, tiers.daily, day, last));
+        day = last;
+    }
+    return tiers;
+}
+
+RollupStore::Tiers &RollupStore::tiersFor(int stationId, int sensorId, const QString &directory, bool &rebuilt)
+{
+    rebuilt = false;
+    auto it = cache.find(directory);
+    if (it != cache.end()) return *it;
+    return adopt(directory, loadTiers(stationId, sensorId, directory, rebuilt), rebuilt);
+}
+
+RollupStore::Tiers RollupStore::loadTiers(int stationId, int sensorId, const QString &directory, bool &rebuilt)
+{
+    rebuilt = false;
+    Tiers tiers;
+    if (readTier(tierPath(directory, RollupTier::Daily), RollupTier::Daily, tiers.daily)
+        && readTier(tierPath(directory, RollupTier::Monthly), RollupTier::Monthly, tiers.monthly)) {
+        return tiers;
+    }
+    // Brak lub uszkodzenie plików - agregaty z pełnej historii czujnika
+    rebuilt = true;
+    return build(store->load(stationId, sensorId, std::numeric_limits<qint64>::min(),
+                             std::numeric_limits<qint64>::max()));
+}
+
+RollupStore::Tiers &RollupStore::adopt(const QString &directory, const Tiers &tiers, bool rebuilt)
+{
+    // Agregaty wczytane w międzyczasie przez inny wątek (lub zaktualizowane zapisem) mają pierwszeństwo
+    auto it = cache.find(directory);
+    if (it != cache.end()) return *it;
+
+    if (rebuilt && !tiers.daily.isEmpty()) {
+        writeTier(tierPath(directory, RollupTier::Daily), RollupTier::Daily, tiers.daily);
+        writeTier(tierPath(directory, RollupTier::Monthly), RollupTier::Monthly, tiers.monthly);
+    }
+    return *cache.insert(directory, tiers);
+}
+
+QList<RollupBucket> RollupStore::slice(const Tiers &tiers, RollupTier tier, qint64 fromMs, qint64 toMs)
+{
+    const QList<RollupBucket> &list = tier == RollupTier::Monthly ? tiers.monthly : tiers.daily;
+    const auto first = std::lower_bound(list.cbegin(), list.cend(), fromMs, startsBefore);
+    const auto last = std::upper_bound(first, list.cend(), toMs, [](qint64 ms, const RollupBucket &bucket) {
+        return ms < bucket.startMs;
+    });
+    return QList<RollupBucket>(first, last);
+}
+
+bool RollupStore::readTier(const QString &path, RollupTier tier, QList<RollupBucket> &out)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    const QByteArray contents = file.readAll();
+    if (contents.size() < qsizetype(sizeof(RollupHeader))) return false;
+
+    RollupHeader header;
+    std::memcpy(&header, contents.constData(), sizeof(header));
+    const qsizetype payloadSize = contents.size() - qsizetype(sizeof(header));
+    const char *payload = contents.constData() + sizeof(header);
+    if (header.magic != RollupMagic || header.version != RollupVersion || header.tier != quint16(tier)
+        || header.headerChecksum != checksum(&header, offsetof(RollupHeader, headerChecksum))
+        || header.count < 0 || header.count * qint64(sizeof(RollupBucket)) != payloadSize
+        || header.payloadChecksum != checksum(payload, payloadSize)) {
+        qWarning() << "Ignoring damaged rollup file:" << path;
+        return false;
+    }
+
+    out.resize(qsizetype(header.count));
+    std::memcpy(out.data(), payload, payloadSize);
+    return true;
+}
+
+bool RollupStore::writeTier(const QString &path, RollupTier tier, const QList<RollupBucket> &buckets)
+{
+    const qsizetype payloadSize = buckets.size() * qsizetype(sizeof(RollupBucket));
+
+    RollupHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = RollupMagic;
+    header.version = RollupVersion;
+    header.tier = quint16(tier);
+    header.count = buckets.size();
+    header.payloadChecksum = checksum(buckets.constData(), payloadSize);
+    header.headerChecksum = checksum(&header, offsetof(RollupHeader, headerChecksum));
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not open rollup file for writing:" << path;
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(buckets.constData()), payloadSize);
+    if (!file.commit()) {
+        qWarning() << "Could not write rollup file:" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file rollupstore.h
+ * @brief Definicja klasy RollupStore - zmaterializowanych agregatów dobowych i miesięcznych
+ */
+#ifndef ROLLUPSTORE_H
+#define ROLLUPSTORE_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <cmath>
+#include <limits>
+#include "timeseries.h"
+
+class SegmentStore;
+
+/// Poziom agregacji szeregu
+enum class RollupTier {
+    Hourly, // Próbki godzinowe bez agregacji
+    Daily, // Doby (czas lokalny)
+    Monthly // Miesiące kalendarzowe (czas lokalny)
+};
+
+/**
+ * @struct RollupBucket
+ * @brief Agregat pomiarów z jednego przedziału (48 bajtów, kolejność bajtów maszyny)
+ *
+ * Pola są sumowalne, więc agregat miesiąca powstaje z agregatów dób bez
+ * wczytywania próbek, a odchylenie standardowe wynika z sumy kwadratów.
+ * Zapisywane są tylko przedziały z co najmniej jednym poprawnym pomiarem.
+ */
+struct RollupBucket {
+    qint64 startMs; // Początek przedziału (ms od epoki)
+    qint64 count; // Liczba poprawnych pomiarów
+    double sum; // Suma wartości
+    double min; // Najmniejsza wartość
+    double max; // Największa wartość
+    double sumSquares; // Suma kwadratów wartości
+
+    /// Dołącza agregat innego przedziału lub innego czujnika
+    void add(const RollupBucket &other)
+    {
+        if (other.count <= 0) return;
+        min = count == 0 ? other.min : qMin(min, other.min);
+        max = count == 0 ? other.max : qMax(max, other.max);
+        sum += other.sum;
+        sumSquares += other.sumSquares;
+        count += other.count;
+    }
+
+    /// Zwraca średnią (NaN bez pomiarów)
+    double mean() const { return count > 0 ? sum / count : std::numeric_limits<double>::quiet_NaN(); }
+
+    /// Zwraca odchylenie standardowe populacji (NaN bez pomiarów)
+    double stdDev() const
+    {
+        if (count <= 0) return std::numeric_limits<double>::quiet_NaN();
+        const double m = mean();
+        return std::sqrt(qMax(0.0, sumSquares / count - m * m));
+    }
+};
+static_assert(sizeof(RollupBucket) == 48, "RollupBucket must stay 48 bytes");
+
+/**
+ * @class RollupStore
+ * @brief Agregaty dobowe i miesięczne czujników utrzymywane przy każdym zapisie
+ *
+ * Dla każdego czujnika w jego katalogu magazynu zapisywane są dwa pliki:
+ * rollup_daily.bin i rollup_monthly.bin (posortowane tablice RollupBucket).
+ * Po zapisie nowych lub skorygowanych próbek przeliczane są tylko doby, których
+ * dotyczą (z próbek magazynu, więc korekta GIOŚ zastępuje starą wartość), a potem
+ * miesiące tych dób (z agregatów dobowych). Czujnik zapisany przed wprowadzeniem
+ * agregatów dostaje je przy pierwszym użyciu z pełnej historii.
+ */
+class RollupStore : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Konstruktor klasy RollupStore
+     * @param store Magazyn segmentów, z którego liczone są agregaty
+     * @param parent Wskaźnik na obiekt rodzica
+     */
+    explicit RollupStore(SegmentStore *store, QObject *parent = nullptr);
+
+    /**
+     * @brief Przelicza agregaty przedziałów, w których zapisano próbki
+     *
+     * Wywoływana po zapisaniu próbek w magazynie segmentów.
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     * @param changed Próbki nowe lub skorygowane
+     */
+    void update(int stationId, int sensorId, const TimeSeries &changed);
+
+    /**
+     * @brief Zwraca agregaty przedziałów zaczynających się w [fromMs, toMs]
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     * @param tier Poziom Daily lub Monthly
+     * @param fromMs Początek przedziału (ms od epoki)
+     * @param toMs Koniec przedziału (ms od epoki)
+     * @return Agregaty posortowane według czasu
+     */
+    QList<RollupBucket> buckets(int stationId, int sensorId, RollupTier tier, qint64 fromMs, qint64 toMs);
+
+    /**
+     * @brief Zwraca początek przedziału poziomu zawierającego chwilę
+     * @param tier Poziom agregacji
+     * @param timestampMs Chwila (ms od epoki)
+     * @return Początek doby lub miesiąca w czasie lokalnym (dla Hourly - pełna godzina)
+     */
+    static qint64 bucketStart(RollupTier tier, qint64 timestampMs);
+
+    /**
+     * @brief Zwraca początek następnego przedziału poziomu
+     * @param tier Poziom agregacji
+     * @param startMs Początek przedziału
+     * @return Początek kolejnej godziny, doby lub miesiąca
+     */
+    static qint64 nextBucket(RollupTier tier, qint64 startMs);
+
+    /**
+     * @brief Wybiera najdokładniejszy poziom, który mieści przedział w podanej liczbie punktów
+     * @param fromMs Początek przedziału
+     * @param toMs Koniec przedziału
+     * @param maxPoints Największa liczba punktów (np. szerokość wykresu)
+     * @return Hourly, Daily albo Monthly (gdy nawet doby się nie mieszczą)
+     */
+    static RollupTier tierFor(qint64 fromMs, qint64 toMs, qsizetype maxPoints);
+
+    /**
+     * @brief Podsumowuje próbki jako jeden przedział
+     * @param startMs Początek przedziału
+     * @param samples Próbki
+     * @param first Indeks pierwszej próbki
+     * @param last Indeks za ostatnią próbką
+     * @return Agregat (count == 0, jeśli nie ma poprawnych pomiarów)
+     */
+    static RollupBucket summarize(qint64 startMs, const TimeSeries &samples, qsizetype first, qsizetype last);
+
+    /**
+     * @brief Dzieli próbki z [fromMs, toMs] na przedziały poziomu
+     * @param series Szereg posortowany rosnąco według czasu
+     * @param tier Poziom agregacji
+     * @param fromMs Początek przedziału
+     * @param toMs Koniec przedziału
+     * @return Agregaty przedziałów z co najmniej jednym poprawnym pomiarem
+     */
+    static QList<RollupBucket> bucketize(const TimeSeries &series, RollupTier tier, qint64 fromMs, qint64 toMs);
+
+private:
+
+    /**
+     * @struct Tiers
+     * @brief Agregaty czujnika wczytane do pamięci
+     */
+    struct Tiers {
+        QList<RollupBucket> daily; // Agregaty dobowe
+        QList<RollupBucket> monthly; // Agregaty miesięczne
+    };
+
+    SegmentStore *store; // Magazyn próbek
+    QHash<QString, Tiers> cache; // Agregaty według katalogu czujnika
+    QMutex mutex; // Ochrona pamięci agregatów
+
+    /// Zwraca agregaty czujnika z pamięci, wczytując je w razie potrzeby (wymaga zablokowanego mutex)
+    Tiers &tiersFor(int stationId, int sensorId, const QString &directory, bool &rebuilt);
+
+    /// Wczytuje agregaty z plików albo buduje je z pełnej historii (rebuilt == true)
+    Tiers loadTiers(int stationId, int sensorId, const QString &directory, bool &rebuilt);
+
+    /// Umieszcza wczytane agregaty w pamięci, chyba że inny wątek zrobił to wcześniej (wymaga zablokowanego mutex)
+    Tiers &adopt(const QString &directory, const Tiers &tiers, bool rebuilt);
+
+    /// Zwraca agregaty poziomu zaczynające się w [fromMs, toMs]
+    static QList<RollupBucket> slice(const Tiers &tiers, RollupTier tier, qint64 fromMs, qint64 toMs);
+
+    /// Buduje oba poziomy z próbek
+    static Tiers build(const TimeSeries &samples);
+
+    /// Łączy agregaty dobowe z [first, last) w agregat miesiąca
+    static RollupBucket combine(qint64 startMs, const QList<RollupBucket> &daily, qsizetype first, qsizetype last);
+
+    /// Zastępuje, wstawia lub usuwa (count == 0) agregat przedziału
+    static void replace(QList<RollupBucket> &list, const RollupBucket &bucket);
+
+    /// Wczytuje i weryfikuje plik agregatów
+    static bool readTier(const QString &path, RollupTier tier, QList<RollupBucket> &out);
+
+    /// Zapisuje plik agregatów
+    static bool writeTier(const QString &path, RollupTier tier, const QList<RollupBucket> &buckets);
+};
+
+#endif // ROLLUPSTORE_H
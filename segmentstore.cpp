@@ -0,0 +1,603 @@
+#include "segmentstore.h"
+#include "columncodec.h"
+#include "metrics.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QDir>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+namespace {
+constexpr quint32 SegmentMagic = 0x47534750; // "PGSG"
+constexpr quint16 SegmentVersion = 2;
+constexpr quint16 RawSegmentVersion = 1; // Niezakodowane kolumny - tylko odczyt
+constexpr int CompactionThreshold = 8; // Liczba segmentów uruchamiająca kompaktowanie
+
+quint32 crc32(quint32 crc, const void *data, qsizetype size)
+{
+    static const std::array<quint32, 256> table = [] {
+        std::array<quint32, 256> t{};
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    const uchar *bytes = static_cast<const uchar *>(data);
+    crc = ~crc;
+    for (qsizetype i = 0; i < size; ++i) {
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+qsizetype validityWords(qint64 count)
+{
+    return qsizetype((count + 63) / 64);
+}
+
+qint64 rawPayloadSize(qint64 count)
+{
+    return count * qint64(sizeof(qint64) + sizeof(double)) + validityWords(count) * qint64(sizeof(quint64));
+}
+
+quint32 headerChecksum(const SegmentHeader &header)
+{
+    return crc32(0, &header, offsetof(SegmentHeader, headerChecksum));
+}
+
+SegmentZoneMap zoneMap(const TimeSeries &samples, qsizetype first, qsizetype last)
+{
+    SegmentZoneMap zone;
+    std::memset(&zone, 0, sizeof(zone));
+    zone.minValue = std::numeric_limits<double>::quiet_NaN();
+    zone.maxValue = std::numeric_limits<double>::quiet_NaN();
+    for (qsizetype i = first; i < last; ++i) {
+        if (!samples.isValid(i)) continue;
+        const double value = samples.valueAt(i);
+        zone.minValue = zone.validCount == 0 ? value : qMin(zone.minValue, value);
+        zone.maxValue = zone.validCount == 0 ? value : qMax(zone.maxValue, value);
+        zone.sum += value;
+        ++zone.validCount;
+    }
+    return zone;
+}
+
+void accumulate(RangeStats &stats, const TimeSeries &samples, double threshold)
+{
+    stats.count += samples.size();
+    for (qsizetype i = 0; i < samples.size(); ++i) {
+        if (!samples.isValid(i)) continue;
+        const double value = samples.valueAt(i);
+        stats.min = stats.validCount == 0 ? value : qMin(stats.min, value);
+        stats.max = stats.validCount == 0 ? value : qMax(stats.max, value);
+        stats.sum += value;
+        ++stats.validCount;
+        if (value > threshold) ++stats.aboveThreshold;
+    }
+}
+
+/// Indeks pierwszego bloku, który kończy się nie wcześniej niż fromMs (bloki są uporządkowane według czasu)
+qsizetype firstBlock(const SegmentView &view, qint64 fromMs)
+{
+    return std::partition_point(view.blocks, view.blocks + view.blockCount,
+                                [fromMs](const SegmentBlock &block) { return block.maxTimestamp < fromMs; })
+           - view.blocks;
+}
+}
+
+struct SegmentStore::MappedSegment {
+    QFile file; // Zmapowany plik
+    uchar *data = nullptr; // Początek mapowania
+    SegmentView view{}; // Widok segmentu
+    QList<SegmentBlock> rawBlocks; // Katalog bloków segmentu w wersji 1
+    QList<SegmentZoneMap> computedZones; // Mapy stref segmentu zapisanego bez nich
+    bool obsolete = false; // Segment zastąpiony przez kompaktowanie - plik jest usuwany po zwolnieniu
+
+    ~MappedSegment()
+    {
+        if (data) file.unmap(data);
+        // Czytelnicy mogą jeszcze trzymać mapowanie, więc plik znika dopiero z ostatnim odwołaniem
+        if (obsolete && !file.remove()) {
+            qWarning() << "Could not remove compacted segment:" << file.fileName();
+        }
+    }
+};
+
+SegmentStore::SegmentStore(const QString &rootDirectory, QObject *parent)
+    : QObject(parent),
+    rootDirectory(rootDirectory)
+{
+    QDir().mkpath(rootDirectory);
+    compactionPool.setMaxThreadCount(1);
+}
+
+SegmentStore::~SegmentStore()
+{
+    compactionPool.waitForDone();
+}
+
+QString SegmentStore::sensorDirectory(int stationId, int sensorId) const
+{
+    QString dirPath = QString("%1/station_%2_sensor_%3").arg(rootDirectory).arg(stationId).arg(sensorId);
+    QDir().mkpath(dirPath);
+    return dirPath;
+}
+
+bool SegmentStore::append(int stationId, int sensorId, const TimeSeries &samples)
+{
+    if (samples.isEmpty()) return true;
+
+    const QString directory = sensorDirectory(stationId, sensorId);
+    segmentsFor(directory);
+
+    quint64 sequence;
+    {
+        QMutexLocker locker(&mutex);
+        sequence = nextSequence[directory]++;
+    }
+
+    const QString path = QString("%1/%2.seg").arg(directory).arg(sequence, 16, 10, QChar('0'));
+    if (!writeSegment(path, sequence, samples)) return false;
+
+    std::shared_ptr<MappedSegment> segment = openSegment(path);
+    if (!segment) return false;
+
+    {
+        QMutexLocker locker(&mutex);
+        SegmentList &list = segments[directory];
+        auto pos = std::upper_bound(list.begin(), list.end(), sequence,
+                                    [](quint64 seq, const std::shared_ptr<MappedSegment> &s) {
+                                        return seq < s->view.header->sequence;
+                                    });
+        list.insert(pos, segment);
+    }
+    scheduleCompaction(directory);
+    return true;
+}
+
+qint64 SegmentStore::lastTimestamp(int stationId, int sensorId)
+{
+    qint64 last = std::numeric_limits<qint64>::min();
+    const SegmentList list = segmentsFor(sensorDirectory(stationId, sensorId));
+    for (const auto &segment : list) {
+        last = qMax(last, segment->view.header->maxTimestamp);
+    }
+    return last;
+}
+
+TimeSeries SegmentStore::load(int stationId, int sensorId, qint64 fromMs, qint64 toMs)
+{
+    return mergeSegments(segmentsFor(sensorDirectory(stationId, sensorId)), fromMs, toMs);
+}
+
+RangeStats SegmentStore::stats(int stationId, int sensorId, qint64 fromMs, qint64 toMs, double threshold)
+{
+    RangeStats result;
+    const SegmentList list = segmentsFor(sensorDirectory(stationId, sensorId));
+    bool disjoint = true;
+    const SegmentList overlapping = inRange(list, fromMs, toMs, disjoint);
+
+    if (!disjoint) {
+        accumulate(result, mergeSegments(list, fromMs, toMs), threshold);
+    } else {
+        for (const auto &segment : overlapping) {
+            const SegmentView &view = segment->view;
+            for (qsizetype block = firstBlock(view, fromMs);
+                 block < view.blockCount && view.blocks[block].minTimestamp <= toMs; ++block) {
+                const SegmentBlock &info = view.blocks[block];
+                const SegmentZoneMap &zone = view.zones[block];
+                const bool inside = info.minTimestamp >= fromMs && info.maxTimestamp <= toMs;
+                // Próg poza zakresem wartości bloku - liczba pomiarów powyżej progu wynika z mapy stref
+                const bool thresholdResolved = zone.validCount == 0 || !(zone.maxValue > threshold)
+                                               || zone.minValue > threshold;
+
+                if (inside && thresholdResolved) {
+                    result.count += info.count;
+                    if (zone.validCount > 0) {
+                        result.min = result.validCount == 0 ? zone.minValue : qMin(result.min, zone.minValue);
+                        result.max = result.validCount == 0 ? zone.maxValue : qMax(result.max, zone.maxValue);
+                        result.sum += zone.sum;
+                        result.validCount += zone.validCount;
+                        if (zone.minValue > threshold) result.aboveThreshold += zone.validCount;
+                    }
+                    ++result.blocksFromZoneMaps;
+                    continue;
+                }
+
+                TimeSeries samples;
+                if (!readBlock(view, block, fromMs, toMs, samples)) {
+                    qWarning() << "Skipping corrupted block in segment:" << segment->file.fileName();
+                    continue;
+                }
+                accumulate(result, samples, threshold);
+                ++result.blocksDecoded;
+            }
+        }
+    }
+
+    if (Metrics::enabled()) {
+        static Metrics::Counter &fromZoneMaps =
+            Metrics::instance().counter("pogoda_segment_blocks_total", "source=\"zonemap\"");
+        static Metrics::Counter &decoded =
+            Metrics::instance().counter("pogoda_segment_blocks_total", "source=\"decoded\"");
+        fromZoneMaps.add(quint64(result.blocksFromZoneMaps));
+        decoded.add(quint64(result.blocksDecoded));
+    }
+    return result;
+}
+
+void SegmentStore::forEachSegment(int stationId, int sensorId,
+                                  const std::function<void(const SegmentView &)> &visitor)
+{
+    const SegmentList list = segmentsFor(sensorDirectory(stationId, sensorId));
+    for (const auto &segment : list) {
+        visitor(segment->view);
+    }
+}
+
+SegmentStore::SegmentList SegmentStore::segmentsFor(const QString &directory)
+{
+    QMutexLocker locker(&mutex);
+    auto it = segments.find(directory);
+    if (it != segments.end()) return *it;
+
+    SegmentList list;
+    quint64 next = 0;
+    const QStringList files = QDir(directory).entryList({"*.seg"}, QDir::Files, QDir::Name);
+    for (const QString &fileName : files) {
+        const QString path = directory + "/" + fileName;
+        std::shared_ptr<MappedSegment> segment = openSegment(path);
+        if (!segment) {
+            qWarning() << "Skipping corrupted segment:" << path;
+            QFile::rename(path, path + ".corrupt");
+            continue;
+        }
+        // Plik po kompaktowaniu ma numer nowszy niż numer segmentu w nagłówku
+        next = qMax(next, qMax(segment->view.header->sequence, fileName.section('.', 0, 0).toULongLong()) + 1);
+        list.append(segment);
+    }
+    std::stable_sort(list.begin(), list.end(),
+                     [](const std::shared_ptr<MappedSegment> &a, const std::shared_ptr<MappedSegment> &b) {
+                         return a->view.header->sequence < b->view.header->sequence;
+                     });
+
+    segments.insert(directory, list);
+    nextSequence.insert(directory, next);
+    return list;
+}
+
+bool SegmentStore::writeSegment(const QString &path, quint64 sequence, const TimeSeries &samples)
+{
+    const qint64 count = samples.size();
+    const qsizetype blockCount = qsizetype((count + ColumnCodec::BlockSamples - 1) / ColumnCodec::BlockSamples);
+
+    QList<SegmentBlock> blocks;
+    blocks.reserve(blockCount);
+    QList<SegmentZoneMap> zones;
+    zones.reserve(blockCount);
+    QByteArray blockData;
+    for (qsizetype first = 0; first < count; first += ColumnCodec::BlockSamples) {
+        const qsizetype last = qMin<qsizetype>(first + ColumnCodec::BlockSamples, count);
+        const QByteArray encoded = ColumnCodec::encodeBlock(samples, first, last);
+
+        SegmentBlock block;
+        std::memset(&block, 0, sizeof(block));
+        block.minTimestamp = samples.timestampAt(first);
+        block.maxTimestamp = samples.timestampAt(last - 1);
+        block.offset = quint32(blockData.size());
+        block.size = quint32(encoded.size());
+        block.count = quint32(last - first);
+        blocks.append(block);
+        zones.append(zoneMap(samples, first, last));
+        blockData.append(encoded);
+    }
+    const qint64 directoryBytes = blockCount * qint64(sizeof(SegmentBlock));
+    const qint64 zoneBytes = blockCount * qint64(sizeof(SegmentZoneMap));
+
+    SegmentHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = SegmentMagic;
+    header.version = SegmentVersion;
+    header.flags = SegmentHasZoneMaps;
+    header.sequence = sequence;
+    header.count = count;
+    header.minTimestamp = samples.timestampAt(0);
+    header.maxTimestamp = samples.timestampAt(count - 1);
+    header.blockCount = quint32(blockCount);
+
+    quint32 crc = crc32(0, blocks.constData(), directoryBytes);
+    crc = crc32(crc, zones.constData(), zoneBytes);
+    header.payloadChecksum = crc32(crc, blockData.constData(), blockData.size());
+    header.headerChecksum = headerChecksum(header);
+
+    // QSaveFile zapewnia, że segment pojawi się w katalogu w całości albo wcale
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not open segment for writing:" << path;
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(blocks.constData()), directoryBytes);
+    file.write(reinterpret_cast<const char *>(zones.constData()), zoneBytes);
+    file.write(blockData);
+    if (!file.commit()) {
+        qWarning() << "Could not write segment:" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<SegmentStore::MappedSegment> SegmentStore::openSegment(const QString &path)
+{
+    auto segment = std::make_shared<MappedSegment>();
+    segment->file.setFileName(path);
+    if (!segment->file.open(QIODevice::ReadOnly)) return nullptr;
+
+    const qint64 size = segment->file.size();
+    if (size < qint64(sizeof(SegmentHeader))) return nullptr;
+
+    segment->data = segment->file.map(0, size);
+    if (!segment->data) return nullptr;
+
+    const auto *header = reinterpret_cast<const SegmentHeader *>(segment->data);
+    if (header->magic != SegmentMagic || header->headerChecksum != headerChecksum(*header) || header->count <= 0) {
+        return nullptr;
+    }
+
+    const uchar *payload = segment->data + sizeof(SegmentHeader);
+    const qint64 payloadBytes = size - qint64(sizeof(SegmentHeader));
+    segment->view.header = header;
+
+    if (header->version == RawSegmentVersion) {
+        if (payloadBytes != rawPayloadSize(header->count)
+            || crc32(0, payload, payloadBytes) != header->payloadChecksum) {
+            return nullptr;
+        }
+        segment->view.timestamps = reinterpret_cast<const qint64 *>(payload);
+        segment->view.values = reinterpret_cast<const double *>(segment->view.timestamps + header->count);
+        segment->view.validity = reinterpret_cast<const quint64 *>(segment->view.values + header->count);
+
+        // Katalog bloków nad niezakodowanymi kolumnami - odczyt przedziału działa tak samo jak w wersji 2
+        for (qint64 first = 0; first < header->count; first += ColumnCodec::BlockSamples) {
+            const qint64 last = qMin<qint64>(first + ColumnCodec::BlockSamples, header->count);
+            segment->rawBlocks.append(SegmentBlock{segment->view.timestamps[first], segment->view.timestamps[last - 1],
+                                                   quint32(first), 0, quint32(last - first), 0});
+            TimeSeries block;
+            block.appendRange(segment->view.timestamps, segment->view.values, segment->view.validity, first, last);
+            segment->computedZones.append(zoneMap(block, 0, block.size()));
+        }
+        segment->view.blocks = segment->rawBlocks.constData();
+        segment->view.zones = segment->computedZones.constData();
+        segment->view.blockCount = segment->rawBlocks.size();
+        return segment;
+    }
+
+    if (header->version != SegmentVersion || header->blockCount == 0) return nullptr;
+    const qint64 directoryBytes = qint64(header->blockCount) * qint64(sizeof(SegmentBlock));
+    if (payloadBytes < directoryBytes || crc32(0, payload, payloadBytes) != header->payloadChecksum) {
+        return nullptr;
+    }
+
+    const bool storedZones = header->flags & SegmentHasZoneMaps;
+    const qint64 zoneBytes = storedZones ? qint64(header->blockCount) * qint64(sizeof(SegmentZoneMap)) : 0;
+    if (payloadBytes < directoryBytes + zoneBytes) return nullptr;
+
+    const auto *blocks = reinterpret_cast<const SegmentBlock *>(payload);
+    const qint64 dataBytes = payloadBytes - directoryBytes - zoneBytes;
+    qint64 samples = 0;
+    for (quint32 i = 0; i < header->blockCount; ++i) {
+        const SegmentBlock &block = blocks[i];
+        if (block.count == 0 || qsizetype(block.count) > ColumnCodec::BlockSamples
+            || qint64(block.offset) + block.size > dataBytes) {
+            return nullptr;
+        }
+        samples += block.count;
+    }
+    if (samples != header->count) return nullptr;
+
+    segment->view.blocks = blocks;
+    segment->view.blockCount = header->blockCount;
+    segment->view.blockData = payload + directoryBytes + zoneBytes;
+    if (storedZones) {
+        segment->view.zones = reinterpret_cast<const SegmentZoneMap *>(payload + directoryBytes);
+        return segment;
+    }
+
+    // Segment zapisany przed wprowadzeniem map stref - wyliczane raz, przy otwarciu
+    for (qsizetype i = 0; i < segment->view.blockCount; ++i) {
+        TimeSeries block;
+        if (!ColumnCodec::decodeBlock(segment->view.blockData + blocks[i].offset, blocks[i].size, blocks[i].count, block)) {
+            return nullptr;
+        }
+        segment->computedZones.append(zoneMap(block, 0, block.size()));
+    }
+    segment->view.zones = segment->computedZones.constData();
+    return segment;
+}
+
+bool SegmentStore::readBlock(const SegmentView &view, qsizetype block, qint64 fromMs, qint64 toMs, TimeSeries &out)
+{
+    const SegmentBlock &info = view.blocks[block];
+    if (info.maxTimestamp < fromMs || info.minTimestamp > toMs) return true;
+
+    if (view.header->version == RawSegmentVersion) {
+        const qint64 *begin = view.timestamps + info.offset;
+        const qint64 *end = begin + info.count;
+        const qsizetype first = std::lower_bound(begin, end, fromMs) - view.timestamps;
+        const qsizetype last = std::upper_bound(begin, end, toMs) - view.timestamps;
+        out.appendRange(view.timestamps, view.values, view.validity, first, last);
+        return true;
+    }
+
+    const uchar *data = view.blockData + info.offset;
+    if (info.minTimestamp >= fromMs && info.maxTimestamp <= toMs) {
+        return ColumnCodec::decodeBlock(data, info.size, info.count, out);
+    }
+
+    // Blok na brzegu przedziału - dekodowany w całości, dopisywana jest tylko część
+    TimeSeries decoded;
+    if (!ColumnCodec::decodeBlock(data, info.size, info.count, decoded)) return false;
+    const qint64 *begin = decoded.timestamps();
+    const qint64 *end = begin + decoded.size();
+    out.appendRange(decoded.timestamps(), decoded.values(), decoded.validity(),
+                    std::lower_bound(begin, end, fromMs) - begin, std::upper_bound(begin, end, toMs) - begin);
+    return true;
+}
+
+SegmentStore::SegmentList SegmentStore::inRange(const SegmentList &list, qint64 fromMs, qint64 toMs, bool &disjoint)
+{
+    SegmentList overlapping;
+    for (const auto &segment : list) {
+        const SegmentHeader *header = segment->view.header;
+        if (header->maxTimestamp >= fromMs && header->minTimestamp <= toMs) {
+            overlapping.append(segment);
+        }
+    }
+
+    // Przypadek typowy - segmenty dopisywane na końcu nie nakładają się na siebie
+    SegmentList byTime = overlapping;
+    std::sort(byTime.begin(), byTime.end(), [](const auto &a, const auto &b) {
+        return a->view.header->minTimestamp < b->view.header->minTimestamp;
+    });
+    disjoint = true;
+    for (qsizetype i = 1; i < byTime.size(); ++i) {
+        if (byTime[i]->view.header->minTimestamp <= byTime[i - 1]->view.header->maxTimestamp) {
+            disjoint = false;
+            break;
+        }
+    }
+    return disjoint ? byTime : overlapping;
+}
+
+TimeSeries SegmentStore::mergeSegments(const SegmentList &list, qint64 fromMs, qint64 toMs)
+{
+    bool disjoint = true;
+    const SegmentList overlapping = inRange(list, fromMs, toMs, disjoint);
+
+    TimeSeries result;
+    if (overlapping.isEmpty()) return result;
+
+    if (disjoint) {
+        for (const auto &segment : overlapping) {
+            const SegmentView &view = segment->view;
+            for (qsizetype block = firstBlock(view, fromMs);
+                 block < view.blockCount && view.blocks[block].minTimestamp <= toMs; ++block) {
+                if (!readBlock(view, block, fromMs, toMs, result)) {
+                    qWarning() << "Skipping corrupted block in segment:" << segment->file.fileName();
+                }
+            }
+        }
+        return result;
+    }
+
+    // Segmenty nakładają się - przy tym samym czasie wygrywa nowszy segment
+    struct Sample {
+        qint64 timestamp;
+        double value;
+        bool valid;
+    };
+    QList<Sample> samples;
+    for (const auto &segment : overlapping) { // Kolejność rosnących numerów
+        const SegmentView &view = segment->view;
+        TimeSeries range;
+        for (qsizetype block = firstBlock(view, fromMs);
+             block < view.blockCount && view.blocks[block].minTimestamp <= toMs; ++block) {
+            if (!readBlock(view, block, fromMs, toMs, range)) {
+                qWarning() << "Skipping corrupted block in segment:" << segment->file.fileName();
+            }
+        }
+        for (qsizetype i = 0; i < range.size(); ++i) {
+            samples.append({range.timestampAt(i), range.valueAt(i), range.isValid(i)});
+        }
+    }
+    std::stable_sort(samples.begin(), samples.end(), [](const Sample &a, const Sample &b) {
+        return a.timestamp < b.timestamp;
+    });
+
+    result.reserve(samples.size());
+    for (qsizetype i = 0; i < samples.size(); ++i) {
+        if (i + 1 < samples.size() && samples[i + 1].timestamp == samples[i].timestamp) continue;
+        if (samples[i].valid) {
+            result.append(samples[i].timestamp, samples[i].value);
+        } else {
+            result.appendNull(samples[i].timestamp);
+        }
+    }
+    return result;
+}
+
+void SegmentStore::scheduleCompaction(const QString &directory)
+{
+    {
+        QMutexLocker locker(&mutex);
+        if (compacting.contains(directory) || segments.value(directory).size() < CompactionThreshold) {
+            return;
+        }
+        compacting.insert(directory);
+    }
+
+    compactionPool.start([this, directory]() {
+        compact(directory);
+        QMutexLocker locker(&mutex);
+        compacting.remove(directory);
+    });
+}
+
+void SegmentStore::compact(const QString &directory)
+{
+    SegmentList list = segmentsFor(directory);
+    if (list.size() < 2) return;
+
+    // Kompaktowanie warstwowe: duży segment bazowy jest przepisywany dopiero,
+    // gdy reszta urośnie do jednej czwartej jego rozmiaru
+    qint64 tailCount = 0;
+    for (qsizetype i = 1; i < list.size(); ++i) {
+        tailCount += list[i]->view.header->count;
+    }
+    SegmentList victims = list;
+    if (tailCount * 4 < list.first()->view.header->count) {
+        victims.removeFirst();
+    }
+    if (victims.size() < 2) return;
+
+    const TimeSeries merged = mergeSegments(victims, std::numeric_limits<qint64>::min(),
+                                            std::numeric_limits<qint64>::max());
+    // Scalony segment zachowuje numer najnowszego źródła (segmenty dopisane w trakcie nadal wygrywają),
+    // ale trafia do nowego pliku - zmapowanego segmentu nie można nadpisać (np. na Windows)
+    const quint64 sequence = victims.last()->view.header->sequence;
+    quint64 fileNumber;
+    {
+        QMutexLocker locker(&mutex);
+        fileNumber = nextSequence[directory]++;
+    }
+    const QString path = QString("%1/%2.seg").arg(directory).arg(fileNumber, 16, 10, QChar('0'));
+
+    if (!writeSegment(path, sequence, merged)) return;
+    std::shared_ptr<MappedSegment> segment = openSegment(path);
+    if (!segment) {
+        QFile::remove(path);
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    SegmentList &current = segments[directory];
+    for (const auto &victim : victims) {
+        current.removeOne(victim);
+        victim->obsolete = true; // Plik jest usuwany, gdy czytelnicy zwolnią mapowanie
+    }
+    auto pos = std::upper_bound(current.begin(), current.end(), sequence,
+                                [](quint64 seq, const std::shared_ptr<MappedSegment> &s) {
+                                    return seq < s->view.header->sequence;
+                                });
+    current.insert(pos, segment);
+}
@@ -0,0 +1,258 @@
+/**
+ * @file segmentstore.h
+ * @brief Definicja klasy SegmentStore - binarnego magazynu segmentów pomiarowych
+ */
+#ifndef SEGMENTSTORE_H
+#define SEGMENTSTORE_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QThreadPool>
+#include <functional>
+#include <limits>
+#include <memory>
+#include "timeseries.h"
+
+/**
+ * @struct SegmentHeader
+ * @brief Nagłówek pliku segmentu (64 bajty, kolejność bajtów maszyny)
+ *
+ * W wersji 2 za nagłówkiem znajduje się katalog bloków (SegmentBlock[blockCount]),
+ * z flagą SegmentHasZoneMaps - mapy stref bloków (SegmentZoneMap[blockCount]),
+ * a dalej dane bloków zakodowane przez ColumnCodec. W wersji 1 (nadal czytanej) za
+ * nagłówkiem znajdują się kolejno: kolumna znaczników czasu (qint64[count]),
+ * kolumna wartości (double[count]) i mapa bitowa ważności (quint64[(count + 63) / 64]).
+ * Rozmiar nagłówka jest wielokrotnością 8, więc dane w zmapowanym pliku
+ * są wyrównane i mogą być czytane bez kopiowania.
+ */
+struct SegmentHeader {
+    quint32 magic; // Sygnatura "PGSG"
+    quint16 version; // Wersja formatu
+    quint16 flags; // Flagi (SegmentHasZoneMaps)
+    quint64 sequence; // Numer kolejny segmentu - nowszy segment ma pierwszeństwo
+    qint64 count; // Liczba próbek
+    qint64 minTimestamp; // Najwcześniejszy znacznik czasu
+    qint64 maxTimestamp; // Najpóźniejszy znacznik czasu
+    quint32 payloadChecksum; // CRC-32 danych za nagłówkiem
+    quint32 headerChecksum; // CRC-32 poprzednich pól nagłówka
+    quint32 blockCount; // Liczba bloków (wersja 2)
+    quint32 reservedWord; // Zarezerwowane
+    quint64 reserved; // Zarezerwowane
+};
+static_assert(sizeof(SegmentHeader) == 64, "SegmentHeader must stay 64 bytes");
+
+/**
+ * @struct SegmentBlock
+ * @brief Wpis katalogu bloków segmentu (32 bajty)
+ *
+ * Blok obejmuje najwyżej ColumnCodec::BlockSamples kolejnych próbek, więc
+ * zapytanie o przedział dekoduje tylko bloki, które się z nim pokrywają.
+ */
+struct SegmentBlock {
+    qint64 minTimestamp; // Czas pierwszej próbki bloku
+    qint64 maxTimestamp; // Czas ostatniej próbki bloku
+    quint32 offset; // Przesunięcie danych bloku od końca katalogu (w wersji 1 - indeks pierwszej próbki)
+    quint32 size; // Rozmiar zakodowanego bloku w bajtach (w wersji 1 - 0)
+    quint32 count; // Liczba próbek
+    quint32 flags; // Flagi (zarezerwowane)
+};
+static_assert(sizeof(SegmentBlock) == 32, "SegmentBlock must stay 32 bytes");
+
+/// Flaga nagłówka: za katalogiem bloków zapisano ich mapy stref
+constexpr quint16 SegmentHasZoneMaps = 0x1;
+
+/**
+ * @struct SegmentZoneMap
+ * @brief Mapa stref bloku - podsumowanie wartości (32 bajty)
+ *
+ * Razem z zakresem czasu z SegmentBlock pozwala pominąć blok, który nie pasuje
+ * do zapytania, albo odpowiedzieć na zapytanie agregujące bez dekodowania próbek.
+ * Dla bloku bez poprawnych pomiarów minValue i maxValue są równe NaN.
+ */
+struct SegmentZoneMap {
+    double minValue; // Najmniejsza wartość
+    double maxValue; // Największa wartość
+    double sum; // Suma wartości
+    quint32 validCount; // Liczba poprawnych pomiarów
+    quint32 reserved; // Zarezerwowane
+};
+static_assert(sizeof(SegmentZoneMap) == 32, "SegmentZoneMap must stay 32 bytes");
+
+/**
+ * @struct RangeStats
+ * @brief Wynik zapytania agregującego o przedział czasu
+ */
+struct RangeStats {
+    qsizetype count = 0; // Liczba próbek (łącznie z brakującymi)
+    qsizetype validCount = 0; // Liczba poprawnych pomiarów
+    double min = std::numeric_limits<double>::quiet_NaN(); // Najmniejsza wartość
+    double max = std::numeric_limits<double>::quiet_NaN(); // Największa wartość
+    double sum = 0.0; // Suma wartości
+    qsizetype aboveThreshold = 0; // Liczba pomiarów większych od progu
+    qsizetype blocksFromZoneMaps = 0; // Bloki obsłużone bez dekodowania
+    qsizetype blocksDecoded = 0; // Bloki zdekodowane
+
+    /// Zwraca średnią (NaN bez poprawnych pomiarów)
+    double mean() const { return validCount > 0 ? sum / validCount : std::numeric_limits<double>::quiet_NaN(); }
+};
+
+/**
+ * @struct SegmentView
+ * @brief Widok segmentu zmapowanego w pamięci
+ *
+ * Segmenty w wersji 1 mają katalog bloków tworzony przy otwarciu i niezakodowane
+ * kolumny; w wersji 2 wskaźniki kolumn są puste, a bloki dekoduje SegmentStore::readBlock.
+ */
+struct SegmentView {
+    const SegmentHeader *header; // Nagłówek segmentu
+    const SegmentBlock *blocks; // Katalog bloków
+    const SegmentZoneMap *zones; // Mapy stref bloków (zapisane lub wyliczone przy otwarciu)
+    qsizetype blockCount; // Liczba bloków
+    const uchar *blockData; // Dane bloków (wersja 2)
+    const qint64 *timestamps; // Kolumna znaczników czasu (wersja 1)
+    const double *values; // Kolumna wartości (wersja 1)
+    const quint64 *validity; // Mapa bitowa ważności (wersja 1)
+};
+
+/**
+ * @class SegmentStore
+ * @brief Magazyn szeregów czasowych oparty o niezmienne, binarne segmenty
+ *
+ * Dla każdego czujnika tworzony jest katalog z plikami segmentów. Zapis dopisuje
+ * nowy, zamknięty segment z sumą kontrolną (bez przepisywania historii), a odczyt
+ * odbywa się przez QFile::map bez parsowania tekstu. Próbki są zapisywane
+ * w skompresowanych blokach (ColumnCodec) - seria godzinowa zajmuje około
+ * 2 bajtów na próbkę zamiast 16, a odczyt przedziału dekoduje tylko bloki,
+ * które się z nim pokrywają. Gdy segmentów przybywa, małe segmenty są łączone
+ * w tle w jeden większy; przy okazji segmenty w starym formacie są przepisywane
+ * do nowego.
+ */
+class SegmentStore : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Konstruktor klasy SegmentStore
+     * @param rootDirectory Katalog główny magazynu
+     * @param parent Wskaźnik na obiekt rodzica
+     */
+    explicit SegmentStore(const QString &rootDirectory, QObject *parent = nullptr);
+
+    /**
+     * @brief Destruktor - czeka na zakończenie kompaktowania
+     */
+    ~SegmentStore();
+
+    /**
+     * @brief Dopisuje nowy segment z próbkami
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     * @param samples Próbki posortowane rosnąco według czasu
+     * @return true, jeśli segment został zapisany
+     */
+    bool append(int stationId, int sensorId, const TimeSeries &samples);
+
+    /**
+     * @brief Zwraca najpóźniejszy zapisany znacznik czasu
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     * @return Znacznik czasu w ms lub std::numeric_limits<qint64>::min() dla pustego magazynu
+     */
+    qint64 lastTimestamp(int stationId, int sensorId);
+
+    /**
+     * @brief Wczytuje próbki z przedziału czasu [fromMs, toMs]
+     *
+     * Przy nakładających się segmentach pierwszeństwo ma segment o wyższym numerze.
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     * @param fromMs Początek przedziału (ms od epoki)
+     * @param toMs Koniec przedziału (ms od epoki)
+     * @return Próbki posortowane rosnąco według czasu
+     */
+    TimeSeries load(int stationId, int sensorId, qint64 fromMs, qint64 toMs);
+
+    /**
+     * @brief Oblicza statystyki próbek z przedziału czasu [fromMs, toMs]
+     *
+     * Bloki leżące w całości w przedziale są podsumowywane z map stref; dekodowane
+     * są tylko bloki na brzegach przedziału oraz bloki, w których próg wypada
+     * między wartością najmniejszą a największą. Przy nakładających się
+     * segmentach statystyki są liczone ze scalonych próbek.
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     * @param fromMs Początek przedziału (ms od epoki)
+     * @param toMs Koniec przedziału (ms od epoki)
+     * @param threshold Próg dla RangeStats::aboveThreshold (domyślnie bez progu)
+     * @return Statystyki przedziału
+     */
+    RangeStats stats(int stationId, int sensorId, qint64 fromMs, qint64 toMs,
+                     double threshold = std::numeric_limits<double>::infinity());
+
+    /**
+     * @brief Przekazuje widoki wszystkich segmentów czujnika (bez kopiowania)
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     * @param visitor Funkcja wywoływana dla każdego segmentu w kolejności numerów
+     */
+    void forEachSegment(int stationId, int sensorId,
+                        const std::function<void(const SegmentView &)> &visitor);
+
+    /**
+     * @brief Dopisuje próbki bloku z przedziału czasu [fromMs, toMs]
+     * @param view Widok segmentu
+     * @param block Indeks bloku
+     * @param fromMs Początek przedziału (ms od epoki)
+     * @param toMs Koniec przedziału (ms od epoki)
+     * @param out Szereg, do którego dopisywane są próbki
+     * @return false, jeśli blok jest uszkodzony
+     */
+    static bool readBlock(const SegmentView &view, qsizetype block, qint64 fromMs, qint64 toMs, TimeSeries &out);
+
+    /**
+     * @brief Zwraca katalog czujnika (tworząc go w razie potrzeby)
+     * @param stationId ID stacji
+     * @param sensorId ID czujnika
+     * @return Ścieżka do katalogu
+     */
+    QString sensorDirectory(int stationId, int sensorId) const;
+
+private:
+    struct MappedSegment;
+    using SegmentList = QList<std::shared_ptr<MappedSegment>>;
+
+    QString rootDirectory; // Katalog główny magazynu
+    QHash<QString, SegmentList> segments; // Otwarte segmenty według katalogu czujnika
+    QHash<QString, quint64> nextSequence; // Następny numer segmentu według katalogu
+    QSet<QString> compacting; // Katalogi w trakcie kompaktowania
+    QMutex mutex; // Ochrona powyższych struktur
+    QThreadPool compactionPool; // Wątek kompaktowania w tle
+
+    /// Zwraca otwarte segmenty czujnika (otwiera je przy pierwszym użyciu)
+    SegmentList segmentsFor(const QString &directory);
+
+    /// Zapisuje zamknięty segment do pliku
+    static bool writeSegment(const QString &path, quint64 sequence, const TimeSeries &samples);
+
+    /// Mapuje i weryfikuje plik segmentu
+    static std::shared_ptr<MappedSegment> openSegment(const QString &path);
+
+    /// Wybiera segmenty pokrywające przedział; rozłączne są sortowane według czasu
+    static SegmentList inRange(const SegmentList &list, qint64 fromMs, qint64 toMs, bool &disjoint);
+
+    /// Scala próbki z segmentów (nowszy segment ma pierwszeństwo)
+    static TimeSeries mergeSegments(const SegmentList &list, qint64 fromMs, qint64 toMs);
+
+    /// Uruchamia kompaktowanie w tle, jeśli segmentów jest zbyt wiele
+    void scheduleCompaction(const QString &directory);
+
+    /// Łączy małe segmenty w jeden
+    void compact(const QString &directory);
+};
+
+#endif // SEGMENTSTORE_H
@@ -0,0 +1,135 @@
+#include "seriesjoin.h"
+#include "metrics.h"
+#include <QtConcurrent/QtConcurrent>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+
+namespace {
+
+/**
+ * @struct Head
+ * @brief Najwcześniejsza nieprzetworzona próbka szeregu w kopcu złączenia
+ */
+struct Head {
+    qint64 timestamp; // Czas próbki
+    qsizetype input; // Indeks szeregu
+
+    bool operator>(const Head &other) const
+    {
+        return timestamp != other.timestamp ? timestamp > other.timestamp : input > other.input;
+    }
+};
+
+TimeSeries resampled(const TimeSeries &series, RollupTier tier)
+{
+    TimeSeries result;
+    if (series.isEmpty()) return result;
+
+    const QList<RollupBucket> buckets =
+        RollupStore::bucketize(series, tier, series.timestampAt(0), series.timestampAt(series.size() - 1));
+    result.reserve(buckets.size());
+    for (const RollupBucket &bucket : buckets) {
+        result.append(bucket.startMs, bucket.mean());
+    }
+    return result;
+}
+
+void fillGaps(const QList<qint64> &timestamps, QList<double> &values, const SeriesJoin::Options &options)
+{
+    qsizetype previous = -1; // Ostatni poprawny pomiar przed luką
+    for (qsizetype i = 0; i < values.size(); ++i) {
+        if (!std::isnan(values[i])) {
+            previous = i;
+            continue;
+        }
+        if (previous < 0) continue;
+
+        // Cała luka naraz, między pomiarami previous i next; luki na końcu szeregu nie są wypełniane
+        qsizetype next = i;
+        while (next < values.size() && std::isnan(values[next])) ++next;
+        if (next < values.size() && timestamps[next] - timestamps[previous] <= options.maxGapMs) {
+            const double span = double(timestamps[next] - timestamps[previous]);
+            for (qsizetype k = i; k < next; ++k) {
+                if (options.gapFill == SeriesJoin::GapFill::Previous) {
+                    values[k] = values[previous];
+                } else {
+                    const double t = double(timestamps[k] - timestamps[previous]) / span;
+                    values[k] = values[previous] + (values[next] - values[previous]) * t;
+                }
+            }
+        }
+        i = next - 1;
+    }
+}
+
+}
+
+namespace SeriesJoin {
+
+QList<TimeSeries> join(const QList<TimeSeries> &inputs, const Options &options)
+{
+    static Metrics::Histogram &duration = Metrics::instance().histogram("pogoda_series_join_seconds");
+    Metrics::ScopedTimer timer(duration);
+
+    QList<TimeSeries> sources = inputs;
+    if (options.resample) {
+        for (TimeSeries &series : sources) series = resampled(series, options.resolution);
+    }
+
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    QList<qsizetype> positions(sources.size(), 0);
+    qsizetype totalSamples = 0;
+    for (qsizetype s = 0; s < sources.size(); ++s) {
+        totalSamples += sources[s].size();
+        if (!sources[s].isEmpty()) heads.push(Head{sources[s].timestampAt(0), s});
+    }
+
+    QList<qint64> timestamps;
+    timestamps.reserve(totalSamples / qMax<qsizetype>(1, sources.size()));
+    QList<QList<double>> columns(sources.size());
+    while (!heads.empty()) {
+        const qint64 ts = heads.top().timestamp;
+        timestamps.append(ts);
+        for (QList<double> &column : columns) column.append(std::numeric_limits<double>::quiet_NaN());
+
+        // Wszystkie szeregi z próbką w tej chwili; przy powtórzonym czasie w szeregu wygrywa ostatnia próbka
+        while (!heads.empty() && heads.top().timestamp == ts) {
+            const qsizetype s = heads.top().input;
+            heads.pop();
+            const TimeSeries &series = sources[s];
+            qsizetype &pos = positions[s];
+            for (; pos < series.size() && series.timestampAt(pos) == ts; ++pos) {
+                columns[s].last() = series.valueAt(pos); // NaN dla brakującego pomiaru
+            }
+            if (pos < series.size()) heads.push(Head{series.timestampAt(pos), s});
+        }
+    }
+
+    QList<TimeSeries> result;
+    result.reserve(columns.size());
+    for (QList<double> &values : columns) {
+        if (options.gapFill != GapFill::None) fillGaps(timestamps, values, options);
+
+        TimeSeries column;
+        column.reserve(timestamps.size());
+        for (qsizetype i = 0; i < timestamps.size(); ++i) {
+            if (std::isnan(values[i])) {
+                column.appendNull(timestamps[i]);
+            } else {
+                column.append(timestamps[i], values[i]);
+            }
+        }
+        result.append(column);
+    }
+    return result;
+}
+
+QFuture<QList<TimeSeries>> joinAsync(const QList<TimeSeries> &inputs, const Options &options)
+{
+    return QtConcurrent::run([inputs, options]() { return join(inputs, options); });
+}
+
+}
@@ -0,0 +1,63 @@
+/**
+ * @file seriesjoin.h
+ * @brief Definicja przestrzeni nazw SeriesJoin - wyrównywania wielu szeregów według czasu
+ */
+#ifndef SERIESJOIN_H
+#define SERIESJOIN_H
+
+#include <QList>
+#include <QFuture>
+#include "timeseries.h"
+#include "rollupstore.h"
+
+/**
+ * @namespace SeriesJoin
+ * @brief Złączenie N posortowanych szeregów po znaczniku czasu (N-way merge-join)
+ *
+ * Wynik ma jedną kolumnę na szereg wejściowy i wspólną oś czasu - sumę
+ * znaczników czasu wszystkich szeregów. Wiersz, w którym szereg nie ma
+ * próbki, jest w jego kolumnie brakującym pomiarem. Szeregi mogą zostać
+ * wcześniej uśrednione w przedziałach (godziny, doby, miesiące), co pozwala
+ * zestawić np. pomiary godzinowe z dobowymi, a krótkie luki mogą zostać
+ * wypełnione ostatnią wartością lub interpolacją liniową.
+ */
+namespace SeriesJoin {
+
+    /// Sposób wypełniania luk
+    enum class GapFill {
+        None, // Luki pozostają brakującymi pomiarami
+        Previous, // Ostatnia wcześniejsza wartość
+        Linear // Interpolacja liniowa między sąsiednimi wartościami
+    };
+
+    /**
+     * @struct Options
+     * @brief Parametry złączenia
+     */
+    struct Options {
+        bool resample = false; // Czy uśredniać szeregi w przedziałach resolution przed złączeniem
+        RollupTier resolution = RollupTier::Hourly; // Przedziały uśredniania
+        GapFill gapFill = GapFill::None; // Wypełnianie luk
+        qint64 maxGapMs = 3 * 3600 * 1000; // Najdłuższa wypełniana luka (między poprawnymi pomiarami)
+    };
+
+    /**
+     * @brief Złącza szeregi według czasu
+     *
+     * Koszt to O(M log N) dla M próbek w N szeregach (kopiec głów szeregów).
+     * @param inputs Szeregi posortowane rosnąco według czasu
+     * @param options Parametry złączenia
+     * @return Kolumny w kolejności wejścia, wszystkie z tymi samymi znacznikami czasu
+     */
+    QList<TimeSeries> join(const QList<TimeSeries> &inputs, const Options &options = Options());
+
+    /**
+     * @brief Złącza szeregi w globalnej puli wątków
+     * @param inputs Szeregi posortowane rosnąco według czasu
+     * @param options Parametry złączenia
+     * @return Przyszły wynik join()
+     */
+    QFuture<QList<TimeSeries>> joinAsync(const QList<TimeSeries> &inputs, const Options &options = Options());
+}
+
+#endif // SERIESJOIN_H
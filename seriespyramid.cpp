@@ -0,0 +1,162 @@
+#include "seriespyramid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr int BaseBucketSize = 8; // Liczba próbek w kubełku poziomu 0
+constexpr int RawPointsPerPixel = 2; // Poniżej tej gęstości rysowane są surowe punkty
+constexpr int LttbPointsPerPixel = 16; // Poniżej tej gęstości używany jest LTTB
+}
+
+SeriesPyramid::SeriesPyramid(const TimeSeries &series)
+{
+    timestamps.reserve(series.validCount());
+    values.reserve(series.validCount());
+    for (qsizetype i = 0; i < series.size(); ++i) {
+        if (series.isValid(i)) {
+            timestamps.append(series.timestampAt(i));
+            values.append(series.valueAt(i));
+        }
+    }
+
+    const qsizetype n = timestamps.size();
+    if (n == 0) return;
+
+    QList<Bucket> level;
+    level.reserve((n + BaseBucketSize - 1) / BaseBucketSize);
+    for (qsizetype first = 0; first < n; first += BaseBucketSize) {
+        Bucket bucket{first, qMin(n, first + BaseBucketSize) - 1, first, first};
+        for (qsizetype i = first + 1; i <= bucket.last; ++i) {
+            if (values[i] < values[bucket.minIndex]) bucket.minIndex = i;
+            if (values[i] > values[bucket.maxIndex]) bucket.maxIndex = i;
+        }
+        level.append(bucket);
+    }
+    levels.append(level);
+
+    while (levels.last().size() > 1) {
+        const QList<Bucket> &previous = levels.last();
+        QList<Bucket> next;
+        next.reserve((previous.size() + 1) / 2);
+        for (qsizetype i = 0; i < previous.size(); i += 2) {
+            Bucket bucket = previous[i];
+            if (i + 1 < previous.size()) {
+                const Bucket &other = previous[i + 1];
+                bucket.last = other.last;
+                if (values[other.minIndex] < values[bucket.minIndex]) bucket.minIndex = other.minIndex;
+                if (values[other.maxIndex] > values[bucket.maxIndex]) bucket.maxIndex = other.maxIndex;
+            }
+            next.append(bucket);
+        }
+        levels.append(next);
+    }
+}
+
+QList<QPointF> SeriesPyramid::select(qint64 fromMs, qint64 toMs, int pixelWidth) const
+{
+    QList<QPointF> points;
+    if (timestamps.isEmpty()) return points;
+
+    pixelWidth = qMax(pixelWidth, 16);
+    const qsizetype n = timestamps.size();
+
+    // Po jednym punkcie poza przedziałem z każdej strony, aby linia dochodziła do krawędzi
+    qsizetype lo = std::lower_bound(timestamps.cbegin(), timestamps.cend(), fromMs) - timestamps.cbegin();
+    qsizetype hi = std::upper_bound(timestamps.cbegin(), timestamps.cend(), toMs) - timestamps.cbegin();
+    lo = qMax<qsizetype>(0, lo - 1);
+    hi = qMin(n, hi + 1);
+    const qsizetype count = hi - lo;
+
+    if (count <= qsizetype(pixelWidth) * RawPointsPerPixel) {
+        points.reserve(count);
+        for (qsizetype i = lo; i < hi; ++i) {
+            points.append(QPointF(timestamps[i], values[i]));
+        }
+        return points;
+    }
+
+    if (count <= qsizetype(pixelWidth) * LttbPointsPerPixel) {
+        return lttb(timestamps.constData() + lo, values.constData() + lo, count,
+                    pixelWidth * RawPointsPerPixel);
+    }
+
+    // M4: najmniejszy poziom, na którym na piksel przypada co najwyżej jeden kubełek
+    qsizetype levelIndex = 0;
+    qsizetype bucketSize = BaseBucketSize;
+    while (levelIndex + 1 < levels.size() && count / bucketSize > pixelWidth) {
+        ++levelIndex;
+        bucketSize *= 2;
+    }
+
+    const QList<Bucket> &level = levels[levelIndex];
+    const qsizetype firstBucket = lo / bucketSize;
+    const qsizetype lastBucket = qMin(level.size() - 1, (hi - 1) / bucketSize);
+    points.reserve((lastBucket - firstBucket + 1) * 4);
+    for (qsizetype b = firstBucket; b <= lastBucket; ++b) {
+        const Bucket &bucket = level[b];
+        qsizetype indices[4] = {bucket.first, bucket.minIndex, bucket.maxIndex, bucket.last};
+        std::sort(std::begin(indices), std::end(indices));
+        const qsizetype *end = std::unique(std::begin(indices), std::end(indices));
+        for (const qsizetype *it = indices; it != end; ++it) {
+            points.append(QPointF(timestamps[*it], values[*it]));
+        }
+    }
+    return points;
+}
+
+QList<QPointF> SeriesPyramid::lttb(const qint64 *timestamps, const double *values,
+                                   qsizetype count, int threshold)
+{
+    QList<QPointF> points;
+    if (count <= 0) return points;
+
+    if (threshold < 3 || threshold >= count) {
+        points.reserve(count);
+        for (qsizetype i = 0; i < count; ++i) {
+            points.append(QPointF(timestamps[i], values[i]));
+        }
+        return points;
+    }
+
+    // Współrzędne x względem pierwszego punktu, aby nie tracić precyzji
+    const qint64 origin = timestamps[0];
+    auto x = [&](qsizetype i) { return double(timestamps[i] - origin); };
+
+    points.reserve(threshold);
+    points.append(QPointF(timestamps[0], values[0]));
+
+    const double every = double(count - 2) / (threshold - 2);
+    qsizetype a = 0;
+    for (int i = 0; i < threshold - 2; ++i) {
+        // Średnia następnego kubełka
+        const qsizetype avgStart = qsizetype(std::floor((i + 1) * every)) + 1;
+        const qsizetype avgEnd = qMin(qsizetype(std::floor((i + 2) * every)) + 1, count);
+        double avgX = 0.0, avgY = 0.0;
+        for (qsizetype j = avgStart; j < avgEnd; ++j) {
+            avgX += x(j);
+            avgY += values[j];
+        }
+        const qsizetype avgLength = qMax<qsizetype>(1, avgEnd - avgStart);
+        avgX /= avgLength;
+        avgY /= avgLength;
+
+        // Punkt bieżącego kubełka tworzący największy trójkąt
+        const qsizetype rangeStart = qsizetype(std::floor(i * every)) + 1;
+        const qsizetype rangeEnd = qsizetype(std::floor((i + 1) * every)) + 1;
+        double maxArea = -1.0;
+        qsizetype chosen = rangeStart;
+        for (qsizetype j = rangeStart; j < rangeEnd; ++j) {
+            const double area = std::abs((x(a) - avgX) * (values[j] - values[a])
+                                         - (x(a) - x(j)) * (avgY - values[a]));
+            if (area > maxArea) {
+                maxArea = area;
+                chosen = j;
+            }
+        }
+        points.append(QPointF(timestamps[chosen], values[chosen]));
+        a = chosen;
+    }
+
+    points.append(QPointF(timestamps[count - 1], values[count - 1]));
+    return points;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file seriespyramid.h
+ * @brief Definicja klasy SeriesPyramid do zmniejszania liczby punktów wykresu
+ */
+#ifndef SERIESPYRAMID_H
+#define SERIESPYRAMID_H
+
+#include <QList>
+#include <QPointF>
+#include "timeseries.h"
+
+/**
+ * @class SeriesPyramid
+ * @brief Wielorozdzielcza piramida min/max do rysowania długich szeregów
+ *
+ * Piramida jest budowana raz dla szeregu: poziom 0 grupuje po 8 kolejnych
+ * poprawnych próbek, a każdy następny poziom łączy pary kubełków poprzedniego.
+ * Dla widocznego przedziału i szerokości wykresu w pikselach select() zwraca
+ * podzbiór punktów wiernie oddający kształt: surowe punkty, gdy jest ich mało,
+ * LTTB (Largest-Triangle-Three-Buckets) dla umiarkowanej liczby punktów oraz
+ * agregację M4 (pierwszy/min/max/ostatni na kubełek) z odpowiedniego poziomu
+ * piramidy dla bardzo długich przedziałów. Liczba zwracanych punktów zależy
+ * od szerokości wykresu, a nie od długości danych.
+ */
+class SeriesPyramid
+{
+public:
+
+    /**
+     * @brief Buduje piramidę dla szeregu (brakujące pomiary są pomijane)
+     * @param series Szereg posortowany rosnąco według czasu
+     */
+    explicit SeriesPyramid(const TimeSeries &series);
+
+    /**
+     * @brief Wybiera punkty do narysowania
+     * @param fromMs Początek widocznego przedziału (ms od epoki)
+     * @param toMs Koniec widocznego przedziału (ms od epoki)
+     * @param pixelWidth Szerokość obszaru wykresu w pikselach
+     * @return Punkty (x = ms od epoki) posortowane według czasu
+     */
+    QList<QPointF> select(qint64 fromMs, qint64 toMs, int pixelWidth) const;
+
+    /// Zwraca czas pierwszej poprawnej próbki
+    qint64 firstTimestamp() const { return timestamps.isEmpty() ? 0 : timestamps.first(); }
+
+    /// Zwraca czas ostatniej poprawnej próbki
+    qint64 lastTimestamp() const { return timestamps.isEmpty() ? 0 : timestamps.last(); }
+
+    /// Sprawdza, czy szereg nie zawiera poprawnych próbek
+    bool isEmpty() const { return timestamps.isEmpty(); }
+
+    /**
+     * @brief Zmniejsza liczbę punktów algorytmem LTTB
+     * @param timestamps Kolumna znaczników czasu
+     * @param values Kolumna wartości
+     * @param count Liczba punktów
+     * @param threshold Docelowa liczba punktów (co najmniej 3)
+     * @return Wybrane punkty
+     */
+    static QList<QPointF> lttb(const qint64 *timestamps, const double *values,
+                               qsizetype count, int threshold);
+
+private:
+    /**
+     * @struct Bucket
+     * @brief Podsumowanie kolejnych próbek na jednym poziomie piramidy
+     */
+    struct Bucket {
+        qsizetype first; // Indeks pierwszej próbki
+        qsizetype last; // Indeks ostatniej próbki
+        qsizetype minIndex; // Indeks próbki o wartości minimalnej
+        qsizetype maxIndex; // Indeks próbki o wartości maksymalnej
+    };
+
+    QList<qint64> timestamps; // Znaczniki czasu poprawnych próbek
+    QList<double> values; // Wartości poprawnych próbek
+    QList<QList<Bucket>> levels; // Poziomy piramidy; kubełek poziomu k obejmuje 8 * 2^k próbek
+};
+
+#endif // SERIESPYRAMID_H
@@ -0,0 +1,168 @@
+/**
+ * @file simmain.cpp
+ * @brief Program pogoda_sim - symulator API GIOŚ i test obciążeniowy ApiClient
+ *
+ * Bez opcji --load-test program uruchamia symulator i wypisuje jego bazowy URL
+ * (do użycia jako POGODA_API_URL). Z opcją --load-test wysyła zadaną liczbę żądań
+ * getData przez ApiClient ze stałą współbieżnością i wypisuje przepustowość
+ * oraz rozkład czasów odpowiedzi. Opcja --no-resilience pozwala porównać wynik
+ * z klientem bez żądań zabezpieczających i ponowień.
+ */
+#include "giossimulator.h"
+#include "apiclient.h"
+#include "analysis.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QTextStream>
+#include <functional>
+
+namespace {
+
+struct LoadTestResult {
+    int completed = 0; // Zakończone żądania
+    int failed = 0; // Żądania bez danych (błąd, przekroczony czas)
+    double maxLatencyMs = 0.0; // Najdłuższy czas odpowiedzi
+    Analysis::QuantileSketch latencies{0.005}; // Rozkład czasów odpowiedzi
+};
+
+void printReport(const LoadTestResult &result, qint64 elapsedMs, const GiosSimulator *simulator)
+{
+    QTextStream out(stdout);
+    out << QString("Żądania: %1, nieudane: %2, czas: %3 s, przepustowość: %4 żądań/s\n")
+               .arg(result.completed).arg(result.failed)
+               .arg(elapsedMs / 1000.0, 0, 'f', 2)
+               .arg(result.completed * 1000.0 / qMax<qint64>(1, elapsedMs), 0, 'f', 1);
+    out << QString("Czas odpowiedzi [ms]: p50 %1, p90 %2, p99 %3, p99.9 %4, max %5\n")
+               .arg(result.latencies.quantile(0.50), 0, 'f', 1)
+               .arg(result.latencies.quantile(0.90), 0, 'f', 1)
+               .arg(result.latencies.quantile(0.99), 0, 'f', 1)
+               .arg(result.latencies.quantile(0.999), 0, 'f', 1)
+               .arg(result.maxLatencyMs, 0, 'f', 1);
+    if (simulator) {
+        const GiosSimulator::Statistics stats = simulator->statistics();
+        out << QString("Symulator: %1 żądań, 200: %2, 304: %3, 5xx: %4, zerwane: %5, 429: %6, 404: %7\n")
+                   .arg(stats.requests).arg(stats.ok).arg(stats.notModified).arg(stats.errors)
+                   .arg(stats.dropped).arg(stats.throttled).arg(stats.notFound);
+    }
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QLoggingCategory::setFilterRules("default.debug=false");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Symulator API GIOŚ i test obciążeniowy ApiClient.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"port", "Port symulatora (0 - dowolny wolny).", "port", "0"},
+        {"stations", "Liczba stacji.", "n", "250"},
+        {"sensors", "Liczba czujników stacji.", "n", "6"},
+        {"samples", "Liczba pomiarów w odpowiedzi getData.", "n", "72"},
+        {"latency", "Stałe opóźnienie odpowiedzi [ms].", "ms", "0"},
+        {"jitter", "Losowe dodatkowe opóźnienie [ms].", "ms", "0"},
+        {"tail-probability", "Prawdopodobieństwo opóźnienia ogona.", "p", "0"},
+        {"tail-latency", "Opóźnienie ogona [ms].", "ms", "0"},
+        {"error-rate", "Udział odpowiedzi 500/503.", "p", "0"},
+        {"drop-rate", "Udział zerwanych połączeń.", "p", "0"},
+        {"body-rate", "Tempo wysyłania treści [B/s] (0 - bez ograniczenia).", "bytes", "0"},
+        {"rate-limit", "Limit żądań na sekundę (0 - bez limitu).", "n", "0"},
+        {"burst", "Pojemność wiadra żetonów limitu.", "n", "10"},
+        {"recordings", "Katalog z nagranymi odpowiedziami.", "dir"},
+        {"seed", "Ziarno generatora losowego.", "n", "1"},
+        {"load-test", "Uruchamia test obciążeniowy ApiClient."},
+        {"target", "Bazowy URL testu (domyślnie symulator w tym procesie).", "url"},
+        {"requests", "Liczba żądań testu.", "n", "1000"},
+        {"concurrency", "Liczba równoczesnych żądań testu.", "n", "16"},
+        {"no-resilience", "Wyłącza w teście żądania zabezpieczające, ponowienia i bezpiecznik."},
+    });
+    parser.process(a);
+
+    GiosSimulator::Options options;
+    options.stationCount = parser.value("stations").toInt();
+    options.sensorsPerStation = qBound(1, parser.value("sensors").toInt(), 99);
+    options.samplesPerSensor = parser.value("samples").toInt();
+    options.latencyMs = parser.value("latency").toInt();
+    options.jitterMs = parser.value("jitter").toInt();
+    options.tailProbability = parser.value("tail-probability").toDouble();
+    options.tailLatencyMs = parser.value("tail-latency").toInt();
+    options.errorRate = parser.value("error-rate").toDouble();
+    options.dropRate = parser.value("drop-rate").toDouble();
+    options.bodyBytesPerSecond = parser.value("body-rate").toInt();
+    options.requestsPerSecond = parser.value("rate-limit").toDouble();
+    options.burst = parser.value("burst").toInt();
+    options.recordingDirectory = parser.value("recordings");
+    options.seed = parser.value("seed").toUInt();
+
+    GiosSimulator *simulator = nullptr;
+    QString baseUrl = parser.value("target");
+    if (baseUrl.isEmpty()) {
+        simulator = new GiosSimulator(options, &a);
+        if (!simulator->listen(QHostAddress::LocalHost, quint16(parser.value("port").toUInt()))) {
+            qCritical("Nie można uruchomić symulatora na porcie %s", qPrintable(parser.value("port")));
+            return 1;
+        }
+        baseUrl = simulator->baseUrl();
+    }
+
+    if (!parser.isSet("load-test")) {
+        QTextStream(stdout) << "POGODA_API_URL=" << baseUrl << Qt::endl;
+        return a.exec();
+    }
+
+    // Test obciążeniowy: stała liczba żądań w locie, każde zakończone uruchamia następne
+    const int requests = qMax(1, parser.value("requests").toInt());
+    const int concurrency = qMax(1, parser.value("concurrency").toInt());
+
+    ApiClient client;
+    client.setBaseUrl(baseUrl);
+    client.setCacheEnabled(false);
+    if (parser.isSet("no-resilience")) {
+        // Punkt odniesienia: stały limit czasu i pojedyncza próba
+        RequestPolicy::Options policy;
+        policy.hedging = false;
+        policy.maxAttempts = 1;
+        policy.breakerThreshold = 0;
+        policy.minTimeoutMs = policy.maxTimeoutMs;
+        client.setRequestPolicy(policy);
+    }
+
+    LoadTestResult result;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    int issued = 0;
+
+    std::function<void()> issue = [&]() {
+        if (issued >= requests) return;
+        // Kolejne czujniki kolejnych stacji, jak podczas pobierania całej sieci
+        const int station = 1 + (issued / options.sensorsPerStation) % qMax(1, options.stationCount);
+        const int sensorId = station * 100 + issued % options.sensorsPerStation;
+        ++issued;
+
+        QElapsedTimer latency;
+        latency.start();
+        client.fetchSensorData(sensorId).then(&a, [&, latency](const MeasurementData &data) {
+            const double ms = latency.nsecsElapsed() / 1e6;
+            result.latencies.add(ms);
+            result.maxLatencyMs = qMax(result.maxLatencyMs, ms);
+            result.failed += data.values.isEmpty();
+            ++result.completed;
+
+            if (result.completed == requests) {
+                printReport(result, elapsed.elapsed(), simulator);
+                a.exit(0);
+            } else {
+                issue();
+            }
+        });
+    };
+    for (int i = 0; i < concurrency; ++i) {
+        issue();
+    }
+    return a.exec();
+}
@@ -0,0 +1,160 @@
+#include "spatialindex.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr double EarthRadiusKm = 6371.0088;
+constexpr double DegToRad = 3.14159265358979323846 / 180.0;
+
+void toUnitVector(double lat, double lon, double out[3])
+{
+    const double phi = lat * DegToRad;
+    const double lambda = lon * DegToRad;
+    out[0] = std::cos(phi) * std::cos(lambda);
+    out[1] = std::cos(phi) * std::sin(lambda);
+    out[2] = std::sin(phi);
+}
+
+double squaredChord(const double a[3], const double b[3])
+{
+    const double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+}
+
+double SpatialIndex::haversineKm(double lat1, double lon1, double lat2, double lon2)
+{
+    const double dPhi = (lat2 - lat1) * DegToRad;
+    const double dLambda = (lon2 - lon1) * DegToRad;
+    const double h = std::sin(dPhi / 2) * std::sin(dPhi / 2)
+                     + std::cos(lat1 * DegToRad) * std::cos(lat2 * DegToRad)
+                           * std::sin(dLambda / 2) * std::sin(dLambda / 2);
+    return 2.0 * EarthRadiusKm * std::asin(std::sqrt(qMin(1.0, h)));
+}
+
+bool SpatialIndex::update(const QList<Station> &stations)
+{
+    QHash<int, QPair<double, double>> current;
+    current.reserve(stations.size());
+    for (const Station &station : stations) {
+        current.insert(station.id, qMakePair(station.gegrLat, station.gegrLon));
+    }
+    if (current == signature) return false;
+
+    signature = current;
+    nodes.clear();
+    nodes.reserve(stations.size());
+    for (const Station &station : stations) {
+        Node node;
+        toUnitVector(station.gegrLat, station.gegrLon, node.coords);
+        node.lat = station.gegrLat;
+        node.lon = station.gegrLon;
+        node.stationId = station.id;
+        nodes.append(node);
+    }
+    build(0, nodes.size(), 0);
+
+    byLatitude.resize(nodes.size());
+    for (qsizetype i = 0; i < nodes.size(); ++i) byLatitude[i] = i;
+    std::sort(byLatitude.begin(), byLatitude.end(), [this](qsizetype a, qsizetype b) {
+        return nodes[a].lat < nodes[b].lat;
+    });
+    return true;
+}
+
+void SpatialIndex::build(qsizetype begin, qsizetype end, int depth)
+{
+    if (end - begin < 2) return;
+
+    const int axis = depth % 3;
+    const qsizetype mid = begin + (end - begin) / 2;
+    std::nth_element(nodes.begin() + begin, nodes.begin() + mid, nodes.begin() + end,
+                     [axis](const Node &a, const Node &b) { return a.coords[axis] < b.coords[axis]; });
+    build(begin, mid, depth + 1);
+    build(mid + 1, end, depth + 1);
+}
+
+QList<SpatialIndex::Neighbor> SpatialIndex::nearest(double lat, double lon, int k,
+                                                    const std::function<bool(int)> &accept) const
+{
+    QList<Neighbor> result;
+    if (k <= 0 || nodes.isEmpty()) return result;
+
+    double query[3];
+    toUnitVector(lat, lon, query);
+
+    // Kopiec maksymalny k najlepszych kandydatów: (kwadrat cięciwy, indeks węzła)
+    std::priority_queue<std::pair<double, qsizetype>> best;
+
+    std::function<void(qsizetype, qsizetype, int)> search = [&](qsizetype begin, qsizetype end, int depth) {
+        if (begin >= end) return;
+        const qsizetype mid = begin + (end - begin) / 2;
+        const Node &node = nodes[mid];
+
+        if (!accept || accept(node.stationId)) {
+            const double d = squaredChord(query, node.coords);
+            if (qsizetype(best.size()) < k) {
+                best.emplace(d, mid);
+            } else if (d < best.top().first) {
+                best.pop();
+                best.emplace(d, mid);
+            }
+        }
+
+        const int axis = depth % 3;
+        const double diff = query[axis] - node.coords[axis];
+        const bool leftFirst = diff < 0;
+        if (leftFirst) search(begin, mid, depth + 1); else search(mid + 1, end, depth + 1);
+
+        // Odległość od płaszczyzny podziału ogranicza z dołu odległość do drugiej strony
+        if (qsizetype(best.size()) < k || diff * diff < best.top().first) {
+            if (leftFirst) search(mid + 1, end, depth + 1); else search(begin, mid, depth + 1);
+        }
+    };
+    search(0, nodes.size(), 0);
+
+    result.resize(best.size());
+    for (qsizetype i = result.size() - 1; i >= 0; --i) {
+        const Node &node = nodes[best.top().second];
+        result[i] = {node.stationId, haversineKm(lat, lon, node.lat, node.lon)};
+        best.pop();
+    }
+    return result;
+}
+
+QList<int> SpatialIndex::withinBox(double minLat, double minLon, double maxLat, double maxLon) const
+{
+    QList<int> result;
+    auto first = std::lower_bound(byLatitude.cbegin(), byLatitude.cend(), minLat,
+                                  [this](qsizetype i, double lat) { return nodes[i].lat < lat; });
+    const bool wraps = minLon > maxLon;
+    for (auto it = first; it != byLatitude.cend() && nodes[*it].lat <= maxLat; ++it) {
+        const Node &node = nodes[*it];
+        const bool inside = wraps ? (node.lon >= minLon || node.lon <= maxLon)
+                                  : (node.lon >= minLon && node.lon <= maxLon);
+        if (inside) result.append(node.stationId);
+    }
+    return result;
+}
+
+double SpatialIndex::interpolate(double lat, double lon, const QHash<int, double> &values,
+                                 int k, double power) const
+{
+    const QList<Neighbor> neighbors = nearest(lat, lon, k, [&values](int stationId) {
+        return values.contains(stationId);
+    });
+    if (neighbors.isEmpty()) return std::numeric_limits<double>::quiet_NaN();
+
+    double weighted = 0.0, weights = 0.0;
+    for (const Neighbor &neighbor : neighbors) {
+        if (neighbor.distanceKm < 1e-6) return values.value(neighbor.stationId);
+        const double weight = 1.0 / std::pow(neighbor.distanceKm, power);
+        weighted += weight * values.value(neighbor.stationId);
+        weights += weight;
+    }
+    return weighted / weights;
+}
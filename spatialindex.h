@@ -0,0 +1,109 @@
+/**
+ * @file spatialindex.h
+ * @brief Definicja klasy SpatialIndex - indeksu przestrzennego stacji
+ */
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include <QList>
+#include <QHash>
+#include <QPair>
+#include <functional>
+#include "station.h"
+
+/**
+ * @class SpatialIndex
+ * @brief Drzewo KD nad współrzędnymi stacji do zapytań o najbliższe stacje
+ *
+ * Stacje są zamieniane na punkty na sferze jednostkowej (x, y, z), więc
+ * odległość euklidesowa (cięciwa) rośnie monotonicznie z odległością po okręgu
+ * wielkim i obcinanie gałęzi drzewa jest dokładne również dla wzoru haversine.
+ * Zapytania o prostokąt współrzędnych korzystają z listy posortowanej po szerokości.
+ */
+class SpatialIndex
+{
+public:
+
+    /**
+     * @struct Neighbor
+     * @brief Wynik zapytania o najbliższe stacje
+     */
+    struct Neighbor {
+        int stationId; // ID stacji
+        double distanceKm; // Odległość w kilometrach (haversine)
+    };
+
+    /**
+     * @brief Aktualizuje indeks po odświeżeniu katalogu
+     *
+     * Drzewo jest przebudowywane tylko wtedy, gdy zmienił się zbiór stacji
+     * lub współrzędne którejś z nich.
+     * @param stations Lista stacji (wynik DataParser::parseStations)
+     * @return true, jeśli indeks został przebudowany
+     */
+    bool update(const QList<Station> &stations);
+
+    /**
+     * @brief Wyszukuje k najbliższych stacji
+     * @param lat Szerokość geograficzna punktu
+     * @param lon Długość geograficzna punktu
+     * @param k Liczba stacji
+     * @param accept Opcjonalny filtr ID stacji
+     * @return Stacje posortowane rosnąco według odległości
+     */
+    QList<Neighbor> nearest(double lat, double lon, int k,
+                            const std::function<bool(int)> &accept = {}) const;
+
+    /**
+     * @brief Wyszukuje stacje w prostokącie współrzędnych
+     *
+     * Jeśli minLon > maxLon, prostokąt przechodzi przez południk 180°.
+     * @param minLat Minimalna szerokość
+     * @param minLon Minimalna długość
+     * @param maxLat Maksymalna szerokość
+     * @param maxLon Maksymalna długość
+     * @return Lista ID stacji
+     */
+    QList<int> withinBox(double minLat, double minLon, double maxLat, double maxLon) const;
+
+    /**
+     * @brief Interpoluje wartość w punkcie metodą odwrotnych odległości (IDW)
+     * @param lat Szerokość geograficzna punktu
+     * @param lon Długość geograficzna punktu
+     * @param values Wartości według ID stacji (np. ostatni pomiar PM10)
+     * @param k Liczba najbliższych stacji z wartością
+     * @param power Wykładnik wagi odległości
+     * @return Interpolowana wartość (NaN, jeśli brak stacji z wartością)
+     */
+    double interpolate(double lat, double lon, const QHash<int, double> &values,
+                       int k = 6, double power = 2.0) const;
+
+    /// Zwraca liczbę stacji w indeksie
+    qsizetype size() const { return nodes.size(); }
+
+    /**
+     * @brief Oblicza odległość po okręgu wielkim
+     * @return Odległość w kilometrach
+     */
+    static double haversineKm(double lat1, double lon1, double lat2, double lon2);
+
+private:
+    /**
+     * @struct Node
+     * @brief Węzeł niejawnego drzewa KD (korzeń poddrzewa to środek zakresu)
+     */
+    struct Node {
+        double coords[3]; // Punkt na sferze jednostkowej
+        double lat; // Szerokość geograficzna
+        double lon; // Długość geograficzna
+        int stationId; // ID stacji
+    };
+
+    QList<Node> nodes; // Węzły w kolejności drzewa KD
+    QList<qsizetype> byLatitude; // Indeksy węzłów posortowane po szerokości
+    QHash<int, QPair<double, double>> signature; // Współrzędne stacji użyte do budowy
+
+    void build(qsizetype begin, qsizetype end, int depth);
+};
+
+#endif // SPATIALINDEX_H
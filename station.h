@@ -6,20 +6,31 @@
 #define STATION_H
 
 #include <QString>
+#include "stringpool.h"
 
 /**
  * @struct City
  * @brief Struktura opisująca miasto
+ *
+ * Nazwy powtarzające się w katalogu są przechowywane jako identyfikatory
+ * z StringPool; napis uzyskuje się przez StringPool::resolve().
  */
 struct City {
     int id; //ID miasta
-    QString name; // Nazwa miasta
-    QString commune; //Gmina
-    QString district; // Powiat
-    QString province; // Województwo
+    SymbolId name; // Nazwa miasta
+    SymbolId commune; //Gmina
+    SymbolId district; // Powiat
+    SymbolId province; // Województwo
     QString address; // Adres
 };
 
+inline bool operator==(const City &a, const City &b)
+{
+    return a.id == b.id && a.name == b.name && a.commune == b.commune
+           && a.district == b.district && a.province == b.province && a.address == b.address;
+}
+inline bool operator!=(const City &a, const City &b) { return !(a == b); }
+
 /**
  * @struct Station
  * @brief Struktura opisująca stację pomiarową
@@ -32,4 +43,11 @@ struct Station {
     City city; // Informacje o lokalizacji
 };
 
+inline bool operator==(const Station &a, const Station &b)
+{
+    return a.id == b.id && a.stationName == b.stationName && a.gegrLat == b.gegrLat
+           && a.gegrLon == b.gegrLon && a.city == b.city;
+}
+inline bool operator!=(const Station &a, const Station &b) { return !(a == b); }
+
 #endif // STATION_H
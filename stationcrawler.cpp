@@ -0,0 +1,177 @@
+#include "stationcrawler.h"
+#include <QTimer>
+#include <QtMath>
+
+namespace {
+constexpr double MinRequestsPerSecond = 0.01; // Najmniejsze dopuszczalne tempo żądań
+}
+
+StationCrawler::StationCrawler(ApiClient *apiClient, QObject *parent)
+    : QObject(parent),
+    apiClient(apiClient),
+    throttleTimer(new QTimer(this))
+{
+    throttleTimer->setSingleShot(true);
+    connect(throttleTimer, &QTimer::timeout, this, &StationCrawler::schedule);
+}
+
+void StationCrawler::setOptions(const Options &options)
+{
+    // Tempo jest dzielnikiem w harmonogramie, a zerowe limity zatrzymałyby pobieranie na zawsze
+    this->options = options;
+    this->options.maxConcurrent = qMax(1, options.maxConcurrent);
+    this->options.requestsPerSecond = qMax(MinRequestsPerSecond, options.requestsPerSecond); // Także NaN
+    this->options.burst = qMax(1, options.burst);
+}
+
+void StationCrawler::setDataManager(DataManager *dataManager)
+{
+    this->dataManager = dataManager;
+}
+
+void StationCrawler::start(const QList<Station> &stations)
+{
+    cancel();
+
+    this->stations = stations;
+    nextStation = 0;
+    completedRequests = 0;
+    knownRequests = stations.size();
+    sensorCount = 0;
+    insertedSamples = 0;
+    updatedSamples = 0;
+    running = true;
+    tokens = options.burst;
+    clock.start();
+    lastRefillMs = 0;
+
+    if (stations.isEmpty()) {
+        running = false;
+        emit finished(0, 0, 0, 0, 0);
+        return;
+    }
+    schedule();
+}
+
+void StationCrawler::cancel()
+{
+    ++generation;
+    running = false;
+    dataQueue.clear();
+    inFlight = 0;
+    sensorRequestsInFlight = 0;
+    throttleTimer->stop();
+}
+
+bool StationCrawler::isRunning() const
+{
+    return running;
+}
+
+void StationCrawler::schedule()
+{
+    if (!running) return;
+
+    while (inFlight < options.maxConcurrent) {
+        const bool stationsLeft = nextStation < stations.size();
+        if (!stationsLeft && dataQueue.isEmpty()) break;
+
+        if (!takeToken()) {
+            const double missing = 1.0 - tokens;
+            throttleTimer->start(qCeil(missing * 1000.0 / options.requestsPerSecond));
+            break;
+        }
+
+        // Dane mają pierwszeństwo, ale lista czujników kolejnej stacji jest pobierana
+        // z wyprzedzeniem, aby kolejka danych nie opustoszała
+        const bool prefetchSensors = sensorRequestsInFlight == 0
+                                     && dataQueue.size() < options.maxConcurrent * 2;
+        if (stationsLeft && (dataQueue.isEmpty() || prefetchSensors)) {
+            fetchSensors(nextStation++);
+        } else {
+            fetchData(dataQueue.dequeue());
+        }
+    }
+}
+
+bool StationCrawler::takeToken()
+{
+    const qint64 now = clock.elapsed();
+    tokens = qMin<double>(options.burst, tokens + (now - lastRefillMs) * options.requestsPerSecond / 1000.0);
+    lastRefillMs = now;
+
+    if (tokens < 1.0) return false;
+    tokens -= 1.0;
+    return true;
+}
+
+void StationCrawler::fetchSensors(int stationIndex)
+{
+    ++inFlight;
+    ++sensorRequestsInFlight;
+
+    const quint64 currentGeneration = generation;
+    apiClient->fetchStationSensors(stations[stationIndex].id)
+        .then(this, [this, currentGeneration, stationIndex](QList<MeasurementStation> sensors) {
+            if (currentGeneration != generation) return;
+
+            --sensorRequestsInFlight;
+            for (const MeasurementStation &sensor : sensors) {
+                dataQueue.enqueue({stationIndex, sensor});
+            }
+            knownRequests += sensors.size();
+            completeRequest();
+        })
+        .onFailed(this, [this, currentGeneration]() { abandonRequest(currentGeneration, true); })
+        .onCanceled(this, [this, currentGeneration]() { abandonRequest(currentGeneration, true); });
+}
+
+void StationCrawler::fetchData(const DataTask &task)
+{
+    ++inFlight;
+
+    const quint64 currentGeneration = generation;
+    apiClient->fetchSensorData(task.sensor.id)
+        .then(this, [this, currentGeneration, task](MeasurementData data) {
+            if (currentGeneration != generation) return;
+
+            if (data.parameterCode.isEmpty()) {
+                data.parameterCode = StringPool::resolve(task.sensor.parameterCode);
+            }
+
+            const Station &station = stations[task.stationIndex];
+            if (dataManager && !data.values.isEmpty()) {
+                const MergeStats stats = dataManager->saveMeasurementData(station.id, task.sensor.id, data);
+                insertedSamples += stats.inserted;
+                updatedSamples += stats.updated;
+            }
+            ++sensorCount;
+            emit sensorDataReady(station, task.sensor, data);
+            completeRequest();
+        })
+        .onFailed(this, [this, currentGeneration]() { abandonRequest(currentGeneration, false); })
+        .onCanceled(this, [this, currentGeneration]() { abandonRequest(currentGeneration, false); });
+}
+
+void StationCrawler::abandonRequest(quint64 requestGeneration, bool sensorList)
+{
+    if (requestGeneration != generation) return;
+
+    // Żądanie bez wyniku też zwalnia miejsce - inaczej pobieranie nigdy by się nie zakończyło
+    if (sensorList) --sensorRequestsInFlight;
+    completeRequest();
+}
+
+void StationCrawler::completeRequest()
+{
+    --inFlight;
+    ++completedRequests;
+    emit progress(completedRequests, knownRequests);
+
+    if (nextStation >= stations.size() && dataQueue.isEmpty() && inFlight == 0) {
+        running = false;
+        emit finished(stations.size(), sensorCount, clock.elapsed(), insertedSamples, updatedSamples);
+        return;
+    }
+    schedule();
+}
@@ -0,0 +1,161 @@
+/**
+ * @file stationcrawler.h
+ * @brief Definicja klasy StationCrawler do pobierania danych z całej sieci stacji
+ */
+#ifndef STATIONCRAWLER_H
+#define STATIONCRAWLER_H
+
+#include <QObject>
+#include <QList>
+#include <QQueue>
+#include <QElapsedTimer>
+#include "apiclient.h"
+#include "datamanager.h"
+
+class QTimer;
+
+/**
+ * @class StationCrawler
+ * @brief Klasa pobierająca wszystkie serie pomiarowe: stacje -> czujniki -> dane
+ *
+ * Na podstawie wyniku ApiClient::fetchAllStations() pobiera listy czujników
+ * kolejnych stacji i dane każdego czujnika. Liczba równoczesnych żądań do hosta
+ * API jest ograniczona, a tempo wysyłania reguluje wiadro żetonów (token bucket).
+ * Pobieranie danych ma pierwszeństwo przed listami czujników, dzięki czemu
+ * w pamięci czeka tylko niewielka kolejka zadań, a lista czujników kolejnej
+ * stacji jest pobierana równolegle z danymi poprzedniej. Wyniki są przekazywane
+ * sygnałem sensorDataReady i opcjonalnie zapisywane przez DataManager.
+ */
+class StationCrawler : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @struct Options
+     * @brief Parametry pobierania
+     */
+    struct Options {
+        int maxConcurrent = 6; // Maksymalna liczba równoczesnych żądań do hosta API
+        double requestsPerSecond = 20.0; // Średnie tempo żądań (uzupełnianie żetonów)
+        int burst = 10; // Pojemność wiadra żetonów
+    };
+
+    /**
+     * @brief Konstruktor klasy StationCrawler
+     * @param apiClient Klient API używany do pobierania
+     * @param parent Wskaźnik na obiekt rodzica
+     */
+    explicit StationCrawler(ApiClient *apiClient, QObject *parent = nullptr);
+
+    /**
+     * @brief Ustawia parametry pobierania
+     *
+     * Wartości mniejsze od 1 (a tempo niedodatnie) są podnoszone do najmniejszych dopuszczalnych.
+     * @param options Parametry pobierania
+     */
+    void setOptions(const Options &options);
+
+    /**
+     * @brief Ustawia menadżera danych, do którego zapisywane są wyniki
+     * @param dataManager Menadżer danych (nullptr wyłącza zapis)
+     */
+    void setDataManager(DataManager *dataManager);
+
+    /**
+     * @brief Rozpoczyna pobieranie danych dla podanych stacji
+     * @param stations Lista stacji (wynik fetchAllStations)
+     */
+    void start(const QList<Station> &stations);
+
+    /**
+     * @brief Przerywa pobieranie; wyniki trwających żądań są ignorowane
+     */
+    void cancel();
+
+    /**
+     * @brief Sprawdza, czy pobieranie trwa
+     * @return true, jeśli pobieranie trwa
+     */
+    bool isRunning() const;
+
+signals:
+
+    /**
+     * @brief Sygnał emitowany po pobraniu danych czujnika
+     * @param station Stacja
+     * @param sensor Czujnik
+     * @param data Dane pomiarowe
+     */
+    void sensorDataReady(const Station &station, const MeasurementStation &sensor,
+                         const MeasurementData &data);
+
+    /**
+     * @brief Sygnał postępu
+     * @param completedRequests Liczba zakończonych żądań
+     * @param knownRequests Liczba znanych do tej pory żądań
+     */
+    void progress(int completedRequests, int knownRequests);
+
+    /**
+     * @brief Sygnał emitowany po zakończeniu pobierania
+     * @param stationCount Liczba przetworzonych stacji
+     * @param sensorCount Liczba pobranych serii
+     * @param elapsedMs Czas trwania w milisekundach
+     * @param insertedSamples Liczba nowych próbek zapisanych przez DataManager
+     * @param updatedSamples Liczba skorygowanych próbek zapisanych przez DataManager
+     */
+    void finished(int stationCount, int sensorCount, qint64 elapsedMs,
+                  qsizetype insertedSamples, qsizetype updatedSamples);
+
+private:
+    /**
+     * @struct DataTask
+     * @brief Oczekujące pobranie danych czujnika
+     */
+    struct DataTask {
+        int stationIndex; // Indeks stacji w liście stations
+        MeasurementStation sensor; // Czujnik
+    };
+
+    ApiClient *apiClient; // Klient API
+    DataManager *dataManager = nullptr; // Opcjonalny menadżer danych
+    Options options; // Parametry pobierania
+    QList<Station> stations; // Pobierane stacje
+    QQueue<DataTask> dataQueue; // Czujniki czekające na pobranie danych
+    int nextStation = 0; // Indeks następnej stacji do pobrania listy czujników
+    int inFlight = 0; // Liczba trwających żądań
+    int sensorRequestsInFlight = 0; // Liczba trwających żądań o listy czujników
+    int completedRequests = 0; // Liczba zakończonych żądań
+    int knownRequests = 0; // Liczba znanych żądań
+    int sensorCount = 0; // Liczba pobranych serii
+    qsizetype insertedSamples = 0; // Liczba nowych próbek zapisanych przez DataManager
+    qsizetype updatedSamples = 0; // Liczba skorygowanych próbek zapisanych przez DataManager
+    quint64 generation = 0; // Numer przebiegu - pozwala zignorować wyniki po cancel()
+    bool running = false; // Czy pobieranie trwa
+    double tokens = 0.0; // Dostępne żetony
+    QElapsedTimer clock; // Czas od startu (uzupełnianie żetonów i statystyki)
+    qint64 lastRefillMs = 0; // Moment ostatniego uzupełnienia żetonów
+    QTimer *throttleTimer; // Budzi harmonogram, gdy zabraknie żetonów
+
+    /// Uruchamia tyle zadań, ile pozwalają limity
+    void schedule();
+
+    /// Pobiera żeton, jeśli jest dostępny
+    bool takeToken();
+
+    /// Pobiera listę czujników stacji
+    void fetchSensors(int stationIndex);
+
+    /// Pobiera dane czujnika
+    void fetchData(const DataTask &task);
+
+    /// Kończy żądanie i sprawdza, czy pobieranie się zakończyło
+    void completeRequest();
+
+    /// Kończy żądanie zakończone błędem lub anulowane (ignorowane po cancel())
+    void abandonRequest(quint64 requestGeneration, bool sensorList);
+};
+
+#endif // STATIONCRAWLER_H
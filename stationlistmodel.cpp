@@ -0,0 +1,141 @@
+#include "stationlistmodel.h"
+#include <QHash>
+#include <QSet>
+#include <algorithm>
+#include <numeric>
+
+StationListModel::StationListModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void StationListModel::setStations(const QList<Station> &stations)
+{
+    beginResetModel();
+    this->stations = stations;
+    indexed = false;
+    lastQuery.clear();
+    rows.resize(stations.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    endResetModel();
+}
+
+int StationListModel::updateStations(const QList<Station> &updated)
+{
+    if (stations.isEmpty()) {
+        setStations(updated);
+        return int(updated.size());
+    }
+
+    QHash<int, qsizetype> positions;
+    positions.reserve(updated.size());
+    for (qsizetype i = 0; i < updated.size(); ++i) {
+        positions.insert(updated[i].id, i);
+    }
+
+    // Bez filtra wiersz modelu odpowiada pozycji na liście stacji
+    const bool filtered = !lastQuery.isEmpty();
+    int changes = 0;
+
+    // Od końca, aby usunięcie nie przesuwało jeszcze niesprawdzonych wierszy
+    for (qsizetype i = stations.size() - 1; i >= 0; --i) {
+        if (positions.contains(stations[i].id)) continue;
+        if (!filtered) beginRemoveRows(QModelIndex(), int(i), int(i));
+        stations.removeAt(i);
+        if (!filtered) {
+            rows.removeLast();
+            endRemoveRows();
+        }
+        ++changes;
+    }
+
+    QSet<int> known;
+    known.reserve(stations.size());
+    for (qsizetype i = 0; i < stations.size(); ++i) {
+        const Station &fresh = updated[positions.value(stations[i].id)];
+        known.insert(fresh.id);
+        if (stations[i] == fresh) continue;
+        stations[i] = fresh;
+        ++changes;
+        if (!filtered) emit dataChanged(index(int(i)), index(int(i)));
+    }
+
+    QList<Station> added;
+    for (const Station &station : updated) {
+        if (!known.contains(station.id)) added.append(station);
+    }
+    if (!added.isEmpty()) {
+        const qsizetype first = stations.size();
+        if (!filtered) beginInsertRows(QModelIndex(), int(first), int(first + added.size() - 1));
+        stations.append(added);
+        if (!filtered) {
+            rows.resize(stations.size());
+            std::iota(rows.begin() + first, rows.end(), int(first));
+            endInsertRows();
+        }
+        changes += int(added.size());
+    }
+
+    if (changes > 0) {
+        indexed = false;
+        if (filtered) {
+            searchIndex.build(stations);
+            indexed = true;
+            beginResetModel();
+            rows = searchIndex.search(lastQuery);
+            endResetModel();
+        }
+    }
+    return changes;
+}
+
+void StationListModel::setFilter(const QString &query)
+{
+    const QString folded = StationSearchIndex::fold(query).simplified();
+    if (folded == lastQuery) return;
+
+    if (!indexed) {
+        searchIndex.build(stations);
+        indexed = true;
+    }
+
+    // Dopisanie znaku może tylko zawęzić wynik - wystarczy przefiltrować poprzednie wiersze.
+    // Nie dotyczy słów krótszych niż 3 znaki: są dopasowywane tylko na początku słowa,
+    // a dłuższe w dowolnym miejscu, więc wynik mógłby się poszerzyć.
+    const QStringList lastWords = lastQuery.split(u' ', Qt::SkipEmptyParts);
+    const bool refines = !lastWords.isEmpty() && folded.startsWith(lastQuery)
+                         && std::all_of(lastWords.cbegin(), lastWords.cend(),
+                                        [](const QString &word) { return word.size() >= 3; });
+    QList<int> result = refines ? searchIndex.search(folded, &rows) : searchIndex.search(folded);
+
+    beginResetModel();
+    rows = std::move(result);
+    lastQuery = folded;
+    endResetModel();
+}
+
+const Station &StationListModel::stationAt(int row) const
+{
+    return stations[rows[row]];
+}
+
+int StationListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(rows.size());
+}
+
+QVariant StationListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows.size()) return QVariant();
+
+    const Station &station = stationAt(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        return QString("%1 (%2)").arg(station.stationName, StringPool::resolve(station.city.name));
+    case StationIdRole:
+        return station.id;
+    default:
+        return QVariant();
+    }
+}
@@ -0,0 +1,84 @@
+/**
+ * @file stationlistmodel.h
+ * @brief Definicja klasy StationListModel - modelu listy stacji z filtrowaniem
+ */
+#ifndef STATIONLISTMODEL_H
+#define STATIONLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include "station.h"
+#include "stationsearchindex.h"
+
+/**
+ * @class StationListModel
+ * @brief Model listy stacji dla QComboBox i QCompleter
+ *
+ * Lista jest ustawiana jednym resetem modelu zamiast osobnego addItem()
+ * dla każdej stacji. Filtr korzysta z StationSearchIndex; jeśli nowe zapytanie
+ * rozszerza poprzednie (kolejny wpisany znak), przeszukiwane są tylko
+ * poprzednie wyniki.
+ */
+class StationListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+
+    /// Rola z identyfikatorem stacji
+    static constexpr int StationIdRole = Qt::UserRole;
+
+    /**
+     * @brief Konstruktor klasy StationListModel
+     * @param parent Wskaźnik na obiekt rodzica
+     */
+    explicit StationListModel(QObject *parent = nullptr);
+
+    /**
+     * @brief Ustawia listę stacji i czyści filtr
+     * @param stations Lista stacji
+     */
+    void setStations(const QList<Station> &stations);
+
+    /**
+     * @brief Nanosi na listę tylko zmiany względem nowego katalogu
+     *
+     * Usunięte stacje są usuwane, zmienione aktualizowane w miejscu, a nowe
+     * dopisywane na końcu - bez resetu modelu, więc bieżący wybór w QComboBox
+     * jest zachowany. Przy aktywnym filtrze przeliczany jest tylko wynik filtra.
+     * @param updated Aktualna lista stacji
+     * @return Liczba dodanych, usuniętych i zmienionych stacji
+     */
+    int updateStations(const QList<Station> &updated);
+
+    /**
+     * @brief Zwraca wszystkie stacje w kolejności modelu bez filtra
+     * @return Lista stacji
+     */
+    const QList<Station> &allStations() const { return stations; }
+
+    /**
+     * @brief Filtruje listę stacji
+     * @param query Zapytanie (pusty napis wyłącza filtr)
+     */
+    void setFilter(const QString &query);
+
+    /**
+     * @brief Zwraca stację wyświetlaną w wierszu
+     * @param row Numer wiersza
+     * @return Referencja na stację
+     */
+    const Station &stationAt(int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    QList<Station> stations; // Wszystkie stacje
+    StationSearchIndex searchIndex; // Indeks wyszukiwania (budowany przy pierwszym filtrze)
+    bool indexed = false; // Czy indeks odpowiada liście stacji
+    QList<int> rows; // Indeksy stacji widocznych w modelu
+    QString lastQuery; // Znormalizowane poprzednie zapytanie
+};
+
+#endif // STATIONLISTMODEL_H
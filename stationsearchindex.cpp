@@ -0,0 +1,135 @@
+#include "stationsearchindex.h"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+constexpr QChar FieldSeparator = u'\n';
+
+// Polskie litery bez rozkładu kanonicznego (ł) i najczęstsze przypadki bez normalizacji
+QChar foldChar(QChar c)
+{
+    const char16_t u = c.unicode();
+    if (u < 0x80) return (u >= 'A' && u <= 'Z') ? QChar(u + ('a' - 'A')) : c;
+
+    switch (u) {
+    case u'ą': case u'Ą': return u'a';
+    case u'ć': case u'Ć': return u'c';
+    case u'ę': case u'Ę': return u'e';
+    case u'ł': case u'Ł': return u'l';
+    case u'ń': case u'Ń': return u'n';
+    case u'ó': case u'Ó': return u'o';
+    case u'ś': case u'Ś': return u's';
+    case u'ź': case u'Ź': case u'ż': case u'Ż': return u'z';
+    default: break;
+    }
+
+    // Pozostałe znaki: pierwszy znak rozkładu kanonicznego (é -> e)
+    const QString decomposition = c.decomposition();
+    const QChar base = decomposition.isEmpty() ? c : decomposition.at(0);
+    return base.toLower();
+}
+
+quint64 trigramKey(const QChar *text)
+{
+    return (quint64(text[0].unicode()) << 32) | (quint64(text[1].unicode()) << 16) | text[2].unicode();
+}
+
+// Czy słowo występuje w tekście na początku słowa
+bool containsWordPrefix(const QString &haystack, const QString &word)
+{
+    qsizetype from = 0;
+    while ((from = haystack.indexOf(word, from)) >= 0) {
+        if (from == 0 || !haystack.at(from - 1).isLetterOrNumber()) return true;
+        ++from;
+    }
+    return false;
+}
+
+}
+
+QString StationSearchIndex::fold(QStringView text)
+{
+    QString result(text.size(), Qt::Uninitialized);
+    QChar *out = result.data();
+    for (const QChar c : text) {
+        *out++ = foldChar(c);
+    }
+    return result;
+}
+
+void StationSearchIndex::build(const QList<Station> &stations)
+{
+    haystacks.clear();
+    names.clear();
+    trigrams.clear();
+    haystacks.reserve(stations.size());
+    names.reserve(stations.size());
+
+    for (int i = 0; i < stations.size(); ++i) {
+        const Station &station = stations[i];
+        const QString name = fold(station.stationName);
+        QString haystack = name;
+        for (SymbolId field : {station.city.name, station.city.commune,
+                               station.city.district, station.city.province}) {
+            haystack += FieldSeparator;
+            haystack += fold(StringPool::resolve(field));
+        }
+
+        const QChar *data = haystack.constData();
+        for (qsizetype j = 0; j + 3 <= haystack.size(); ++j) {
+            if (data[j] == FieldSeparator || data[j + 1] == FieldSeparator || data[j + 2] == FieldSeparator) continue;
+            QList<int> &postings = trigrams[trigramKey(data + j)];
+            if (postings.isEmpty() || postings.last() != i) postings.append(i);
+        }
+
+        names.append(name);
+        haystacks.append(haystack);
+    }
+}
+
+bool StationSearchIndex::matches(int station, const QStringList &words) const
+{
+    const QString &haystack = haystacks[station];
+    for (const QString &word : words) {
+        const bool found = word.size() >= 3 ? haystack.contains(word) : containsWordPrefix(haystack, word);
+        if (!found) return false;
+    }
+    return true;
+}
+
+QList<int> StationSearchIndex::candidatesFor(const QStringList &words) const
+{
+    // Najkrótsza lista trigramów spośród wszystkich słów ogranicza zbiór kandydatów
+    const QList<int> *shortest = nullptr;
+    for (const QString &word : words) {
+        for (qsizetype j = 0; j + 3 <= word.size(); ++j) {
+            auto it = trigrams.constFind(trigramKey(word.constData() + j));
+            if (it == trigrams.constEnd()) return {};
+            if (!shortest || it->size() < shortest->size()) shortest = &*it;
+        }
+    }
+    if (shortest) return *shortest;
+
+    QList<int> all(haystacks.size());
+    std::iota(all.begin(), all.end(), 0);
+    return all;
+}
+
+QList<int> StationSearchIndex::search(QStringView query, const QList<int> *candidates) const
+{
+    const QString folded = fold(query).simplified();
+    const QStringList words = folded.split(u' ', Qt::SkipEmptyParts);
+
+    const QList<int> pool = candidates ? *candidates : candidatesFor(words);
+    if (words.isEmpty()) return pool;
+
+    QList<int> prefixed, other;
+    for (int station : pool) {
+        if (!matches(station, words)) continue;
+        (names[station].startsWith(folded) ? prefixed : other).append(station);
+    }
+    std::sort(prefixed.begin(), prefixed.end());
+    std::sort(other.begin(), other.end());
+    return prefixed + other;
+}
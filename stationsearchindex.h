@@ -0,0 +1,64 @@
+/**
+ * @file stationsearchindex.h
+ * @brief Definicja klasy StationSearchIndex - indeksu wyszukiwania stacji po nazwie
+ */
+#ifndef STATIONSEARCHINDEX_H
+#define STATIONSEARCHINDEX_H
+
+#include <QString>
+#include <QStringView>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include "station.h"
+
+/**
+ * @class StationSearchIndex
+ * @brief Indeks trigramowy nad nazwą stacji, miastem, gminą, powiatem i województwem
+ *
+ * Teksty są sprowadzane do małych liter bez polskich znaków diakrytycznych
+ * ("Łódź" -> "lodz"), więc zapytanie wpisane bez polskiej klawiatury znajduje
+ * te same stacje. Słowa zapytania o długości co najmniej 3 znaków są
+ * wyszukiwane przez przecięcie list trigramów, krótsze - jako prefiksy słów.
+ */
+class StationSearchIndex
+{
+public:
+
+    /**
+     * @brief Buduje indeks dla listy stacji
+     * @param stations Lista stacji; wyniki wyszukiwania to indeksy w tej liście
+     */
+    void build(const QList<Station> &stations);
+
+    /**
+     * @brief Wyszukuje stacje pasujące do wszystkich słów zapytania
+     *
+     * Stacje, których nazwa zaczyna się od zapytania, są zwracane jako pierwsze,
+     * pozostałe w kolejności z listy stacji.
+     * @param query Zapytanie (dowolna wielkość liter, z polskimi znakami lub bez)
+     * @param candidates Opcjonalne zawężenie do wyników wcześniejszego zapytania
+     * @return Indeksy pasujących stacji (wszystkie dla pustego zapytania)
+     */
+    QList<int> search(QStringView query, const QList<int> *candidates = nullptr) const;
+
+    /// Zwraca liczbę stacji w indeksie
+    qsizetype size() const { return haystacks.size(); }
+
+    /**
+     * @brief Sprowadza tekst do małych liter bez znaków diakrytycznych
+     * @param text Tekst
+     * @return Tekst znormalizowany ("Żółć" -> "zolc")
+     */
+    static QString fold(QStringView text);
+
+private:
+    QList<QString> haystacks; // Znormalizowane pola stacji rozdzielone znakiem '\n'
+    QList<QString> names; // Znormalizowane nazwy stacji (do rankingu)
+    QHash<quint64, QList<int>> trigrams; // Trigram -> rosnąca lista indeksów stacji
+
+    bool matches(int station, const QStringList &words) const;
+    QList<int> candidatesFor(const QStringList &words) const;
+};
+
+#endif // STATIONSEARCHINDEX_H
@@ -0,0 +1,48 @@
+#include "stringpool.h"
+#include <QReadLocker>
+#include <QWriteLocker>
+
+StringPool::StringPool()
+{
+    strings.append(QString());
+    ids.insert(QString(), 0);
+}
+
+StringPool &StringPool::instance()
+{
+    static StringPool pool;
+    return pool;
+}
+
+SymbolId StringPool::insert(QStringView text)
+{
+    if (text.isEmpty()) return 0;
+
+    const QString key = text.toString();
+    {
+        QReadLocker locker(&lock);
+        auto it = ids.constFind(key);
+        if (it != ids.constEnd()) return *it;
+    }
+
+    QWriteLocker locker(&lock);
+    auto it = ids.constFind(key);
+    if (it != ids.constEnd()) return *it; // Inny wątek mógł dodać napis w międzyczasie
+
+    const SymbolId id = SymbolId(strings.size());
+    strings.append(key);
+    ids.insert(key, id);
+    return id;
+}
+
+QString StringPool::lookup(SymbolId id) const
+{
+    QReadLocker locker(&lock);
+    return id < SymbolId(strings.size()) ? strings.at(id) : QString();
+}
+
+qsizetype StringPool::size() const
+{
+    QReadLocker locker(&lock);
+    return strings.size();
+}
@@ -0,0 +1,78 @@
+/**
+ * @file stringpool.h
+ * @brief Definicja klasy StringPool - tablicy symboli dla powtarzających się nazw
+ */
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QString>
+#include <QStringView>
+#include <QHash>
+#include <QList>
+#include <QReadWriteLock>
+
+/// Identyfikator napisu w StringPool (0 oznacza napis pusty)
+using SymbolId = quint32;
+
+/**
+ * @class StringPool
+ * @brief Globalna, bezpieczna wątkowo tablica symboli (interning napisów)
+ *
+ * Nazwy województw, powiatów, gmin i parametrów powtarzają się w katalogu
+ * tysiące razy. Każdy napis jest przechowywany w puli tylko raz, a struktury
+ * katalogu trzymają jego 32-bitowy identyfikator. Porównanie identyfikatorów
+ * jest równoważne porównaniu napisów.
+ */
+class StringPool
+{
+public:
+
+    /**
+     * @brief Zwraca globalną pulę napisów
+     * @return Referencja na pulę
+     */
+    static StringPool &instance();
+
+    /**
+     * @brief Dodaje napis do globalnej puli
+     * @param text Napis
+     * @return Identyfikator napisu
+     */
+    static SymbolId intern(QStringView text) { return instance().insert(text); }
+
+    /**
+     * @brief Zwraca napis o podanym identyfikatorze z globalnej puli
+     * @param id Identyfikator napisu
+     * @return Napis (pusty dla nieznanego identyfikatora)
+     */
+    static QString resolve(SymbolId id) { return instance().lookup(id); }
+
+    /**
+     * @brief Dodaje napis do puli (lub zwraca identyfikator istniejącego)
+     * @param text Napis
+     * @return Identyfikator napisu
+     */
+    SymbolId insert(QStringView text);
+
+    /**
+     * @brief Zwraca napis o podanym identyfikatorze
+     * @param id Identyfikator napisu
+     * @return Napis (pusty dla nieznanego identyfikatora)
+     */
+    QString lookup(SymbolId id) const;
+
+    /**
+     * @brief Zwraca liczbę napisów w puli
+     * @return Liczba napisów (łącznie z pustym)
+     */
+    qsizetype size() const;
+
+private:
+    StringPool();
+
+    mutable QReadWriteLock lock; // Ochrona puli
+    QHash<QString, SymbolId> ids; // Napis -> identyfikator
+    QList<QString> strings; // Identyfikator -> napis
+};
+
+#endif // STRINGPOOL_H
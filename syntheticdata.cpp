@@ -0,0 +1,228 @@
+#include "syntheticdata.h"
+#include <cmath>
+#include <iterator>
+
+namespace {
+
+constexpr qint64 HourMs = 3600000;
+constexpr double Pi = 3.14159265358979323846;
+
+// Generator splitmix64 - identyczne wyniki na każdej platformie (w odróżnieniu od std::*_distribution)
+class Random
+{
+public:
+    explicit Random(quint64 seed) : state(seed) {}
+
+    quint64 next()
+    {
+        quint64 z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    double uniform() { return double(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    int below(int bound) { return int(next() % quint64(bound)); }
+
+private:
+    quint64 state;
+};
+
+struct Parameter {
+    const char *code;
+    const char *name;
+    double level; // Typowe stężenie
+};
+
+const Parameter Parameters[] = {
+    {"PM10", "pył zawieszony PM10", 30.0},
+    {"PM2.5", "pył zawieszony PM2.5", 20.0},
+    {"NO2", "dwutlenek azotu", 25.0},
+    {"O3", "ozon", 60.0},
+    {"SO2", "dwutlenek siarki", 5.0},
+    {"CO", "tlenek węgla", 400.0},
+    {"C6H6", "benzen", 1.5},
+};
+
+const char *const Provinces[] = {
+    "DOLNOŚLĄSKIE", "KUJAWSKO-POMORSKIE", "LUBELSKIE", "LUBUSKIE", "ŁÓDZKIE", "MAŁOPOLSKIE",
+    "MAZOWIECKIE", "OPOLSKIE", "PODKARPACKIE", "PODLASKIE", "POMORSKIE", "ŚLĄSKIE",
+    "ŚWIĘTOKRZYSKIE", "WARMIŃSKO-MAZURSKIE", "WIELKOPOLSKIE", "ZACHODNIOPOMORSKIE",
+};
+
+const char *const Cities[] = {
+    "Warszawa", "Kraków", "Łódź", "Wrocław", "Poznań", "Gdańsk", "Szczecin", "Bydgoszcz",
+    "Lublin", "Białystok", "Katowice", "Gdynia", "Częstochowa", "Radom", "Toruń", "Kielce",
+    "Rzeszów", "Gliwice", "Zabrze", "Olsztyn", "Bielsko-Biała", "Bytom", "Zielona Góra",
+    "Rybnik", "Ruda Śląska", "Opole", "Tychy", "Gorzów Wielkopolski", "Płock", "Elbląg",
+    "Wałbrzych", "Włocławek", "Tarnów", "Chorzów", "Koszalin", "Kalisz", "Legnica",
+    "Grudziądz", "Jaworzno", "Słupsk", "Jastrzębie-Zdrój", "Nowy Sącz", "Jelenia Góra",
+    "Siedlce", "Mysłowice", "Konin", "Piła", "Piotrków Trybunalski", "Inowrocław", "Lubin",
+    "Ostrów Wielkopolski", "Suwałki", "Stargard", "Gniezno", "Ostrowiec Świętokrzyski",
+    "Siemianowice Śląskie", "Głogów", "Pabianice", "Leszno", "Żory", "Zamość", "Pruszków",
+    "Łomża", "Ełk", "Tomaszów Mazowiecki", "Chełm", "Mielec", "Kędzierzyn-Koźle",
+    "Przemyśl", "Stalowa Wola", "Tczew", "Biała Podlaska", "Bełchatów", "Świdnica",
+    "Będzin", "Zgierz", "Piekary Śląskie", "Racibórz", "Legionowo", "Ostrołęka",
+    "Świętochłowice", "Wejherowo", "Zawiercie", "Starachowice", "Skierniewice", "Puławy",
+    "Wodzisław Śląski", "Starogard Gdański", "Tarnobrzeg", "Radomsko", "Krosno", "Kołobrzeg",
+    "Dębica", "Kutno", "Otwock", "Nysa", "Ciechanów", "Sieradz", "Zduńska Wola", "Świnoujście",
+};
+
+const char *const Streets[] = {
+    "ul. Marszałkowska", "al. Niepodległości", "ul. Kościuszki", "ul. Mickiewicza",
+    "ul. Słowackiego", "ul. Piłsudskiego", "ul. Sienkiewicza", "ul. Żeromskiego",
+};
+
+QByteArray escaped(const QString &text)
+{
+    QByteArray result = text.toUtf8();
+    result.replace('\\', "\\\\").replace('"', "\\\"");
+    return result;
+}
+
+const Parameter &parameterFor(const QString &code)
+{
+    for (const Parameter &parameter : Parameters) {
+        if (code == QLatin1String(parameter.code)) return parameter;
+    }
+    return Parameters[0];
+}
+
+// Stężenie z cyklem dobowym i rocznym (wyższe zimą i wieczorem) oraz szumem
+double concentration(const Parameter &parameter, int dayOfYear, int hour, Random &random)
+{
+    const double season = 1.0 + 0.5 * std::cos(2.0 * Pi * (dayOfYear - 15) / 365.0);
+    const double daily = 1.0 + 0.3 * std::sin(2.0 * Pi * (hour - 13) / 24.0);
+    const double noise = (random.uniform() + random.uniform() + random.uniform() - 1.5) * 0.6;
+    return qMax(0.0, parameter.level * season * daily * (1.0 + noise));
+}
+
+}
+
+namespace SyntheticData {
+
+QStringList parameterCodes()
+{
+    QStringList codes;
+    for (const Parameter &parameter : Parameters) {
+        codes.append(QLatin1String(parameter.code));
+    }
+    return codes;
+}
+
+QByteArray stations(int count, quint32 seed)
+{
+    Random random(seed);
+    QByteArray json;
+    json.reserve(qsizetype(count) * 400);
+    json += '[';
+
+    for (int id = 1; id <= count; ++id) {
+        const QByteArray city = Cities[random.below(int(std::size(Cities)))];
+        const QByteArray province = Provinces[random.below(int(std::size(Provinces)))];
+        const QByteArray street = Streets[random.below(int(std::size(Streets)))];
+        const double lat = 49.0 + random.uniform() * 5.8;
+        const double lon = 14.1 + random.uniform() * 10.0;
+
+        if (id > 1) json += ',';
+        json += "{\"id\":" + QByteArray::number(id)
+                + ",\"stationName\":\"" + city + ", " + street + " " + QByteArray::number(id) + "\""
+                + ",\"gegrLat\":\"" + QByteArray::number(lat, 'f', 6) + "\""
+                + ",\"gegrLon\":\"" + QByteArray::number(lon, 'f', 6) + "\""
+                + ",\"city\":{\"id\":" + QByteArray::number(1000 + id)
+                + ",\"name\":\"" + city + "\""
+                + ",\"commune\":{\"communeName\":\"" + city + "\""
+                + ",\"districtName\":\"" + city + "\""
+                + ",\"provinceName\":\"" + province + "\"}"
+                + ",\"addressStreet\":\"" + street + " " + QByteArray::number(id) + "\"}}";
+    }
+    json += ']';
+    return json;
+}
+
+QByteArray sensors(int stationId, int count)
+{
+    QByteArray json = "[";
+    for (int i = 0; i < count; ++i) {
+        const Parameter &parameter = Parameters[i % std::size(Parameters)];
+        if (i > 0) json += ',';
+        json += "{\"id\":" + QByteArray::number(stationId * 100 + i)
+                + ",\"stationId\":" + QByteArray::number(stationId)
+                + ",\"param\":{\"paramName\":\"" + parameter.name + "\""
+                + ",\"paramFormula\":\"" + parameter.code + "\""
+                + ",\"paramCode\":\"" + parameter.code + "\""
+                + ",\"idParam\":" + QByteArray::number(i + 1) + "}}";
+    }
+    json += ']';
+    return json;
+}
+
+QByteArray sensorData(qsizetype samples, const QString &parameterCode, const QDate &lastDay,
+                      double nullRatio, quint32 seed)
+{
+    Random random(seed);
+    const Parameter &parameter = parameterFor(parameterCode);
+
+    QByteArray json;
+    json.reserve(samples * 48 + 64);
+    json += "{\"key\":\"" + escaped(parameterCode) + "\",\"values\":[";
+
+    // Kolejność jak w API: od najnowszego pomiaru, czas lokalny bez strefy
+    QDate day = lastDay;
+    QByteArray dayPrefix = day.toString(Qt::ISODate).toLatin1() + ' ';
+    int hour = 23;
+    for (qsizetype i = 0; i < samples; ++i) {
+        if (i > 0) json += ',';
+        json += "{\"date\":\"" + dayPrefix;
+        json += char('0' + hour / 10);
+        json += char('0' + hour % 10);
+        json += ":00:00\",\"value\":";
+        if (random.uniform() < nullRatio) {
+            json += "null}";
+        } else {
+            json += QByteArray::number(concentration(parameter, day.dayOfYear(), hour, random), 'f', 4);
+            json += '}';
+        }
+
+        if (--hour < 0) {
+            hour = 23;
+            day = day.addDays(-1);
+            dayPrefix = day.toString(Qt::ISODate).toLatin1() + ' ';
+        }
+    }
+    json += "]}";
+    return json;
+}
+
+QByteArray airQualityIndex(int stationId)
+{
+    static const char *const Levels[] = {"Bardzo dobry", "Dobry", "Umiarkowany", "Dostateczny", "Zły", "Bardzo zły"};
+    const int level = stationId % int(std::size(Levels));
+    return "{\"id\":" + QByteArray::number(stationId)
+           + ",\"stCalcDate\":\"2024-12-31 23:20:00\""
+           + ",\"stIndexLevel\":{\"id\":" + QByteArray::number(level)
+           + ",\"indexLevelName\":\"" + Levels[level] + "\"}"
+           + ",\"stSourceDataDate\":\"2024-12-31 23:00:00\"}";
+}
+
+TimeSeries series(qsizetype samples, qint64 firstMs, double nullRatio, quint32 seed)
+{
+    Random random(seed);
+    const Parameter &parameter = Parameters[0];
+
+    TimeSeries result;
+    result.reserve(samples);
+    for (qsizetype i = 0; i < samples; ++i) {
+        const qint64 timestamp = firstMs + i * HourMs;
+        if (random.uniform() < nullRatio) {
+            result.appendNull(timestamp);
+        } else {
+            const qint64 hours = timestamp / HourMs;
+            result.append(timestamp, concentration(parameter, int((hours / 24) % 365), int(hours % 24), random));
+        }
+    }
+    return result;
+}
+
+} // namespace SyntheticData
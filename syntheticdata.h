@@ -0,0 +1,79 @@
+/**
+ * @file syntheticdata.h
+ * @brief Definicja przestrzeni nazw SyntheticData - generatora odpowiedzi API GIOŚ
+ */
+#ifndef SYNTHETICDATA_H
+#define SYNTHETICDATA_H
+
+#include <QByteArray>
+#include <QDate>
+#include <QString>
+#include <QStringList>
+#include "timeseries.h"
+
+/**
+ * @namespace SyntheticData
+ * @brief Deterministyczne dane w formacie API GIOŚ do benchmarków i symulatora
+ *
+ * Ten sam seed daje zawsze te same dokumenty, więc wyniki pomiarów wydajności
+ * z kolejnych uruchomień są porównywalne. Dokumenty mają układ pól i formaty
+ * dat zgodne z odpowiedziami serwera GIOŚ (współrzędne jako napisy, daty
+ * "yyyy-MM-dd HH:mm:ss" czasu lokalnego, najnowszy pomiar na początku).
+ */
+namespace SyntheticData {
+
+    /**
+     * @brief Generuje odpowiedź /station/findAll
+     * @param count Liczba stacji (ID od 1 do count)
+     * @param seed Ziarno generatora
+     * @return Dokument JSON
+     */
+    QByteArray stations(int count, quint32 seed = 1);
+
+    /**
+     * @brief Generuje odpowiedź /station/sensors/{stationId}
+     * @param stationId ID stacji
+     * @param count Liczba czujników (ID stacja * 100 + numer)
+     * @return Dokument JSON
+     */
+    QByteArray sensors(int stationId, int count = 6);
+
+    /**
+     * @brief Generuje odpowiedź /data/getData/{sensorId} z pomiarami godzinowymi
+     * @param samples Liczba pomiarów
+     * @param parameterCode Kod parametru (np. PM10)
+     * @param lastDay Dzień ostatniego pomiaru (23:00)
+     * @param nullRatio Udział brakujących pomiarów
+     * @param seed Ziarno generatora
+     * @return Dokument JSON
+     */
+    QByteArray sensorData(qsizetype samples, const QString &parameterCode = "PM10",
+                          const QDate &lastDay = QDate(2024, 12, 31), double nullRatio = 0.02,
+                          quint32 seed = 1);
+
+    /**
+     * @brief Generuje odpowiedź /aqindex/getIndex/{stationId}
+     * @param stationId ID stacji
+     * @return Dokument JSON
+     */
+    QByteArray airQualityIndex(int stationId);
+
+    /**
+     * @brief Generuje szereg godzinowy bez pośrednictwa JSON
+     * @param samples Liczba pomiarów
+     * @param firstMs Znacznik czasu pierwszego pomiaru
+     * @param nullRatio Udział brakujących pomiarów
+     * @param seed Ziarno generatora
+     * @return Szereg posortowany rosnąco według czasu
+     */
+    TimeSeries series(qsizetype samples, qint64 firstMs = 1577836800000, double nullRatio = 0.02,
+                      quint32 seed = 1);
+
+    /**
+     * @brief Zwraca listę kodów parametrów mierzonych przez stacje GIOŚ
+     * @return Kody parametrów
+     */
+    QStringList parameterCodes();
+}
+
+#endif // SYNTHETICDATA_H
@@ -0,0 +1,79 @@
+#include "timeseries.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+
+void TimeSeries::reserve(qsizetype capacity)
+{
+    timestampColumn.reserve(capacity);
+    valueColumn.reserve(capacity);
+    validityBits.reserve((capacity + 63) / 64);
+}
+
+void TimeSeries::append(qint64 timestampMs, double value)
+{
+    appendSlot(timestampMs, value, true);
+}
+
+void TimeSeries::appendNull(qint64 timestampMs)
+{
+    appendSlot(timestampMs, std::numeric_limits<double>::quiet_NaN(), false);
+}
+
+void TimeSeries::appendRange(const qint64 *timestamps, const double *values, const quint64 *validity,
+                             qsizetype first, qsizetype last)
+{
+    reserve(size() + (last - first));
+    for (qsizetype i = first; i < last; ++i) {
+        appendSlot(timestamps[i], values[i], (validity[i >> 6] >> (i & 63)) & 1);
+    }
+}
+
+void TimeSeries::clear()
+{
+    timestampColumn.clear();
+    valueColumn.clear();
+    validityBits.clear();
+    nullCount = 0;
+}
+
+void TimeSeries::appendSlot(qint64 timestampMs, double value, bool valid)
+{
+    const qsizetype i = timestampColumn.size();
+    if ((i & 63) == 0) {
+        validityBits.append(0);
+    }
+    if (valid) {
+        validityBits[i >> 6] |= quint64(1) << (i & 63);
+    } else {
+        ++nullCount;
+    }
+    timestampColumn.append(timestampMs);
+    valueColumn.append(value);
+}
+
+void TimeSeries::sortByTime()
+{
+    const qsizetype n = size();
+    if (std::is_sorted(timestampColumn.cbegin(), timestampColumn.cend())) return;
+
+    QList<qsizetype> order(n);
+    // Tylko ściśle malejący szereg - odwrócenie zmieniłoby kolejność próbek o tym samym czasie
+    if (std::adjacent_find(timestampColumn.cbegin(), timestampColumn.cend(), std::less_equal<qint64>())
+        == timestampColumn.cend()) {
+        for (qsizetype i = 0; i < n; ++i) order[i] = n - 1 - i;
+    } else {
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [this](qsizetype a, qsizetype b) {
+            return timestampColumn[a] < timestampColumn[b];
+        });
+    }
+
+    TimeSeries sorted;
+    sorted.reserve(n);
+    for (qsizetype i : order) {
+        sorted.appendSlot(timestampColumn[i], valueColumn[i], isValid(i));
+    }
+    *this = std::move(sorted);
+}
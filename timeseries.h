@@ -0,0 +1,110 @@
+/**
+ * @file timeseries.h
+ * @brief Definicja klasy TimeSeries - kolumnowej reprezentacji szeregu czasowego
+ */
+#ifndef TIMESERIES_H
+#define TIMESERIES_H
+
+#include <QList>
+#include <QDateTime>
+#include <QtGlobal>
+
+/**
+ * @class TimeSeries
+ * @brief Szereg czasowy w układzie kolumnowym (struct-of-arrays)
+ *
+ * Znaczniki czasu są przechowywane jako liczby milisekund od epoki (int64),
+ * wartości w osobnej, ciągłej kolumnie double, a brakujące pomiary (null w JSON)
+ * są oznaczane w mapie bitowej ważności zamiast zastępowania ich zerem.
+ * Wartość brakującego pomiaru w kolumnie wartości to NaN.
+ */
+class TimeSeries
+{
+public:
+
+    /**
+     * @brief Rezerwuje miejsce na podaną liczbę próbek
+     * @param capacity Liczba próbek
+     */
+    void reserve(qsizetype capacity);
+
+    /**
+     * @brief Dodaje poprawny pomiar
+     * @param timestampMs Czas w milisekundach od epoki
+     * @param value Wartość pomiaru
+     */
+    void append(qint64 timestampMs, double value);
+
+    /**
+     * @brief Dodaje brakujący pomiar
+     * @param timestampMs Czas w milisekundach od epoki
+     */
+    void appendNull(qint64 timestampMs);
+
+    /**
+     * @brief Dodaje próbki [first, last) z zewnętrznych kolumn
+     * @param timestamps Kolumna znaczników czasu
+     * @param values Kolumna wartości
+     * @param validity Mapa bitowa ważności (indeksowana od początku kolumn)
+     * @param first Indeks pierwszej próbki
+     * @param last Indeks za ostatnią próbką
+     */
+    void appendRange(const qint64 *timestamps, const double *values, const quint64 *validity,
+                     qsizetype first, qsizetype last);
+
+    /// Usuwa wszystkie próbki
+    void clear();
+
+    /// Zwraca liczbę próbek (łącznie z brakującymi)
+    qsizetype size() const { return timestampColumn.size(); }
+
+    /// Sprawdza, czy szereg jest pusty
+    bool isEmpty() const { return timestampColumn.isEmpty(); }
+
+    /// Zwraca liczbę poprawnych pomiarów
+    qsizetype validCount() const { return timestampColumn.size() - nullCount; }
+
+    /// Zwraca czas próbki w milisekundach od epoki
+    qint64 timestampAt(qsizetype i) const { return timestampColumn[i]; }
+
+    /// Zwraca wartość próbki (NaN dla brakującego pomiaru)
+    double valueAt(qsizetype i) const { return valueColumn[i]; }
+
+    /// Sprawdza, czy próbka zawiera poprawny pomiar
+    bool isValid(qsizetype i) const { return (validityBits[i >> 6] >> (i & 63)) & 1; }
+
+    /// Zwraca czas próbki jako QDateTime (czas lokalny)
+    QDateTime dateTimeAt(qsizetype i) const { return QDateTime::fromMSecsSinceEpoch(timestampColumn[i]); }
+
+    /// Zwraca wskaźnik na kolumnę znaczników czasu
+    const qint64 *timestamps() const { return timestampColumn.constData(); }
+
+    /// Zwraca wskaźnik na kolumnę wartości
+    const double *values() const { return valueColumn.constData(); }
+
+    /// Zwraca wskaźnik na mapę bitową ważności (bit i słowa i/64 odpowiada próbce i)
+    const quint64 *validity() const { return validityBits.constData(); }
+
+    /// Sprawdza, czy szereg zawiera brakujące pomiary
+    bool hasNulls() const { return nullCount != 0; }
+
+    /**
+     * @brief Sortuje próbki rosnąco według czasu
+     *
+     * Odpowiedzi GIOS są uporządkowane od najnowszych, dlatego szereg ściśle malejący
+     * jest odwracany w czasie liniowym, a dowolny inny - sortowany stabilnie.
+     * Próbki o tym samym czasie zachowują kolejność wejściową.
+     */
+    void sortByTime();
+
+private:
+    QList<qint64> timestampColumn; // Znaczniki czasu (ms od epoki)
+    QList<double> valueColumn; // Wartości pomiarów
+    QList<quint64> validityBits; // Mapa bitowa ważności
+    qsizetype nullCount = 0; // Liczba brakujących pomiarów
+
+    /// Dodaje znacznik czasu i miejsce w mapie bitowej dla nowej próbki
+    void appendSlot(qint64 timestampMs, double value, bool valid);
+};
+
+#endif // TIMESERIES_H